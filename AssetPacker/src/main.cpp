@@ -0,0 +1,258 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+// AssetPacker - packs the game assets into a single archive (see assetarchiveformat.h)
+//
+// usage: AssetPacker [--raw-textures[=lz4]] <archive> <directory> [<directory> ...]
+//
+// run it from the game's working directory so the stored paths match the ones the game builds, e.g.
+//   AssetPacker --raw-textures=lz4 assets.pak assets/gfx assets/sfx
+//
+// --raw-textures stores every PNG pre-decoded (see rawtextureformat.h) so the game does not decode them at
+// startup, "=lz4" compresses the pixels of the ones that get smaller that way
+
+#include <algorithm>
+#include "assetarchiveformat.h"
+#include <filesystem>
+#include <fstream>
+#include "lz4block.h"
+#include "rawtextureformat.h"
+#define SDL_MAIN_HANDLED
+#if __APPLE__
+#include <SDL2/SDL.h>
+#include <SDL2_image/SDL_image.h>
+#else
+#include <SDL.h>
+#include <SDL_image.h>
+#endif
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+enum class ETextureMode : int
+{
+	PNG,
+	RAW,
+	RAW_LZ4
+};
+
+struct SInputFile
+{
+	std::string m_path;
+	std::vector<char> m_contents;
+};
+
+static bool ReadFile(const std::filesystem::path& path, std::vector<char>& contents)
+{
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file)
+	{
+		return false;
+	}
+
+	contents.resize(static_cast<size_t>(file.tellg()));
+	file.seekg(0);
+	return static_cast<bool>(file.read(contents.data(), contents.size()));
+}
+
+// replaces the contents of a PNG with its pre-decoded version
+static bool ConvertToRawTexture(SInputFile& file, ETextureMode textureMode)
+{
+	SDL_Surface* image = IMG_Load_RW(SDL_RWFromConstMem(file.m_contents.data(), static_cast<int>(file.m_contents.size())), 1);
+	if (image == nullptr)
+	{
+		printf("Unable to decode: %s (%s)\n", file.m_path.c_str(), IMG_GetError());
+		return false;
+	}
+
+	SDL_Surface* surface = SDL_ConvertSurfaceFormat(image, SDL_PIXELFORMAT_ARGB8888, 0);
+	SDL_FreeSurface(image);
+	if (surface == nullptr)
+	{
+		printf("Unable to convert: %s (%s)\n", file.m_path.c_str(), SDL_GetError());
+		return false;
+	}
+
+	// pixel rows without padding
+	size_t rowSize = static_cast<size_t>(surface->w) * SDL_BYTESPERPIXEL(SDL_PIXELFORMAT_ARGB8888);
+	std::vector<uint8_t> pixels(rowSize * surface->h);
+	for (int y = 0; y < surface->h; y++)
+	{
+		memcpy(pixels.data() + rowSize * y, static_cast<const uint8_t*>(surface->pixels) + surface->pitch * y, rowSize);
+	}
+
+	SRawTextureHeader header{};
+	header.m_magic = RAW_TEXTURE_MAGIC;
+	header.m_version = RAW_TEXTURE_VERSION;
+	header.m_width = static_cast<uint32_t>(surface->w);
+	header.m_height = static_cast<uint32_t>(surface->h);
+	header.m_pixelFormat = SDL_PIXELFORMAT_ARGB8888;
+	header.m_compression = ERawTextureCompression::NONE;
+	SDL_FreeSurface(surface);
+
+	// keep the pixels uncompressed if compressing them does not save anything, they can be uploaded without a copy then
+	std::vector<uint8_t> compressedPixels;
+	if (textureMode == ETextureMode::RAW_LZ4)
+	{
+		compressedPixels.resize(LZ4Block::GetMaxCompressedSize(pixels.size()));
+		size_t compressedSize = LZ4Block::Compress(pixels.data(), pixels.size(), compressedPixels.data(), compressedPixels.size());
+		if (compressedSize > 0 && compressedSize < pixels.size())
+		{
+			compressedPixels.resize(compressedSize);
+			header.m_compression = ERawTextureCompression::LZ4;
+		}
+	}
+	const std::vector<uint8_t>& storedPixels = header.m_compression == ERawTextureCompression::LZ4 ? compressedPixels : pixels;
+	header.m_dataSize = static_cast<uint32_t>(storedPixels.size());
+
+	file.m_contents.resize(sizeof(SRawTextureHeader) + storedPixels.size());
+	memcpy(file.m_contents.data(), &header, sizeof(SRawTextureHeader));
+	memcpy(file.m_contents.data() + sizeof(SRawTextureHeader), storedPixels.data(), storedPixels.size());
+
+	file.m_path = std::filesystem::path(file.m_path).replace_extension(RAW_TEXTURE_EXTENSION).generic_string();
+	printf("Converted to %s (%ux%u, %s)\n", file.m_path.c_str(), header.m_width, header.m_height,
+		header.m_compression == ERawTextureCompression::LZ4 ? "lz4" : "uncompressed");
+	return true;
+}
+
+static bool CollectFiles(const std::string& directory, ETextureMode textureMode, std::vector<SInputFile>& files)
+{
+	std::error_code error;
+	for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator(directory, error))
+	{
+		if (!entry.is_regular_file())
+		{
+			continue;
+		}
+
+		SInputFile file;
+		file.m_path = entry.path().lexically_normal().generic_string(); // forward slashes on every platform
+		if (!ReadFile(entry.path(), file.m_contents))
+		{
+			printf("Unable to read: %s\n", file.m_path.c_str());
+			return false;
+		}
+
+		if (textureMode != ETextureMode::PNG && entry.path().extension() == ".png" && !ConvertToRawTexture(file, textureMode))
+		{
+			return false;
+		}
+		files.push_back(std::move(file));
+	}
+
+	if (error)
+	{
+		printf("Unable to read directory: %s (%s)\n", directory.c_str(), error.message().c_str());
+		return false;
+	}
+
+	return true;
+}
+
+static uint64_t Align(uint64_t value)
+{
+	return (value + ASSET_ARCHIVE_BLOB_ALIGNMENT - 1) / ASSET_ARCHIVE_BLOB_ALIGNMENT * ASSET_ARCHIVE_BLOB_ALIGNMENT;
+}
+
+static bool WriteArchive(const std::string& filename, const std::vector<SInputFile>& files)
+{
+	// table of contents
+	SAssetArchiveHeader header{};
+	header.m_magic = ASSET_ARCHIVE_MAGIC;
+	header.m_version = ASSET_ARCHIVE_VERSION;
+	header.m_numEntries = static_cast<uint32_t>(files.size());
+	header.m_stringTableOffset = static_cast<uint32_t>(sizeof(SAssetArchiveHeader) + files.size() * sizeof(SAssetArchiveEntry));
+
+	std::vector<SAssetArchiveEntry> entries(files.size());
+	std::string stringTable;
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		entries[i].m_pathOffset = static_cast<uint32_t>(stringTable.size());
+		entries[i].m_pathLength = static_cast<uint32_t>(files[i].m_path.size());
+		stringTable.append(files[i].m_path);
+	}
+
+	uint64_t blobOffset = Align(header.m_stringTableOffset + stringTable.size());
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		entries[i].m_blobOffset = blobOffset;
+		entries[i].m_blobSize = files[i].m_contents.size();
+		blobOffset = Align(blobOffset + files[i].m_contents.size());
+	}
+
+	std::ofstream file(filename, std::ios::binary | std::ios::trunc);
+	if (!file)
+	{
+		printf("Unable to create: %s\n", filename.c_str());
+		return false;
+	}
+
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(entries.data()), entries.size() * sizeof(SAssetArchiveEntry));
+	file.write(stringTable.data(), stringTable.size());
+
+	// blobs, padded so every one of them starts aligned
+	const char padding[ASSET_ARCHIVE_BLOB_ALIGNMENT] = {};
+	for (size_t i = 0; i < files.size(); i++)
+	{
+		uint64_t position = static_cast<uint64_t>(file.tellp());
+		file.write(padding, static_cast<std::streamsize>(entries[i].m_blobOffset - position));
+		file.write(files[i].m_contents.data(), files[i].m_contents.size());
+		printf("  %s (%u bytes)\n", files[i].m_path.c_str(), static_cast<unsigned int>(files[i].m_contents.size()));
+	}
+
+	if (!file)
+	{
+		printf("Unable to write: %s\n", filename.c_str());
+		return false;
+	}
+
+	printf("Packed %u assets into %s (%u bytes)\n", header.m_numEntries, filename.c_str(), static_cast<unsigned int>(file.tellp()));
+	return true;
+}
+
+int main(int argc, char* args[])
+{
+	ETextureMode textureMode = ETextureMode::PNG;
+	int firstArg = 1;
+	if (argc > 1 && strcmp(args[1], "--raw-textures") == 0)
+	{
+		textureMode = ETextureMode::RAW;
+		firstArg++;
+	}
+	else if (argc > 1 && strcmp(args[1], "--raw-textures=lz4") == 0)
+	{
+		textureMode = ETextureMode::RAW_LZ4;
+		firstArg++;
+	}
+
+	if (argc - firstArg < 2)
+	{
+		printf("usage: AssetPacker [--raw-textures[=lz4]] <archive> <directory> [<directory> ...]\n");
+		return 1;
+	}
+
+	if (textureMode != ETextureMode::PNG && (IMG_Init(IMG_INIT_PNG) & IMG_INIT_PNG) == 0)
+	{
+		printf("Unable to initialize SDL_image (%s)\n", IMG_GetError());
+		return 1;
+	}
+
+	std::vector<SInputFile> files;
+	for (int i = firstArg + 1; i < argc; i++)
+	{
+		if (!CollectFiles(args[i], textureMode, files))
+		{
+			return 1;
+		}
+	}
+
+	// the game binary searches the table of contents
+	std::sort(files.begin(), files.end(), [](const SInputFile& a, const SInputFile& b) { return a.m_path < b.m_path; });
+
+	bool result = WriteArchive(args[firstArg], files);
+	IMG_Quit();
+	return result ? 0 : 1;
+}
@@ -36,10 +36,13 @@ void CAnimationManager::Update(Uint32 elapsedTime)
 {
 	assert(m_isInitialized);
 
+	// the time of the entity's update, the animation stands still while the game does
+	m_frameTime += elapsedTime;
+
 	if (m_requestedAnimIndex != ANIMATION_NONE)
 	{
 		// there is a request for an animation
-		m_ticks = Utils::GetTicks();
+		m_frameTime = 0;
 		m_currentAnimIndex = m_requestedAnimIndex;
 
 		// reset the current frame variable
@@ -53,7 +56,7 @@ void CAnimationManager::Update(Uint32 elapsedTime)
 	if (m_currentAnimIndex != ANIMATION_NONE)
 	{
 		const SAnimationDef& animDef = m_animTable[m_currentAnimIndex];
-		if (Utils::GetTicks() - m_ticks > animDef.m_time)
+		if (m_frameTime > animDef.m_time)
 		{
 			// update the frame
 			m_currentFrame += m_playDirection;
@@ -83,11 +86,29 @@ void CAnimationManager::Update(Uint32 elapsedTime)
 				}				
 			}
 
-			m_ticks = Utils::GetTicks();
+			m_frameTime = 0;
 		}
 	}	
 }
 
+void CAnimationManager::SaveState(SState* state) const
+{
+	state->m_frameTime = m_frameTime;
+	state->m_currentAnimIndex = m_currentAnimIndex;
+	state->m_requestedAnimIndex = m_requestedAnimIndex;
+	state->m_currentFrame = m_currentFrame;
+	state->m_playDirection = m_playDirection;
+}
+
+void CAnimationManager::RestoreState(const SState& state)
+{
+	m_frameTime = state.m_frameTime;
+	m_currentAnimIndex = state.m_currentAnimIndex;
+	m_requestedAnimIndex = state.m_requestedAnimIndex;
+	m_currentFrame = state.m_currentFrame;
+	m_playDirection = state.m_playDirection;
+}
+
 void CAnimationManager::Draw(int posX, int posY, double angleInDegrees)
 {
 	assert(m_isInitialized);
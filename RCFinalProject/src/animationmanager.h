@@ -9,7 +9,6 @@
 #else
 #include <SDL.h>
 #endif
-#include "app.h"
 #include "texture.h"
 
 struct SAnimationDef
@@ -42,6 +41,16 @@ class CAnimationManager
 public:
 	static const int ANIMATION_NONE = -1;
 
+	// where the animation is, the table and the frame size stay with whoever set it up
+	struct SState
+	{
+		Uint32 m_frameTime;
+		Sint32 m_currentAnimIndex;
+		Sint32 m_requestedAnimIndex;
+		Sint32 m_currentFrame;
+		int8_t m_playDirection;
+	};
+
 	void Setup(const SAnimationDef* animTable, int frameWidth, int frameHeight, CTexture* spriteSheetTexture);
 	void Setup(const SAnimationDef* animTable, int frameWidth, int frameHeight);
 
@@ -54,13 +63,16 @@ public:
 	int GetRequestedAnimation() { return m_requestedAnimIndex; }
 	int GetCurrentAnimation() { return m_currentAnimIndex; }
 
+	void SaveState(SState* state) const;
+	void RestoreState(const SState& state);
+
 private:
 	void VerifyInitialization();
 
 	int m_currentAnimIndex = ANIMATION_NONE;
 	int m_requestedAnimIndex = ANIMATION_NONE;
 	bool m_isInitialized = false;
-	Uint32 m_ticks = 0;
+	Uint32 m_frameTime = 0; // how long the current frame has been shown
 	int m_currentFrame = 0;
 	int8_t m_playDirection = 1; // only used for LOOP_BOOMERANG (-1 means backwards, 1 means forward)
 
@@ -11,6 +11,8 @@
 #include <SDL_Image.h>
 #endif
 #include "app.h"
+#include "envrunner.h"
+#include "random.h"
 #include <time.h>
 #include "utils.h"
 
@@ -29,47 +31,242 @@ void CleanUpApp()
 	delete app;
 }
 
-void UpdateApp()
+void UpdateApp(int argc, char* args[])
 {		
 	atexit(CleanUpApp);
 	CApp* app = CApp::GetInstance(); // create the singleton
+	app->ParseCommandLine(argc, args);
+	if (app->IsEnvBenchmark())
+	{
+		app->RunEnvBenchmark();
+		return;
+	}
 	app->Init();
 	app->Update();
 }
 
 //********** APP CONSTRUCTOR / DESTRUCTOR *********************************************************
 
+void CApp::ParseCommandLine(int argc, char* args[])
+{
+	for (int i = 1; i < argc; i++)
+	{
+		std::string arg = args[i];
+		if (arg == "--benchmark-startup")
+		{
+			m_isStartupBenchmark = true;
+		}
+		else if (arg == "--two-players")
+		{
+			m_gameManager.SetTwoPlayerGame(true, TWO_PLAYER_DEFAULT_LATENCY_MS);
+		}
+		else if (arg.compare(0, 14, "--two-players=") == 0)
+		{
+			m_gameManager.SetTwoPlayerGame(true, static_cast<Uint32>(atoi(arg.substr(14).c_str())));
+		}
+		else if (arg.compare(0, 17, "--benchmark-envs=") == 0)
+		{
+			m_numBenchmarkEnvs = atoi(arg.substr(17).c_str());
+		}
+#if SOUND_ENABLED
+		else if (arg.compare(0, 8, "--audio=") == 0)
+		{
+			if (!CAudioBackend::ParseType(arg.substr(8), &m_audioBackendType))
+			{
+				LOG_SCR_F("Unknown audio backend: %s\n", arg.c_str());
+			}
+		}
+#endif
+		else
+		{
+			LOG_SCR_F("Unknown command line argument: %s\n", arg.c_str());
+		}
+	}
+}
+
 void CApp::Init()
 {
+	m_profiler.BeginStartup();
+
 	// randomize rng seed
 	Utils::RandomizeRngSeed();	
 
+	// one file open for all the assets, if the archive is there
+	Uint64 phaseCounter = SDL_GetPerformanceCounter();
+	m_assetArchive.Open(ASSET_ARCHIVE_FILENAME);
+	m_profiler.RecordStartupPhase(CProfiler::EStartupPhase::OPEN_ARCHIVE, phaseCounter);
+
 	InitSDL();
+
+	phaseCounter = SDL_GetPerformanceCounter();
 	LoadFonts();
+	m_profiler.RecordStartupPhase(CProfiler::EStartupPhase::LOAD_FONTS, phaseCounter);
+
 #if SOUND_ENABLED
-	InitFMOD();
+	phaseCounter = SDL_GetPerformanceCounter();
+	InitAudio();
+	m_profiler.RecordStartupPhase(CProfiler::EStartupPhase::INIT_AUDIO, phaseCounter);
 #endif
+
+	m_jobSystem.Init();
+
+	m_services.m_renderThread = &m_renderThread;
+	m_services.m_assetLoader = &m_assetLoader;
+	m_services.m_assetCache = &m_assetCache;
+	m_services.m_assetArchive = &m_assetArchive;
+	m_services.m_jobSystem = &m_jobSystem;
+	m_services.m_gameManager = &m_gameManager;
+	m_services.m_profiler = &m_profiler;
+#if SOUND_ENABLED
+	m_services.m_audioBackend = m_audioBackend;
+	m_services.m_audioThread = &m_audioThread;
+	m_services.m_soundEventQueue = &m_soundEventQueue;
+#endif
+	m_services.m_clock = &m_clock;
+	m_services.m_regularFont = m_regularFont;
+	m_services.m_bigFont = m_bigFont;
+	m_services.m_screenWidth = g_screenWidth;
+	m_services.m_screenHeight = g_screenHeight;
+
+	m_assetCache.Init(&m_services);
+#if SOUND_ENABLED
+	m_soundEventQueue.Init(&m_services);
+#endif
+
+	phaseCounter = SDL_GetPerformanceCounter();
+	m_assetLoader.Init(&m_services);
+	m_profiler.RecordStartupPhase(CProfiler::EStartupPhase::INIT_ASSET_LOADER, phaseCounter);
 }
 
 void CApp::CleanUp()
 {
+	if (m_isHeadless)
+	{
+		m_jobSystem.Destroy();
+		return;
+	}
+
 	m_gameManager.Destroy();
+	m_jobSystem.Destroy();
+	m_assetLoader.Destroy();
+	m_assetCache.Destroy();
 #if SOUND_ENABLED
-	CleanUpFMOD();
+	CleanUpAudio();
 #endif
 	CleanUpFonts();
 	CleanUpSDL();
+	m_assetArchive.Close();
+}
+
+// no window, sound or assets: the games only need the job system
+void CApp::RunEnvBenchmark()
+{
+	m_isHeadless = true;
+	m_jobSystem.Init();
+
+	SServices services;
+	services.m_jobSystem = &m_jobSystem;
+
+	CEnvRunner envRunner;
+	envRunner.Init(&services, m_numBenchmarkEnvs, ENV_BENCHMARK_SEED);
+
+	int totalScore = 0;
+	int totalDeaths = 0;
+	double elapsedMs = StepBenchmarkEnvs(&envRunner, ENV_BENCHMARK_NUM_STEPS, &totalScore, &totalDeaths);
+
+	// save and restore the first environment as it was left, over and over
+	CIngameState::SSnapshot* snapshot = new CIngameState::SSnapshot;
+	double saveSnapshotMs = 0.0;
+	double restoreSnapshotMs = 0.0;
+	for (int i = 0; i < ENV_BENCHMARK_NUM_SNAPSHOTS; i++)
+	{
+		Uint64 snapshotCounter = SDL_GetPerformanceCounter();
+		envRunner.SaveSnapshot(0, snapshot);
+		saveSnapshotMs += Utils::GetElapsedMs(snapshotCounter);
+
+		snapshotCounter = SDL_GetPerformanceCounter();
+		envRunner.RestoreSnapshot(0, *snapshot);
+		restoreSnapshotMs += Utils::GetElapsedMs(snapshotCounter);
+	}
+	delete snapshot;
+
+	envRunner.Destroy();
+
+	// many more environments than job threads, each of them spreading its own update over the threads as well. it
+	// has to get through without running out of jobs, however many environments it is given
+	int numStressEnvs = m_jobSystem.GetNumThreads() * ENV_BENCHMARK_STRESS_ENVS_PER_THREAD;
+	CEnvRunner stressEnvRunner;
+	stressEnvRunner.Init(&services, numStressEnvs, ENV_BENCHMARK_SEED);
+	int stressScore = 0;
+	int stressDeaths = 0;
+	double stressMs = StepBenchmarkEnvs(&stressEnvRunner, ENV_BENCHMARK_STRESS_NUM_STEPS, &stressScore, &stressDeaths);
+	stressEnvRunner.Destroy();
+
+	int totalSteps = ENV_BENCHMARK_NUM_STEPS * m_numBenchmarkEnvs;
+	printf("Env benchmark: %d environments, %d steps each, %d job threads\n", m_numBenchmarkEnvs, ENV_BENCHMARK_NUM_STEPS, m_jobSystem.GetNumThreads());
+	printf("  %-28s %9.2f ms\n", "total", elapsedMs);
+	printf("  %-28s %9.0f\n", "environment steps / s", totalSteps / (elapsedMs / 1000.0));
+	printf("  %-28s %9d\n", "score", totalScore);
+	printf("  %-28s %9d\n", "deaths", totalDeaths);
+	printf("  %-28s %9u bytes\n", "snapshot size", (unsigned int)sizeof(CIngameState::SSnapshot));
+	printf("  %-28s %9.4f ms\n", "snapshot save", saveSnapshotMs / ENV_BENCHMARK_NUM_SNAPSHOTS);
+	printf("  %-28s %9.4f ms\n", "snapshot restore", restoreSnapshotMs / ENV_BENCHMARK_NUM_SNAPSHOTS);
+	printf("Env stress run: %d environments, %d steps each\n", numStressEnvs, ENV_BENCHMARK_STRESS_NUM_STEPS);
+	printf("  %-28s %9.2f ms\n", "total", stressMs);
+	printf("  %-28s %9.0f\n", "environment steps / s", numStressEnvs * ENV_BENCHMARK_STRESS_NUM_STEPS / (stressMs / 1000.0));
+}
+
+// steps every environment from a new game with random input, returns how long it took
+double CApp::StepBenchmarkEnvs(CEnvRunner* envRunner, int numSteps, int* totalScore, int* totalDeaths)
+{
+	int numEnvs = envRunner->GetNumEnvs();
+	std::vector<CEnvRunner::SAction> actions(numEnvs);
+	std::vector<CEnvRunner::SObservation> observations(numEnvs);
+	std::vector<CEnvRunner::SStepResult> results(numEnvs);
+	envRunner->Reset(observations.data());
+
+	// the input is random but the same every run
+	CRandom random;
+	random.Seed(ENV_BENCHMARK_SEED);
+
+	Uint64 startCounter = SDL_GetPerformanceCounter();
+	for (int step = 0; step < numSteps; step++)
+	{
+		for (CEnvRunner::SAction& action : actions)
+		{
+			Uint32 bits = random.GetUint32();
+			action.m_up = bits & 1;
+			action.m_down = (bits >> 1) & 1;
+			action.m_left = (bits >> 2) & 1;
+			action.m_right = (bits >> 3) & 1;
+			action.m_fire = (bits >> 4) & 1;
+			action.m_shield = (bits >> 5) & 1;
+		}
+
+		envRunner->Step(actions.data(), ENV_BENCHMARK_STEP_MS, observations.data(), results.data());
+
+		for (const CEnvRunner::SStepResult& result : results)
+		{
+			*totalScore += result.m_scoreDelta;
+			*totalDeaths += result.m_numDeaths;
+		}
+	}
+	return Utils::GetElapsedMs(startCounter);
 }
 
 //********** SDL INITIALIZATION / CLEANUP *********************************************************
 void CApp::InitSDL()
 {
 	LOG_SCR("Initializing SDL");
+	Uint64 phaseCounter = SDL_GetPerformanceCounter();
 	if (SDL_Init(SDL_INIT_VIDEO) < 0)
 	{
 		LOG_SCR_F("Unable to initialize the SDL Library: %s\n", SDL_GetError());
 		exit(1);
 	}
+	m_profiler.RecordStartupPhase(CProfiler::EStartupPhase::SDL_INIT, phaseCounter);
+
+	phaseCounter = SDL_GetPerformanceCounter();
 
 	m_window = SDL_CreateWindow(APP_NAME, SDL_WINDOWPOS_UNDEFINED, SDL_WINDOWPOS_UNDEFINED, g_screenWidth, g_screenHeight, 0);
 	if (m_window == nullptr)
@@ -80,55 +277,35 @@ void CApp::InitSDL()
 
 	SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "linear");
 
-	m_renderer = SDL_CreateRenderer(m_window, -1, SDL_RENDERER_ACCELERATED);
-	if (m_renderer == nullptr)
+	if (!m_renderThread.Init(m_window))
 	{
-		LOG_SCR_F("Unable to create renderer: %s\n", SDL_GetError());
 		exit(1);
 	}
+	m_profiler.RecordStartupPhase(CProfiler::EStartupPhase::CREATE_RENDERER, phaseCounter);
 
 	// initialize the SDL_Image library
+	phaseCounter = SDL_GetPerformanceCounter();
 	IMG_Init(IMG_INIT_PNG);
+	m_profiler.RecordStartupPhase(CProfiler::EStartupPhase::IMG_INIT, phaseCounter);
 
 	// initialize the SDL_TTF library
+	phaseCounter = SDL_GetPerformanceCounter();
 	if (TTF_Init() == -1)
 	{
 		LOG_SCR_F("Unable to initialize the SDL Font Library: %s\n", TTF_GetError());
 		exit(1);
 	}
+	m_profiler.RecordStartupPhase(CProfiler::EStartupPhase::TTF_INIT, phaseCounter);
 }
 
 void CApp::CleanUpSDL()
 {
 	LOG_SCR("Cleaning up SDL");
-	SDL_DestroyRenderer(m_renderer);
+	m_renderThread.Destroy();
 	SDL_DestroyWindow(m_window);
 	SDL_Quit();
 }
 
-void CApp::DrawLine(int x1, int y1, int x2, int y2, SDL_Color color)
-{
-	SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
-	SDL_RenderDrawLine(m_renderer, x1, y1, x2, y2);
-}
-
-void CApp::DrawBox(int x, int y, int w, int h, bool fill, SDL_Color foregroundColor, SDL_Color backgroundColor)
-{
-	SDL_Rect rc{ x, y, w, h };
-	SDL_BlendMode originalBlendMode;
-	SDL_GetRenderDrawBlendMode(m_renderer, &originalBlendMode);
-
-	SDL_SetRenderDrawBlendMode(m_renderer, SDL_BlendMode::SDL_BLENDMODE_BLEND);
-	if (fill)
-	{		
-		SDL_SetRenderDrawColor(m_renderer, backgroundColor.r, backgroundColor.g, backgroundColor.b, backgroundColor.a);
-		SDL_RenderFillRect(m_renderer, &rc);
-	}
-	SDL_SetRenderDrawColor(m_renderer, foregroundColor.r, foregroundColor.g, foregroundColor.b, foregroundColor.a);
-	SDL_RenderDrawRect(m_renderer, &rc);
-	SDL_SetRenderDrawBlendMode(m_renderer, originalBlendMode);
-}
-
 void CApp::LoadFonts()
 {
 	LOG_SCR("Loading Fonts");
@@ -136,14 +313,14 @@ void CApp::LoadFonts()
 	std::string fontFilename = GFX_DIRECTORY;
 	fontFilename.append(FONT_FACE_FILENAME);
 
-	m_regularFont = TTF_OpenFont(fontFilename.c_str(), REGULAR_FONT_SIZE_PT);
+	m_regularFont = TTF_OpenFontRW(m_assetArchive.OpenAsset(fontFilename), 1, REGULAR_FONT_SIZE_PT);
 	if (m_regularFont == nullptr)
 	{
 		LOG_SCR_F("Unable to load regular font: %s\n", TTF_GetError());
 		exit(1);
 	}
 
-	m_bigFont = TTF_OpenFont(fontFilename.c_str(), BIG_FONT_SIZE_PT);
+	m_bigFont = TTF_OpenFontRW(m_assetArchive.OpenAsset(fontFilename), 1, BIG_FONT_SIZE_PT);
 	if (m_bigFont == nullptr)
 	{
 		LOG_SCR_F("Unable to load big font: %s\n", TTF_GetError());
@@ -169,84 +346,34 @@ void CApp::CleanUpFonts()
 }
 
 #if SOUND_ENABLED
-//********** FMOD SOUND LIBRARY INITIALIZATION / CLEANUP *********************************************************
-void CApp::InitFMOD()
+//********** AUDIO INITIALIZATION / CLEANUP *********************************************************
+void CApp::InitAudio()
 {
-	LOG_SCR("Initializing FMOD");
-
-	FMOD_RESULT result;
-		
-	// Create the main system object
-	result = FMOD::System_Create(&m_fmodSystem);
-	if (result != FMOD_OK)
-	{
-		LOG_SCR_F("Failed to create FMOD system object: %s\n", FMOD_ErrorString(result));
-		exit(1);
-	}
+	m_audioBackend = CAudioBackend::Create(m_audioBackendType);
+	LOG_SCR_F("Initializing audio backend: %s\n", m_audioBackend->GetName());
 
-	// initialize FMOD
-	result = m_fmodSystem->init(512, FMOD_INIT_NORMAL, nullptr);
-	if (result != FMOD_OK)
-	{
-		LOG_SCR_F("Failed to initialize FMOD system object: %s\n", FMOD_ErrorString(result));
-		exit(1);
-	}
-	
-	// create a channel group
-	result = m_fmodSystem->createChannelGroup("sfx", &m_channelGroup);
-	if (result != FMOD_OK)
+	// the game runs fine without sound, e.g. on a machine with no audio device
+	if (!m_audioBackend->Init(&m_assetArchive))
 	{
-		LOG_SCR_F("Failed to create FMOD sfx channel group: %s\n", FMOD_ErrorString(result));
-		exit(1);
+		LOG_SCR_F("Failed to initialize audio backend: %s, sound is disabled\n", m_audioBackend->GetName());
+		delete m_audioBackend;
+		m_audioBackend = CAudioBackend::Create(CAudioBackend::EType::NONE);
+		m_audioBackend->Init(&m_assetArchive);
 	}
-}
-
-void CApp::CleanUpFMOD()
-{
-	LOG_SCR("Cleaning up FMOD");
 
-	m_channelGroup->release();
-	m_fmodSystem->release();
+	// the backend is updated on the audio thread from now on
+	m_audioThread.Init(m_audioBackend);
 }
-#endif
-
-//********** WRAPPERS TO LOAD SOUNDS *********************************************************
 
-#if SOUND_ENABLED
-FMOD_RESULT F_CALLBACK channelGroupCallback(FMOD_CHANNELCONTROL* channelControl,
-	FMOD_CHANNELCONTROL_TYPE controlType, FMOD_CHANNELCONTROL_CALLBACK_TYPE callbackType,
-	void* commandData1, void* commandData2)
+void CApp::CleanUpAudio()
 {
-	// for future expansion
-	return FMOD_OK;
-}
+	LOG_SCR_F("Cleaning up audio backend: %s\n", m_audioBackend->GetName());
 
-bool CApp::PrepareSoundChannel(FMOD::Channel* channel)
-{
-	// assign the FMOD channel to a FMOD channel group
-	FMOD_RESULT result = channel->setChannelGroup(m_channelGroup);
-	if (result != FMOD_OK)
-	{
-		LOG_SCR_F("Failed to set channel to group: %s\n", FMOD_ErrorString(result));
-		return false;
-	}
+	m_audioThread.Destroy();
 
-	// set callback on FMOD channel for post processing which is optional
-	result = channel->setCallback(&channelGroupCallback);
-	if (result != FMOD_OK)
-	{
-		LOG_SCR_F("Failed to set callback on channel: %s\n", FMOD_ErrorString(result));
-		return false;
-	}
-
-	return true;
-}
-
-void CApp::SetChannelVolume(FMOD::Channel* channel, float volume)
-{
-	assert(channel != nullptr);
-
-	channel->setVolume(volume);
+	m_audioBackend->Destroy();
+	delete m_audioBackend;
+	m_audioBackend = nullptr;
 }
 #endif
 
@@ -271,24 +398,33 @@ void CApp::HandleInput()
 		case SDL_KEYUP:
 			m_gameManager.HandleKeyUpInput(&event.key);
 			break;
+
+		// e.g. Direct3D 9 after Alt-Tab or a fullscreen switch. the states render again through the render thread
+		case SDL_RENDER_TARGETS_RESET:
+		case SDL_RENDER_DEVICE_RESET:
+			LOG_SCR_F("Render targets reset (%s)\n", event.type == SDL_RENDER_DEVICE_RESET ? "device" : "targets");
+			m_gameManager.OnRenderTargetsReset();
+			break;
 		}
 	}
 }
 
+// the frame is only recorded during the update, the render thread clears the screen and draws it afterwards
 void CApp::PrepareScene()
 {
-	SDL_RenderClear(m_renderer);
+	m_profiler.BeginFrame();
 }
 
+// the render thread draws and presents this frame while the next one is updated
 void CApp::PresentScene()
 {
-	SDL_RenderPresent(m_renderer);
+	m_renderThread.SubmitFrame();
 }
 
 void CApp::Update()
 {
 	// initialize the game manager
-	m_gameManager.Init();
+	m_gameManager.Init(&m_services);
 
 	Uint32 ticks = Utils::GetTicks();
 
@@ -297,16 +433,42 @@ void CApp::Update()
 		Uint32 currentTicks = Utils::GetTicks();
 		Uint32 elapsedTime = currentTicks - ticks;
 		ticks = currentTicks;
+		m_clock.Advance(elapsedTime);
 
 		PrepareScene();
 		HandleInput();
+		m_assetLoader.Update();
 		m_gameManager.Update(elapsedTime);
-		PresentScene();
-		SDL_Delay(16);
-
+		m_jobSystem.CollectStats(&m_profiler);
+		m_renderThread.CollectStats(&m_profiler);
 #if SOUND_ENABLED
-		// update fmod
-		m_fmodSystem->update();
+		// start everything played during the frame in one go, on the audio thread
+		m_soundEventQueue.Dispatch();
+		m_profiler.IncrementCounter(CProfiler::ECounter::SOUND_VOICES_STOLEN, m_audioThread.TakeNumVoicesStolen());
+		m_profiler.IncrementCounter(CProfiler::ECounter::AUDIO_MIX_TIME_US, m_audioBackend->TakeMixTimeUs());
 #endif
+		PresentScene();
+
+		// time to first frame, the startup benchmark ends as soon as the first state is fully loaded
+		if (!m_profiler.IsStartupComplete())
+		{
+			// the frame only counts once it is on screen, only waited for until startup is complete. the state was
+			// drawn after it last changed, so it still tells what the frame shows
+			m_renderThread.WaitForPresent();
+			m_profiler.RecordFramePresented(m_gameManager.IsLoading());
+			if (m_profiler.IsStartupComplete())
+			{
+				if (m_isStartupBenchmark || DEBUG_LOG_PROFILER)
+				{
+					m_profiler.PrintStartupReport();
+				}
+				if (m_isStartupBenchmark)
+				{
+					exit(0);
+				}
+			}
+		}
+
+		SDL_Delay(16);
 	}
 }
\ No newline at end of file
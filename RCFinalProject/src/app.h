@@ -12,14 +12,24 @@
 #include <SDL_ttf.h>
 #endif
 #include "preproc.h"
+#include "assetarchive.h"
+#include "assetcache.h"
+#include "assetloader.h"
+#include "clock.h"
 #include "gamemanager.h"
 #include "gamestate.h"
-#include <string>
+#include "jobsystem.h"
+#include "profiler.h"
+#include "renderthread.h"
+#include "services.h"
 #if SOUND_ENABLED
-#include <fmod.hpp>
-#include <fmod_errors.h>
+#include "audiobackend.h"
+#include "audiothread.h"
+#include "soundeventqueue.h"
 #endif
+#include <string>
 
+class CEnvRunner;
 class CGameState;
 
 // Main App Singleton Class
@@ -46,9 +56,15 @@ public:
 
 public:
 
+	void ParseCommandLine(int argc, char* args[]);
 	void Init();
 	void CleanUp();
 
+	// --benchmark-envs=<n>: steps n headless games with random input instead of running the game, prints how fast
+	bool IsEnvBenchmark() { return m_numBenchmarkEnvs > 0; }
+	void RunEnvBenchmark();
+	double StepBenchmarkEnvs(CEnvRunner* envRunner, int numSteps, int* totalScore, int* totalDeaths);
+
 	//********** GRAPHICS *********************************************************
 	
 	void InitSDL();
@@ -62,30 +78,34 @@ public:
 	const int GetScreenWidth() { return g_screenWidth; }
 	const int GetScreenHeight() { return g_screenHeight; }
 
-	SDL_Renderer* GetRenderer() { return m_renderer; }
+	CRenderThread* GetRenderThread() { return &m_renderThread; }
 	TTF_Font* GetRegularFont() { return m_regularFont; }
 	TTF_Font* GetBigFont() { return m_bigFont; }
 
 #if SOUND_ENABLED
-	FMOD::System* GetFmodSystem() { return m_fmodSystem; }
-	FMOD::ChannelGroup* GetFmodChannelGroup() { return m_channelGroup; }
+	CAudioBackend* GetAudioBackend() { return m_audioBackend; }
+	CSoundEventQueue* GetSoundEventQueue() { return &m_soundEventQueue; }
+	CAudioThread* GetAudioThread() { return &m_audioThread; }
 #endif
 	
-	void DrawLine(int x1, int y1, int x2, int y2, SDL_Color color);
-	void DrawBox(int x, int y, int w, int h, bool fill, SDL_Color foregroundColor, SDL_Color backgroundColor);
-	
 	//********** SOUND *********************************************************
 
 #if SOUND_ENABLED
-	void InitFMOD();
-	void CleanUpFMOD();
-	bool PrepareSoundChannel(FMOD::Channel* channel);
-	void SetChannelVolume(FMOD::Channel* channel, float volume);
+	void InitAudio();
+	void CleanUpAudio();
 #endif
 
 	//********** APP *********************************************************
 
 	CGameManager* GetGameManager() { return &m_gameManager; }
+	CAssetLoader* GetAssetLoader() { return &m_assetLoader; }
+	CAssetCache* GetAssetCache() { return &m_assetCache; }
+	CAssetArchive* GetAssetArchive() { return &m_assetArchive; }
+	CProfiler* GetProfiler() { return &m_profiler; }
+	CJobSystem* GetJobSystem() { return &m_jobSystem; }
+
+	// what the game gets to use, see SServices
+	const SServices* GetServices() { return &m_services; }
 
 	void HandleInput();
 
@@ -99,25 +119,50 @@ private:
 	const int REGULAR_FONT_SIZE_PT = 24;
 	const int BIG_FONT_SIZE_PT = 72;
 
-	// SDL objects
-	SDL_Renderer* m_renderer = nullptr;
+	// SDL objects, the renderer belongs to the render thread
 	SDL_Window* m_window = nullptr;
+	CRenderThread m_renderThread;
 
 	// Font
 	TTF_Font* m_regularFont = nullptr;
 	TTF_Font* m_bigFont = nullptr;
 
 #if SOUND_ENABLED
-	// FMOD objects
-	FMOD::System* m_fmodSystem = nullptr;
-	FMOD::ChannelGroup* m_channelGroup = nullptr;
+	// --audio=<backend> picks something other than the default
+	CAudioBackend::EType m_audioBackendType = CAudioBackend::GetDefaultType();
+	CAudioBackend* m_audioBackend = nullptr;
+	CSoundEventQueue m_soundEventQueue;
+	CAudioThread m_audioThread;
 #endif
 
 	CGameManager m_gameManager;
+	CAssetLoader m_assetLoader;
+	CAssetCache m_assetCache;
+	CAssetArchive m_assetArchive;
+	CProfiler m_profiler;
+	CJobSystem m_jobSystem;
+	CClock m_clock; // advanced once per frame
+	SServices m_services;
+
+	// --benchmark-startup: quit as soon as the first state is on screen and print how long it took to get there
+	bool m_isStartupBenchmark = false;
+
+	// --two-players[=<ms>]: a second player on the same keyboard, its input delayed by the given round trip
+	const Uint32 TWO_PLAYER_DEFAULT_LATENCY_MS = 80;
+
+	// --benchmark-envs=<n>, nothing but the job system is initialized
+	const int ENV_BENCHMARK_NUM_STEPS = 3600; // a minute of game time per environment
+	const Uint32 ENV_BENCHMARK_STEP_MS = 16;
+	const Uint64 ENV_BENCHMARK_SEED = 1;
+	const int ENV_BENCHMARK_NUM_SNAPSHOTS = 1000;
+	const int ENV_BENCHMARK_STRESS_ENVS_PER_THREAD = 64; // far more than the job threads, see RunEnvBenchmark()
+	const int ENV_BENCHMARK_STRESS_NUM_STEPS = 600;
+	int m_numBenchmarkEnvs = 0;
+	bool m_isHeadless = false;
 
 	// app variables / objects
 	const int g_screenWidth = GFX_SCREEN_WIDTH;
 	const int g_screenHeight = GFX_SCREEN_HEIGHT;
 };
 
-void UpdateApp();
+void UpdateApp(int argc, char* args[]);
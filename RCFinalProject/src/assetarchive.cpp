@@ -0,0 +1,194 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "assetarchive.h"
+
+#include <string.h>
+#include "utils.h"
+#if _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+bool CAssetArchive::Open(const std::string& filename)
+{
+	Close();
+
+#if _WIN32
+	HANDLE fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+	{
+		LOG_SCR_F("Asset archive not found: %s, using loose files\n", filename.c_str());
+		return false;
+	}
+	m_fileHandle = fileHandle;
+
+	LARGE_INTEGER fileSize;
+	HANDLE mappingHandle = GetFileSizeEx(fileHandle, &fileSize) ? CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr) : nullptr;
+	if (mappingHandle == nullptr)
+	{
+		LOG_SCR_F("Unable to map asset archive: %s (%lu)\n", filename.c_str(), GetLastError());
+		Close();
+		return false;
+	}
+	m_mappingHandle = mappingHandle;
+
+	m_data = static_cast<const Uint8*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int fileDescriptor = open(filename.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		LOG_SCR_F("Asset archive not found: %s, using loose files\n", filename.c_str());
+		return false;
+	}
+
+	struct stat fileStat;
+	void* mapping = fstat(fileDescriptor, &fileStat) == 0 ? mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0) : MAP_FAILED;
+	close(fileDescriptor); // the mapping stays valid
+	if (mapping != MAP_FAILED)
+	{
+		m_data = static_cast<const Uint8*>(mapping);
+		m_size = static_cast<size_t>(fileStat.st_size);
+	}
+#endif
+
+	if (m_data == nullptr)
+	{
+		LOG_SCR_F("Unable to map asset archive: %s\n", filename.c_str());
+		Close();
+		return false;
+	}
+
+	if (!ValidateContents())
+	{
+		LOG_SCR_F("Invalid asset archive: %s, using loose files\n", filename.c_str());
+		Close();
+		return false;
+	}
+
+	LOG_SCR_F("Asset archive opened: %s (%u assets, %u KB)\n", filename.c_str(), m_numEntries, (unsigned int)(m_size / 1024));
+	return true;
+}
+
+// make sure nothing in the table of contents points outside the file
+bool CAssetArchive::ValidateContents()
+{
+	if (m_size < sizeof(SAssetArchiveHeader))
+	{
+		return false;
+	}
+
+	const SAssetArchiveHeader* header = reinterpret_cast<const SAssetArchiveHeader*>(m_data);
+	if (header->m_magic != ASSET_ARCHIVE_MAGIC || header->m_version != ASSET_ARCHIVE_VERSION)
+	{
+		return false;
+	}
+
+	size_t entriesEnd = sizeof(SAssetArchiveHeader) + static_cast<size_t>(header->m_numEntries) * sizeof(SAssetArchiveEntry);
+	if (entriesEnd > m_size || header->m_stringTableOffset < entriesEnd || header->m_stringTableOffset > m_size)
+	{
+		return false;
+	}
+
+	m_entries = reinterpret_cast<const SAssetArchiveEntry*>(m_data + sizeof(SAssetArchiveHeader));
+	m_stringTable = reinterpret_cast<const char*>(m_data + header->m_stringTableOffset);
+	m_numEntries = header->m_numEntries;
+
+	size_t stringTableSize = m_size - header->m_stringTableOffset;
+	for (Uint32 i = 0; i < m_numEntries; i++)
+	{
+		const SAssetArchiveEntry& entry = m_entries[i];
+		if (static_cast<size_t>(entry.m_pathOffset) + entry.m_pathLength > stringTableSize ||
+			entry.m_blobOffset > m_size || entry.m_blobSize > m_size - entry.m_blobOffset)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void CAssetArchive::Close()
+{
+#if _WIN32
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mappingHandle != nullptr)
+	{
+		CloseHandle(static_cast<HANDLE>(m_mappingHandle));
+	}
+	if (m_fileHandle != nullptr)
+	{
+		CloseHandle(static_cast<HANDLE>(m_fileHandle));
+	}
+#else
+	if (m_data != nullptr)
+	{
+		munmap(const_cast<Uint8*>(m_data), m_size);
+	}
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+	m_entries = nullptr;
+	m_stringTable = nullptr;
+	m_numEntries = 0;
+	m_fileHandle = nullptr;
+	m_mappingHandle = nullptr;
+}
+
+bool CAssetArchive::FindAsset(const std::string& path, const void** data, size_t* size)
+{
+	if (!IsOpen())
+	{
+		return false;
+	}
+
+	// binary search, the packer sorts the entries by path
+	Uint32 first = 0;
+	Uint32 last = m_numEntries;
+	while (first < last)
+	{
+		Uint32 middle = first + (last - first) / 2;
+		const SAssetArchiveEntry& entry = m_entries[middle];
+
+		int result = path.compare(0, std::string::npos, m_stringTable + entry.m_pathOffset, entry.m_pathLength);
+		if (result == 0)
+		{
+			*data = m_data + entry.m_blobOffset;
+			*size = static_cast<size_t>(entry.m_blobSize);
+			return true;
+		}
+		else if (result < 0)
+		{
+			last = middle;
+		}
+		else
+		{
+			first = middle + 1;
+		}
+	}
+
+	return false;
+}
+
+SDL_RWops* CAssetArchive::OpenAsset(const std::string& path)
+{
+	const void* data = nullptr;
+	size_t size = 0;
+	if (FindAsset(path, &data, &size))
+	{
+		return SDL_RWFromConstMem(data, static_cast<int>(size));
+	}
+
+	return SDL_RWFromFile(path.c_str(), "rb");
+}
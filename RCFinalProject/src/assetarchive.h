@@ -0,0 +1,43 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include "assetarchiveformat.h"
+#include <string>
+
+// read-only view of a packed asset archive. the whole file is memory mapped once, assets are then served
+// straight from the mapping without copying. lookups do not modify the archive so they can be done from any thread
+class CAssetArchive
+{
+public:
+	bool Open(const std::string& filename);
+	void Close();
+
+	bool IsOpen() { return m_data != nullptr; }
+
+	// returns false if the archive is not open or does not contain the asset
+	bool FindAsset(const std::string& path, const void** data, size_t* size);
+
+	// reads the asset from the archive if it is there, from the loose file otherwise. nullptr if neither exists
+	SDL_RWops* OpenAsset(const std::string& path);
+
+private:
+	bool ValidateContents();
+
+	const Uint8* m_data = nullptr;
+	size_t m_size = 0;
+	const SAssetArchiveEntry* m_entries = nullptr;
+	const char* m_stringTable = nullptr;
+	Uint32 m_numEntries = 0;
+
+	// platform handles of the mapping
+	void* m_fileHandle = nullptr;
+	void* m_mappingHandle = nullptr;
+};
@@ -0,0 +1,37 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include <stdint.h>
+
+// on-disk layout of the packed asset archive, shared by the game and the AssetPacker tool:
+//
+//   SAssetArchiveHeader
+//   SAssetArchiveEntry[m_numEntries]    sorted by path so they can be binary searched
+//   path string table                   paths are not null terminated
+//   blobs                               each one starts at a multiple of ASSET_ARCHIVE_BLOB_ALIGNMENT
+//
+// all values are little endian. paths are relative to the working directory with forward slashes, e.g.
+// "assets/gfx/starfield_spritesheet.png", exactly as the game builds them from GFX_DIRECTORY/SOUND_DIRECTORY
+
+const uint32_t ASSET_ARCHIVE_MAGIC = 0x4B504453; // "SDPK"
+const uint32_t ASSET_ARCHIVE_VERSION = 1;
+const uint32_t ASSET_ARCHIVE_BLOB_ALIGNMENT = 16;
+
+struct SAssetArchiveHeader
+{
+	uint32_t m_magic;
+	uint32_t m_version;
+	uint32_t m_numEntries;
+	uint32_t m_stringTableOffset;
+};
+
+struct SAssetArchiveEntry
+{
+	uint32_t m_pathOffset; // relative to the string table
+	uint32_t m_pathLength;
+	uint64_t m_blobOffset; // relative to the start of the archive
+	uint64_t m_blobSize;
+};
@@ -0,0 +1,186 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "assetcache.h"
+
+#include <assert.h>
+#include "profiler.h"
+#include "renderthread.h"
+#include "utils.h"
+
+void CAssetCache::Destroy()
+{
+	for (auto& assetIdAndEntry : m_entries)
+	{
+		FreeEntry(assetIdAndEntry.second);
+	}
+	m_entries.clear();
+	m_unreferencedAssets.clear();
+	m_residentBytes = 0;
+}
+
+CAssetCache::AssetId CAssetCache::InternAssetId(const std::string& key)
+{
+	auto it = m_assetIds.find(key);
+	if (it != m_assetIds.end())
+	{
+		return it->second;
+	}
+
+	// ids start at 1, 0 is the invalid id
+	m_assetKeys.push_back(key);
+	AssetId assetId = static_cast<AssetId>(m_assetKeys.size());
+	m_assetIds[key] = assetId;
+	return assetId;
+}
+
+const std::string& CAssetCache::GetAssetKey(AssetId assetId)
+{
+	assert(assetId != INVALID_ASSET_ID && assetId <= m_assetKeys.size());
+	return m_assetKeys[assetId - 1];
+}
+
+CAssetCache::SEntry* CAssetCache::Acquire(AssetId assetId)
+{
+	auto it = m_entries.find(assetId);
+	if (it == m_entries.end())
+	{
+		m_services->m_profiler->IncrementCounter(CProfiler::ECounter::ASSET_CACHE_MISSES);
+		return nullptr;
+	}
+
+	SEntry& entry = it->second;
+	if (entry.m_refCount == 0)
+	{
+		m_unreferencedAssets.erase(entry.m_lruPosition);
+	}
+	entry.m_refCount++;
+
+	m_services->m_profiler->IncrementCounter(CProfiler::ECounter::ASSET_CACHE_HITS);
+	return &entry;
+}
+
+SDL_Texture* CAssetCache::AcquireTexture(AssetId assetId)
+{
+	SEntry* entry = Acquire(assetId);
+	if (entry == nullptr)
+	{
+		return nullptr;
+	}
+
+	assert(entry->m_texture != nullptr);
+	if (entry->m_refCount == 1)
+	{
+		// the previous owners are gone, do not let their blend mode leak into the new one. tint and transparency
+		// belong to each CTexture and are set with every draw
+		SDL_Texture* texture = entry->m_texture;
+		m_services->m_renderThread->Execute([texture](SDL_Renderer* /*renderer*/) { SDL_SetTextureBlendMode(texture, SDL_BLENDMODE_BLEND); });
+	}
+	return entry->m_texture;
+}
+
+#if SOUND_ENABLED
+CAudioBackend::SoundHandle CAssetCache::AcquireSound(AssetId assetId)
+{
+	SEntry* entry = Acquire(assetId);
+	if (entry == nullptr)
+	{
+		return nullptr;
+	}
+
+	assert(entry->m_sound != nullptr);
+	return entry->m_sound;
+}
+#endif
+
+void CAssetCache::AddTexture(AssetId assetId, SDL_Texture* texture)
+{
+	SEntry entry;
+	entry.m_texture = texture;
+
+	// every texture is created as 32 bits per pixel
+	int width = 0;
+	int height = 0;
+	SDL_QueryTexture(texture, nullptr, nullptr, &width, &height);
+	entry.m_sizeInBytes = static_cast<size_t>(width) * height * 4;
+
+	AddEntry(assetId, entry);
+}
+
+#if SOUND_ENABLED
+void CAssetCache::AddSound(AssetId assetId, CAudioBackend::SoundHandle sound)
+{
+	SEntry entry;
+	entry.m_sound = sound;
+	entry.m_sizeInBytes = m_services->m_audioBackend->GetSoundSizeInBytes(sound);
+
+	AddEntry(assetId, entry);
+}
+#endif
+
+void CAssetCache::AddEntry(AssetId assetId, const SEntry& entry)
+{
+	assert(assetId != INVALID_ASSET_ID);
+	assert(m_entries.find(assetId) == m_entries.end());
+
+	SEntry& newEntry = m_entries[assetId];
+	newEntry = entry;
+	newEntry.m_refCount = 1;
+	m_residentBytes += newEntry.m_sizeInBytes;
+
+	LOG_SCR_F("Asset cached: %s (%u KB, %u KB resident)\n", GetAssetKey(assetId).c_str(), (unsigned int)(newEntry.m_sizeInBytes / 1024), (unsigned int)(m_residentBytes / 1024));
+
+	EvictUnreferencedAssets();
+}
+
+void CAssetCache::Release(AssetId assetId)
+{
+	auto it = m_entries.find(assetId);
+	assert(it != m_entries.end());
+	if (it == m_entries.end())
+	{
+		return;
+	}
+
+	SEntry& entry = it->second;
+	assert(entry.m_refCount > 0);
+	entry.m_refCount--;
+	if (entry.m_refCount == 0)
+	{
+		// keep it around in case it is needed again soon
+		entry.m_lruPosition = m_unreferencedAssets.insert(m_unreferencedAssets.end(), assetId);
+		EvictUnreferencedAssets();
+	}
+}
+
+void CAssetCache::EvictUnreferencedAssets()
+{
+	while (m_residentBytes > BUDGET_BYTES && !m_unreferencedAssets.empty())
+	{
+		AssetId assetId = m_unreferencedAssets.front();
+		m_unreferencedAssets.pop_front();
+
+		auto it = m_entries.find(assetId);
+		LOG_SCR_F("Asset evicted: %s\n", GetAssetKey(assetId).c_str());
+		m_residentBytes -= it->second.m_sizeInBytes;
+		FreeEntry(it->second);
+		m_entries.erase(it);
+	}
+}
+
+void CAssetCache::FreeEntry(SEntry& entry)
+{
+	if (entry.m_texture != nullptr)
+	{
+		m_services->m_renderThread->DestroyTexture(entry.m_texture);
+		entry.m_texture = nullptr;
+	}
+#if SOUND_ENABLED
+	if (entry.m_sound != nullptr)
+	{
+		m_services->m_audioBackend->ReleaseSound(entry.m_sound);
+		entry.m_sound = nullptr;
+	}
+#endif
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include <list>
+#include "preproc.h"
+#include "services.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+#if SOUND_ENABLED
+#include "audiobackend.h"
+#endif
+
+// keeps loaded textures and sounds resident while they are referenced, and for a while after that, so
+// recreating a game state does not load everything again. unreferenced assets are evicted least recently
+// used first once the cache grows past ASSET_CACHE_BUDGET_MB. only to be used from the main thread
+class CAssetCache
+{
+public:
+	typedef Uint32 AssetId;
+	static const AssetId INVALID_ASSET_ID = 0;
+
+	void Init(const SServices* services) { m_services = services; }
+	void Destroy();
+
+	// maps an asset key (usually its path) to a small id that is cheap to hash and compare
+	AssetId InternAssetId(const std::string& key);
+	const std::string& GetAssetKey(AssetId assetId);
+
+	// both return nullptr if the asset is not resident, otherwise a reference is added that must be released
+	SDL_Texture* AcquireTexture(AssetId assetId);
+#if SOUND_ENABLED
+	CAudioBackend::SoundHandle AcquireSound(AssetId assetId);
+#endif
+
+	// hands a newly loaded asset over to the cache, the caller holds the first reference
+	void AddTexture(AssetId assetId, SDL_Texture* texture);
+#if SOUND_ENABLED
+	void AddSound(AssetId assetId, CAudioBackend::SoundHandle sound);
+#endif
+
+	void Release(AssetId assetId);
+
+	size_t GetResidentBytes() { return m_residentBytes; }
+
+private:
+	const size_t BUDGET_BYTES = static_cast<size_t>(ASSET_CACHE_BUDGET_MB) * 1024 * 1024;
+
+	struct SEntry
+	{
+		SDL_Texture* m_texture = nullptr;
+#if SOUND_ENABLED
+		CAudioBackend::SoundHandle m_sound = nullptr;
+#endif
+		size_t m_sizeInBytes = 0;
+		int m_refCount = 0;
+		std::list<AssetId>::iterator m_lruPosition; // only valid while m_refCount is 0
+	};
+
+	SEntry* Acquire(AssetId assetId);
+	void AddEntry(AssetId assetId, const SEntry& entry);
+	void EvictUnreferencedAssets();
+	void FreeEntry(SEntry& entry);
+
+	const SServices* m_services = nullptr;
+	std::unordered_map<std::string, AssetId> m_assetIds;
+	std::vector<std::string> m_assetKeys;
+	std::unordered_map<AssetId, SEntry> m_entries;
+	std::list<AssetId> m_unreferencedAssets; // least recently used first
+	size_t m_residentBytes = 0;
+};
@@ -0,0 +1,311 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "assetloader.h"
+
+#include <algorithm>
+#include <assert.h>
+#if SOUND_ENABLED
+#include "sound.h"
+#endif
+#include "texture.h"
+#include "utils.h"
+
+void CAssetLoader::Init(const SServices* services)
+{
+	m_services = services;
+
+	// leave a core for the main thread
+	int numWorkerThreads = std::max(1, std::min(MAX_WORKER_THREADS, SDL_GetCPUCount() - 1));
+	LOG_SCR_F("Starting asset loader with %d worker threads\n", numWorkerThreads);
+
+	m_isShuttingDown = false;
+	for (int i = 0; i < numWorkerThreads; i++)
+	{
+		m_workerThreads.emplace_back(&CAssetLoader::WorkerThreadMain, this);
+	}
+}
+
+void CAssetLoader::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isShuttingDown = true;
+	}
+	m_condition.notify_all();
+
+	for (std::thread& workerThread : m_workerThreads)
+	{
+		workerThread.join();
+	}
+	m_workerThreads.clear();
+
+	// nobody is going to receive these anymore
+	for (SRequest* request : m_pendingRequests)
+	{
+		DiscardRequest(request);
+	}
+	for (SRequest* request : m_finishedRequests)
+	{
+		DiscardRequest(request);
+	}
+	m_pendingRequests.clear();
+	m_finishedRequests.clear();
+}
+
+void CAssetLoader::QueueTexture(CTexture* texture, const std::string& filename)
+{
+	assert(texture != nullptr);
+
+	// if the texture is already initialized, destroy it first
+	texture->Destroy();
+
+	std::string path = GFX_DIRECTORY;
+	path.append(filename);
+	CAssetCache::AssetId assetId = m_services->m_assetCache->InternAssetId(path);
+	if (texture->CreateFromCache(assetId))
+	{
+		return;
+	}
+
+	texture->SetIsLoading(true);
+
+	SRequest* request = new SRequest;
+	request->m_type = EAssetType::TEXTURE;
+	request->m_path = path;
+	request->m_assetId = assetId;
+	request->m_texture = texture;
+	QueueRequest(request);
+}
+
+#if SOUND_ENABLED
+void CAssetLoader::QueueSound(CSound* sound, const std::string& filename)
+{
+	assert(sound != nullptr);
+
+	// if the sound is already initialized, destroy it first
+	sound->Destroy();
+
+	std::string path = SOUND_DIRECTORY;
+	path.append(filename);
+	CAssetCache::AssetId assetId = m_services->m_assetCache->InternAssetId(path);
+	if (sound->CreateFromCache(assetId))
+	{
+		return;
+	}
+
+	sound->SetIsLoading(true);
+
+	SRequest* request = new SRequest;
+	request->m_type = EAssetType::SOUND;
+	request->m_path = path;
+	request->m_assetId = assetId;
+	request->m_sound = sound;
+	QueueRequest(request);
+}
+#endif
+
+void CAssetLoader::QueueRequest(SRequest* request)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+
+		// start counting a new batch if everything from the previous one was delivered
+		if (m_numDeliveredRequests == m_numQueuedRequests)
+		{
+			m_numQueuedRequests = 0;
+			m_numDeliveredRequests = 0;
+		}
+
+		m_pendingRequests.push_back(request);
+		m_numQueuedRequests++;
+	}
+	m_condition.notify_one();
+}
+
+void CAssetLoader::Cancel(CTexture* texture)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	// requests being processed by a worker can not be pulled out, they are discarded once finished instead
+	for (std::deque<SRequest*>* requests : { &m_pendingRequests, &m_finishedRequests })
+	{
+		for (SRequest* request : *requests)
+		{
+			if (request->m_texture == texture)
+			{
+				request->m_texture = nullptr;
+			}
+		}
+	}
+	for (SRequest* request : m_inFlightRequests)
+	{
+		if (request->m_texture == texture)
+		{
+			request->m_texture = nullptr;
+		}
+	}
+	texture->SetIsLoading(false);
+}
+
+#if SOUND_ENABLED
+void CAssetLoader::Cancel(CSound* sound)
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+
+	for (std::deque<SRequest*>* requests : { &m_pendingRequests, &m_finishedRequests })
+	{
+		for (SRequest* request : *requests)
+		{
+			if (request->m_sound == sound)
+			{
+				request->m_sound = nullptr;
+			}
+		}
+	}
+	for (SRequest* request : m_inFlightRequests)
+	{
+		if (request->m_sound == sound)
+		{
+			request->m_sound = nullptr;
+		}
+	}
+	sound->SetIsLoading(false);
+}
+#endif
+
+void CAssetLoader::WorkerThreadMain()
+{
+	while (true)
+	{
+		SRequest* request = nullptr;
+		{
+			std::unique_lock<std::mutex> lock(m_mutex);
+			m_condition.wait(lock, [this] { return m_isShuttingDown || !m_pendingRequests.empty(); });
+			if (m_isShuttingDown)
+			{
+				return;
+			}
+
+			request = m_pendingRequests.front();
+			m_pendingRequests.pop_front();
+			m_inFlightRequests.push_back(request);
+		}
+
+		ProcessRequest(request);
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_inFlightRequests.erase(std::find(m_inFlightRequests.begin(), m_inFlightRequests.end(), request));
+			m_finishedRequests.push_back(request);
+		}
+	}
+}
+
+// runs on a worker thread, only the path and the result fields of the request can be touched here
+void CAssetLoader::ProcessRequest(SRequest* request)
+{
+	if (request->m_type == EAssetType::TEXTURE)
+	{
+		// decoded in the format textures are created with, so the upload on the main thread is a straight copy
+		request->m_surface = CTexture::LoadSurface(m_services, request->m_path);
+	}
+#if SOUND_ENABLED
+	else if (request->m_type == EAssetType::SOUND)
+	{
+		// creating sounds is thread safe in every backend, the sound is read and decoded here
+		request->m_soundHandle = m_services->m_audioBackend->CreateSound(request->m_path);
+		if (request->m_soundHandle == nullptr)
+		{
+			LOG_SCR_F("Unable to load sound: %s\n", request->m_path.c_str());
+		}
+	}
+#endif
+}
+
+void CAssetLoader::Update()
+{
+	Uint32 startTicks = Utils::GetTicks();
+
+	while (true)
+	{
+		SRequest* request = nullptr;
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			if (m_finishedRequests.empty())
+			{
+				return;
+			}
+
+			request = m_finishedRequests.front();
+			m_finishedRequests.pop_front();
+			m_numDeliveredRequests++;
+		}
+
+		DeliverRequest(request);
+
+		if (Utils::GetTicks() - startTicks > UPLOAD_TIME_BUDGET_MS)
+		{
+			return;
+		}
+	}
+}
+
+void CAssetLoader::DeliverRequest(SRequest* request)
+{
+	if (request->m_texture != nullptr)
+	{
+		request->m_texture->SetIsLoading(false);
+
+		// the same asset may have been requested twice, in that case it is already in the cache
+		if (!request->m_texture->CreateFromCache(request->m_assetId) && request->m_surface != nullptr)
+		{
+			request->m_texture->CreateFromSurface(request->m_surface, request->m_assetId);
+			LOG_SCR_F("Texture loaded successfully: %s\n", request->m_path.c_str());
+		}
+	}
+#if SOUND_ENABLED
+	if (request->m_sound != nullptr)
+	{
+		request->m_sound->SetIsLoading(false);
+
+		// the same asset may have been requested twice, in that case it is already in the cache
+		if (!request->m_sound->CreateFromCache(request->m_assetId) && request->m_soundHandle != nullptr)
+		{
+			request->m_sound->CreateFromHandle(request->m_soundHandle, request->m_assetId);
+			request->m_soundHandle = nullptr; // the cache owns it now
+			LOG_SCR_F("Sound loaded successfully: %s\n", request->m_path.c_str());
+		}
+	}
+#endif
+
+	DiscardRequest(request);
+}
+
+void CAssetLoader::DiscardRequest(SRequest* request)
+{
+	if (request->m_surface != nullptr)
+	{
+		SDL_FreeSurface(request->m_surface);
+	}
+#if SOUND_ENABLED
+	if (request->m_soundHandle != nullptr)
+	{
+		m_services->m_audioBackend->ReleaseSound(request->m_soundHandle);
+	}
+#endif
+	delete request;
+}
+
+float CAssetLoader::GetProgress()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_numQueuedRequests == 0 ? 1.0f : static_cast<float>(m_numDeliveredRequests) / m_numQueuedRequests;
+}
+
+bool CAssetLoader::IsIdle()
+{
+	std::lock_guard<std::mutex> lock(m_mutex);
+	return m_numDeliveredRequests == m_numQueuedRequests;
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include "assetcache.h"
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include "preproc.h"
+#include "services.h"
+#include <string>
+#include <thread>
+#include <vector>
+#if SOUND_ENABLED
+#include "audiobackend.h"
+#endif
+
+class CTexture;
+#if SOUND_ENABLED
+class CSound;
+#endif
+
+// loads assets on worker threads: images are decoded to SDL surfaces and sounds are created by the audio backend off the
+// main thread, Update() then hands them over to their owners on the main thread (textures are uploaded there).
+// assets still resident in the asset cache are handed over right away without being queued
+class CAssetLoader
+{
+public:
+	void Init(const SServices* services);
+	void Destroy();
+
+	void QueueTexture(CTexture* texture, const std::string& filename);
+#if SOUND_ENABLED
+	void QueueSound(CSound* sound, const std::string& filename);
+#endif
+
+	// the owner is going away, its asset must not be delivered anymore
+	void Cancel(CTexture* texture);
+#if SOUND_ENABLED
+	void Cancel(CSound* sound);
+#endif
+
+	// must be called from the main thread every frame
+	void Update();
+
+	// progress of everything queued since the loader was last idle, from 0.0f to 1.0f
+	float GetProgress();
+	bool IsIdle();
+
+private:
+	enum class EAssetType : int
+	{
+		TEXTURE,
+		SOUND
+	};
+
+	struct SRequest
+	{
+		EAssetType m_type = EAssetType::TEXTURE;
+		std::string m_path;
+		CAssetCache::AssetId m_assetId = CAssetCache::INVALID_ASSET_ID;
+		CTexture* m_texture = nullptr;
+		SDL_Surface* m_surface = nullptr;
+#if SOUND_ENABLED
+		CSound* m_sound = nullptr;
+		CAudioBackend::SoundHandle m_soundHandle = nullptr;
+#endif
+	};
+
+	const int MAX_WORKER_THREADS = 4;
+	const Uint32 UPLOAD_TIME_BUDGET_MS = 4; // spread texture uploads over several frames if they take longer than this
+
+	void QueueRequest(SRequest* request);
+	void WorkerThreadMain();
+	void ProcessRequest(SRequest* request);
+	void DeliverRequest(SRequest* request);
+	void DiscardRequest(SRequest* request);
+
+	const SServices* m_services = nullptr;
+	std::vector<std::thread> m_workerThreads;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<SRequest*> m_pendingRequests;
+	std::vector<SRequest*> m_inFlightRequests;
+	std::deque<SRequest*> m_finishedRequests;
+	bool m_isShuttingDown = false;
+
+	int m_numQueuedRequests = 0;
+	int m_numDeliveredRequests = 0;
+};
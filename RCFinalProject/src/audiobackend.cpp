@@ -0,0 +1,63 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+#include "audiobackend.h"
+
+#if SOUND_FMOD_ENABLED
+#include "fmodaudiobackend.h"
+#endif
+#include "nullaudiobackend.h"
+#include "sdlaudiobackend.h"
+
+CAudioBackend* CAudioBackend::Create(EType type)
+{
+	switch (type)
+	{
+#if SOUND_FMOD_ENABLED
+	case EType::FMOD:
+		return new CFmodAudioBackend(); // polymorphism
+#endif
+	case EType::SDL:
+		return new CSdlAudioBackend();
+	default:
+		return new CNullAudioBackend();
+	}
+}
+
+// the names accepted by --audio=, returns false for an unknown name (or a backend that was not compiled in)
+bool CAudioBackend::ParseType(const std::string& name, EType* type)
+{
+#if SOUND_FMOD_ENABLED
+	if (name == "fmod")
+	{
+		*type = EType::FMOD;
+		return true;
+	}
+#endif
+	if (name == "sdl")
+	{
+		*type = EType::SDL;
+		return true;
+	}
+	if (name == "null")
+	{
+		*type = EType::NONE;
+		return true;
+	}
+
+	return false;
+}
+
+CAudioBackend::EType CAudioBackend::GetDefaultType()
+{
+#if SOUND_FMOD_ENABLED
+	return EType::FMOD;
+#else
+	return EType::SDL;
+#endif
+}
+#endif
@@ -0,0 +1,65 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include <string>
+
+class CAssetArchive;
+
+// what the game needs from an audio library. the backend is picked at startup (--audio=fmod/sdl/null), so the
+// game also runs on machines without FMOD or without any audio device
+class CAudioBackend
+{
+public:
+	enum class EType : int
+	{
+		FMOD,
+		SDL,
+		NONE
+	};
+
+	// opaque to everything but the backend that created them
+	typedef void* SoundHandle;
+	typedef Uint64 VoiceHandle;
+	static const VoiceHandle INVALID_VOICE = 0;
+
+	static CAudioBackend* Create(EType type);
+	static bool ParseType(const std::string& name, EType* type);
+	static EType GetDefaultType();
+
+	virtual ~CAudioBackend() {}
+
+	// the sounds are read from the asset archive, or from disk if they are not in it
+	virtual bool Init(CAssetArchive* assetArchive) = 0;
+	virtual void Destroy() = 0;
+	virtual const char* GetName() = 0;
+
+	// thread safe, sounds are created on the asset loader's worker threads. nullptr if the sound can not be loaded
+	virtual SoundHandle CreateSound(const std::string& path) = 0;
+	virtual void ReleaseSound(SoundHandle sound) = 0;
+	virtual size_t GetSoundSizeInBytes(SoundHandle sound) = 0;
+
+	// audio thread only
+	virtual void Update() = 0;
+	// looping belongs to the voice, a sound can be shared by several users through the asset cache
+	virtual VoiceHandle PlaySound(SoundHandle sound, float volume, bool isLooping) = 0;
+	virtual void StopVoice(VoiceHandle voice) = 0;
+	virtual bool IsVoicePlaying(VoiceHandle voice) = 0;
+	virtual float GetVoiceAudibility(VoiceHandle voice) = 0;
+
+	// time spent mixing since the last call, for backends that mix the audio themselves
+	virtual Uint32 TakeMixTimeUs() { return 0; }
+};
+
+#endif
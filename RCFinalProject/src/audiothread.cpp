@@ -0,0 +1,112 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+#include "audiothread.h"
+
+#include <assert.h>
+#include "sound.h"
+#include "utils.h"
+
+void CAudioThread::Init(CAudioBackend* audioBackend)
+{
+	LOG_SCR("Starting audio thread");
+
+	m_audioBackend = audioBackend;
+	m_wakeSemaphore = SDL_CreateSemaphore(0);
+	m_isShuttingDown = false;
+	m_thread = std::thread(&CAudioThread::ThreadMain, this);
+}
+
+void CAudioThread::Destroy()
+{
+	if (!m_thread.joinable())
+	{
+		return;
+	}
+
+	LOG_SCR("Stopping audio thread");
+
+	m_isShuttingDown = true;
+	Wake();
+	m_thread.join();
+
+	SDL_DestroySemaphore(m_wakeSemaphore);
+	m_wakeSemaphore = nullptr;
+}
+
+Uint64 CAudioThread::Submit(const SCommand& command)
+{
+	assert(command.m_sound != nullptr);
+
+	// the audio thread empties the queue every few milliseconds, a full queue only means waiting for that
+	while (!m_commandQueue.Push(command))
+	{
+		Wake();
+		std::this_thread::yield();
+	}
+
+	return ++m_numSubmittedCommands;
+}
+
+// have the audio thread carry out the submitted commands now instead of at its next update
+void CAudioThread::Wake()
+{
+	SDL_SemPost(m_wakeSemaphore);
+}
+
+void CAudioThread::Flush(Uint64 commandNumber)
+{
+	if (m_numProcessedCommands.load(std::memory_order_acquire) >= commandNumber)
+	{
+		return;
+	}
+
+	Wake();
+	while (m_numProcessedCommands.load(std::memory_order_acquire) < commandNumber)
+	{
+		std::this_thread::yield();
+	}
+}
+
+void CAudioThread::ThreadMain()
+{
+	while (!m_isShuttingDown)
+	{
+		ProcessCommands();
+		m_audioBackend->Update();
+
+		// sleep until the next update, or until the game thread has something to play
+		SDL_SemWaitTimeout(m_wakeSemaphore, UPDATE_INTERVAL_MS);
+	}
+
+	ProcessCommands();
+}
+
+void CAudioThread::ProcessCommands()
+{
+	SCommand command;
+	while (m_commandQueue.Pop(command))
+	{
+		switch (command.m_type)
+		{
+		case ECommandType::PLAY:
+			command.m_sound->StartVoice(command.m_volume, command.m_isLooping);
+			break;
+
+		case ECommandType::STOP:
+			command.m_sound->StopVoices();
+			break;
+
+		case ECommandType::SET_MAX_VOICES:
+			command.m_sound->ApplyMaxVoices(command.m_maxVoices);
+			break;
+		}
+
+		m_numProcessedCommands.fetch_add(1, std::memory_order_release);
+	}
+}
+#endif
@@ -0,0 +1,76 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include <atomic>
+#include "audiobackend.h"
+#include "spscqueue.h"
+#include <thread>
+
+class CSound;
+
+// services the audio backend on its own thread, so a slow frame does not delay the audio. the game thread never touches the
+// playing channels itself: it submits commands through a lock-free queue and the audio thread carries them out
+class CAudioThread
+{
+public:
+	enum class ECommandType : int
+	{
+		PLAY,
+		STOP,
+		SET_MAX_VOICES
+	};
+
+	struct SCommand
+	{
+		ECommandType m_type = ECommandType::PLAY;
+		CSound* m_sound = nullptr;
+		float m_volume = 0.0f; // PLAY
+		bool m_isLooping = false; // PLAY
+		int m_maxVoices = 0; // SET_MAX_VOICES
+	};
+
+	void Init(CAudioBackend* audioBackend);
+	void Destroy();
+
+	// game thread only. returns the number of the command, for Flush()
+	Uint64 Submit(const SCommand& command);
+	void Wake();
+
+	// blocks until the audio thread has carried out every command up to the given one
+	void Flush(Uint64 commandNumber);
+
+	// called by the sounds on the audio thread
+	void OnVoiceStolen() { m_numVoicesStolen++; }
+	Uint32 TakeNumVoicesStolen() { return m_numVoicesStolen.exchange(0); }
+
+private:
+	static const size_t COMMAND_QUEUE_CAPACITY = 256;
+	const Uint32 UPDATE_INTERVAL_MS = 5;
+
+	void ThreadMain();
+	void ProcessCommands();
+
+	CAudioBackend* m_audioBackend = nullptr;
+	std::thread m_thread;
+	SDL_sem* m_wakeSemaphore = nullptr;
+	std::atomic<bool> m_isShuttingDown{ false };
+
+	CSpscQueue<SCommand, COMMAND_QUEUE_CAPACITY> m_commandQueue;
+	Uint64 m_numSubmittedCommands = 0; // game thread only
+	std::atomic<Uint64> m_numProcessedCommands{ 0 };
+	std::atomic<Uint32> m_numVoicesStolen{ 0 };
+};
+
+#endif
@@ -56,7 +56,7 @@ void CBoss::Spawn(EBossType bossType)
 
 	if (bossType == EBossType::RANDOM)
 	{
-		bossType = static_cast<EBossType>(Utils::GetRandomUint32(static_cast<Uint32>(EBossType::SAUCER), static_cast<Uint32>(EBossType::WALKER)));
+		bossType = static_cast<EBossType>(m_ingameState->GetRandom()->GetUint32(static_cast<Uint32>(EBossType::SAUCER), static_cast<Uint32>(EBossType::WALKER)));
 	}
 
 	if (bossType == EBossType::SAUCER)
@@ -91,8 +91,7 @@ void CBoss::Spawn(EBossType bossType)
 	}
 
 	// scale the speed by the difficulty multiplier
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-	float difficultyMultiplier = ingameState->GetCurrentDifficultyMultiplier();
+	float difficultyMultiplier = m_ingameState->GetCurrentDifficultyMultiplier();
 
 	SetSpriteWidth(spriteWidth);
 	SetSpriteHeight(spriteHeight);
@@ -101,7 +100,7 @@ void CBoss::Spawn(EBossType bossType)
 	m_stayOnCenterTimeMs = stayOnCenterTimeMs;
 
 	// calculate initial position
-	m_initialPosX = static_cast<float>(CApp::GetInstance()->GetScreenWidth()); // position it on the right edge of the screen
+	m_initialPosX = static_cast<float>(m_services->m_screenWidth); // position it on the right edge of the screen
 	m_initialPosY = static_cast<float>((BOSS_SPAWN_Y_LBOUND + BOSS_SPAWN_Y_UBOUND - spriteHeight) / 2.0f);
 	SetPosition(m_initialPosX, m_initialPosY);
 
@@ -115,7 +114,7 @@ void CBoss::Spawn(EBossType bossType)
 	m_state = EState::ENTERING;
 
 #if SOUND_ENABLED
-	m_spawnSound->Play();
+	m_ingameState->GetCommandBuffer()->PlaySound(m_spawnSound);
 #endif
 
 	SetIsAlive(true);
@@ -123,7 +122,8 @@ void CBoss::Spawn(EBossType bossType)
 
 void CBoss::Despawn()
 {
-	if (!IsAlive() || m_state == EState::UNASSIGNED)
+	// a boss that was hit is already marked dead when its despawn command is applied
+	if (m_state == EState::UNASSIGNED)
 	{
 		return;
 	}
@@ -155,31 +155,31 @@ void CBoss::Update(Uint32 elapsedTime)
 	if (m_state == EState::ENTERING)
 	{
 		// check if boss has reached the center of the screen horizontally
-		float limit = (CApp::GetInstance()->GetScreenWidth() - GetSpriteWidth()) / 2.0f;
+		float limit = (m_services->m_screenWidth - GetSpriteWidth()) / 2.0f;
 		if (m_x <= limit)
 		{
 			m_x = limit;
 			m_state = EState::HOVER;
-			m_lastHoverTicks = Utils::GetTicks();
+			m_lastHoverTicks = GetGameTicks();
 
 #if SOUND_ENABLED
 			if (CanBossNullifyPlayerShield(m_currentBossType))
 			{
-				m_nullifySound->Play();
+				m_ingameState->GetCommandBuffer()->PlaySound(m_nullifySound);
 			}
 			else if (CanBossMakeEnemiesShootDiagonally(m_currentBossType))
 			{
-				m_enhanceSound->Play();
+				m_ingameState->GetCommandBuffer()->PlaySound(m_enhanceSound);
 			}			
 #endif
 		}
 	}
 	else if (m_state == EState::HOVER)
 	{
-		if (Utils::GetTicks() - m_lastHoverTicks > m_stayOnCenterTimeMs)
+		if (GetGameTicks() - m_lastHoverTicks > m_stayOnCenterTimeMs)
 		{
 			m_state = EState::LEAVING;
-			m_lastHoverTicks = Utils::GetTicks();
+			m_lastHoverTicks = GetGameTicks();
 		}
 	}
 	else if (m_state == EState::LEAVING)
@@ -192,8 +192,7 @@ void CBoss::Update(Uint32 elapsedTime)
 			m_state = EState::UNASSIGNED;			
 			SetIsAlive(false);
 
-			CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-			ingameState->OnBossLeave();
+			m_ingameState->OnBossLeave();
 		}
 	}
 
@@ -210,6 +209,33 @@ void CBoss::Draw()
 	m_animationMgr.Draw(static_cast<int>(m_x), static_cast<int>(m_y));
 }
 
+void CBoss::SaveState(SState* state) const
+{
+	SaveEntityState(&state->m_entity);
+	state->m_initialPosX = m_initialPosX;
+	state->m_initialPosY = m_initialPosY;
+	state->m_currentBossType = m_currentBossType;
+	state->m_state = m_state;
+	state->m_lastHoverTicks = m_lastHoverTicks;
+	state->m_stayOnCenterTimeMs = m_stayOnCenterTimeMs;
+	state->m_bossPointsWorth = m_bossPointsWorth;
+}
+
+void CBoss::RestoreState(const SState& state)
+{
+	// the frame size depends on the boss type
+	m_animationMgr.Setup(m_animTable, state.m_entity.m_spriteWidth, state.m_entity.m_spriteHeight, m_spriteSheetTexture);
+
+	RestoreEntityState(state.m_entity);
+	m_initialPosX = state.m_initialPosX;
+	m_initialPosY = state.m_initialPosY;
+	m_currentBossType = state.m_currentBossType;
+	m_state = state.m_state;
+	m_lastHoverTicks = state.m_lastHoverTicks;
+	m_stayOnCenterTimeMs = state.m_stayOnCenterTimeMs;
+	m_bossPointsWorth = state.m_bossPointsWorth;
+}
+
 bool CBoss::CanBossNullifyPlayerShield(EBossType bossType)
 {
 	return bossType == EBossType::SPIDER;
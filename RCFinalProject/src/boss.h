@@ -65,6 +65,18 @@ public:
 	const Uint32 WALKER_STAY_ON_CENTER_TIME_MS = 5000;
 	const int WALKER_POINTS_WORTH = 1000;
 
+	struct SState
+	{
+		SEntityState m_entity;
+		float m_initialPosX;
+		float m_initialPosY;
+		EBossType m_currentBossType;
+		EState m_state;
+		Uint32 m_lastHoverTicks;
+		Uint32 m_stayOnCenterTimeMs;
+		Sint32 m_bossPointsWorth;
+	};
+
 	CBoss();
 
 	void Init(CTexture* spriteSheetTexture);
@@ -83,12 +95,17 @@ public:
 	float GetInitialPosY() const { return m_initialPosY; }
 
 	EState GetState() const { return m_state; }
+	EBossType GetBossType() const { return m_currentBossType; }
 
 	bool IsNullifyingPlayerShield() { return m_state == EState::HOVER && CanBossNullifyPlayerShield(m_currentBossType); }
 	bool IsMakingEnemiesShootDiagonally() { return m_state == EState::HOVER && CanBossMakeEnemiesShootDiagonally(m_currentBossType); }
 	int GetPointsWorth() { return m_bossPointsWorth; }
 
 	void OnLeave();
+
+	// the boss has to be initialized already
+	void SaveState(SState* state) const;
+	void RestoreState(const SState& state);
 	
 private:
 	bool CanBossNullifyPlayerShield(EBossType bossType);
@@ -0,0 +1,26 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+
+// milliseconds advanced explicitly by its owner instead of read from the wall clock. the app owns one that follows
+// the frames it presents, every game owns another that only moves while the game ticks, so pausing, fast forwarding
+// or resimulating a game moves its timers along with it
+class CClock
+{
+public:
+	void Advance(Uint32 elapsedTime) { m_ticks += elapsedTime; }
+
+	Uint32 GetTicks() const { return m_ticks; }
+	void SetTicks(Uint32 ticks) { m_ticks = ticks; }
+
+private:
+	Uint32 m_ticks = 0;
+};
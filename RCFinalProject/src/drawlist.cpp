@@ -0,0 +1,76 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "drawlist.h"
+
+#include <assert.h>
+#include "renderstatecache.h"
+
+void CDrawList::Draw(SDL_Renderer* renderer, CRenderStateCache* renderStateCache)
+{
+	for (const SCommand& command : m_commands)
+	{
+		DrawCommand(renderer, renderStateCache, command);
+	}
+}
+
+void CDrawList::DrawCommand(SDL_Renderer* renderer, CRenderStateCache* renderStateCache, const SCommand& command)
+{
+	switch (command.m_type)
+	{
+	case ECommandType::SPRITE:
+	{
+		assert(command.m_texture != nullptr);
+
+		renderStateCache->SetTextureColorMod(command.m_texture, command.m_color.r, command.m_color.g, command.m_color.b);
+		renderStateCache->SetTextureAlphaMod(command.m_texture, command.m_color.a);
+
+		const SDL_Rect* sourceRect = command.m_hasSourceRect ? &command.m_sourceRect : nullptr;
+		if (command.m_angleInDegrees == 0.0 && command.m_textureFlipping == SDL_FLIP_NONE)
+		{
+			// almost nothing is rotated or flipped, and SDL_RenderCopyEx takes a much slower path on the software renderer
+			SDL_RenderCopy(renderer, command.m_texture, sourceRect, &command.m_rect);
+		}
+		else
+		{
+			const SDL_Point* rotationCenterPoint = command.m_hasRotationCenterPoint ? &command.m_rotationCenterPoint : nullptr;
+			SDL_RenderCopyEx(renderer, command.m_texture, sourceRect, &command.m_rect, command.m_angleInDegrees, rotationCenterPoint, command.m_textureFlipping);
+		}
+		break;
+	}
+
+	case ECommandType::LINE:
+		renderStateCache->SetDrawBlendMode(command.m_blendMode);
+		renderStateCache->SetDrawColor(command.m_color);
+		SDL_RenderDrawLine(renderer, command.m_rect.x, command.m_rect.y, command.m_rect.x + command.m_rect.w, command.m_rect.y + command.m_rect.h);
+		break;
+
+	case ECommandType::RECT:
+		renderStateCache->SetDrawBlendMode(command.m_blendMode);
+		renderStateCache->SetDrawColor(command.m_color);
+		SDL_RenderDrawRect(renderer, &command.m_rect);
+		break;
+
+	case ECommandType::FILLED_RECT:
+		renderStateCache->SetDrawBlendMode(command.m_blendMode);
+		renderStateCache->SetDrawColor(command.m_color);
+		SDL_RenderFillRect(renderer, &command.m_rect);
+		break;
+	}
+}
+
+void CDrawList::DestroyTextures()
+{
+	for (SDL_Texture* texture : m_texturesToDestroy)
+	{
+		SDL_DestroyTexture(texture);
+	}
+	m_texturesToDestroy.clear();
+}
+
+void CDrawList::Clear()
+{
+	assert(m_texturesToDestroy.empty());
+	m_commands.clear();
+}
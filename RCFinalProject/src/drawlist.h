@@ -0,0 +1,68 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include <vector>
+
+class CRenderStateCache;
+
+// everything drawn during one frame, recorded by the game thread and drawn by the render thread. it only holds
+// plain values, nothing in it points back into the game objects that recorded it
+class CDrawList
+{
+public:
+	enum class ECommandType : int
+	{
+		SPRITE,
+		LINE,
+		RECT,
+		FILLED_RECT
+	};
+
+	struct SCommand
+	{
+		ECommandType m_type = ECommandType::SPRITE;
+
+		// SPRITE
+		SDL_Texture* m_texture = nullptr;
+		SDL_Rect m_sourceRect{ 0, 0, 0, 0 };
+		bool m_hasSourceRect = false;
+		double m_angleInDegrees = 0.0;
+		SDL_Point m_rotationCenterPoint{ 0, 0 };
+		bool m_hasRotationCenterPoint = false;
+		SDL_RendererFlip m_textureFlipping = SDL_FLIP_NONE;
+
+		// the sprite's destination or the primitive's rect, a line goes from (x, y) to (x + w, y + h)
+		SDL_Rect m_rect{ 0, 0, 0, 0 };
+
+		// the tint and alpha of a sprite, the draw color of a primitive
+		SDL_Color m_color{ 255, 255, 255, 255 };
+
+		// LINE, RECT, FILLED_RECT. set for every primitive, so none of them inherits the blend mode of the one before
+		SDL_BlendMode m_blendMode = SDL_BLENDMODE_NONE;
+	};
+
+	void Add(const SCommand& command) { m_commands.push_back(command); }
+	void Draw(SDL_Renderer* renderer, CRenderStateCache* renderStateCache);
+	static void DrawCommand(SDL_Renderer* renderer, CRenderStateCache* renderStateCache, const SCommand& command);
+
+	// textures destroyed while the frame was recorded, they go once it has been presented
+	void AddTextureToDestroy(SDL_Texture* texture) { m_texturesToDestroy.push_back(texture); }
+	void DestroyTextures();
+
+	// keeps the memory, the lists are about the same size every frame
+	void Clear();
+
+	size_t GetNumCommands() { return m_commands.size(); }
+
+private:
+	std::vector<SCommand> m_commands;
+	std::vector<SDL_Texture*> m_texturesToDestroy;
+};
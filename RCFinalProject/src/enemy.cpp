@@ -35,6 +35,14 @@ void CEnemy::Init(CEnemyFormation* enemyFormation, CTexture* spriteSheetTexture,
 	m_initialPosY = initialPosY;
 	m_enemyFormation = enemyFormation;
 
+	// enemies are recycled, reset anything a previous life may have changed
+	m_distanceToPlayer = 0.0f;
+	m_directionX = 1;
+	m_directionY = 0;
+	m_canAttack = false;
+	m_isAttackRequested = false;
+	SetIsAlive(true);
+
 	// initialize animation
 	m_animationMgr.Setup(m_animTable, SPRITE_WIDTH, SPRITE_HEIGHT, spriteSheetTexture);
 
@@ -45,14 +53,12 @@ void CEnemy::Init(CEnemyFormation* enemyFormation, CTexture* spriteSheetTexture,
 	SetPosition(initialPosX, initialPosY);
 
 	// initialize the attack timer
-	m_lastAttackTicks = Utils::GetTicks();
+	m_lastAttackTicks = GetGameTicks();
 }
    
 void CEnemy::Update(Uint32 elapsedTime)
 {
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-
-	if (ingameState->GetState() == CIngameState::EState::PLAYING)
+	if (m_ingameState->GetState() == CIngameState::EState::PLAYING)
 	{
 		RequestAnimation(EAnimID::IDLE);
 
@@ -64,14 +70,12 @@ void CEnemy::Update(Uint32 elapsedTime)
 		m_x += moveX;
 		m_y += moveY;
 
-		if (m_canAttack && Utils::GetTicks() - m_lastAttackTicks > m_fireCooldownMs)
+		if (m_canAttack && GetGameTicks() - m_lastAttackTicks > m_fireCooldownMs)
 		{
-			ShootProjectile();
-			GenerateFireCooldownTime();
-			m_lastAttackTicks = Utils::GetTicks();
+			m_isAttackRequested = true;
 		}
 	}
-	else if (ingameState->GetState() == CIngameState::EState::PLAYER_DEATH_COOLDOWN)
+	else if (m_ingameState->GetState() == CIngameState::EState::PLAYER_DEATH_COOLDOWN)
 	{
 		// make sure the right animation is being played
 		RequestAnimation(EAnimID::PROPULSION);
@@ -87,12 +91,46 @@ void CEnemy::Update(Uint32 elapsedTime)
 
 		// if ingame state is on any other state, update the m_lastAttackTicks so that when the state is back to PLAYING,
 		// all enemies shoot at once
-		m_lastAttackTicks = Utils::GetTicks();
+		m_lastAttackTicks = GetGameTicks();
 	}
 
 	m_animationMgr.Update(elapsedTime);
 }
 
+void CEnemy::SaveState(SState* state) const
+{
+	SaveEntityState(&state->m_entity);
+	state->m_initialPosX = m_initialPosX;
+	state->m_initialPosY = m_initialPosY;
+	state->m_distanceToPlayer = m_distanceToPlayer;
+	state->m_lastAttackTicks = m_lastAttackTicks;
+	state->m_fireCooldownMs = m_fireCooldownMs;
+	state->m_spot = m_spot;
+	state->m_directionX = m_directionX;
+	state->m_directionY = m_directionY;
+	state->m_canAttack = m_canAttack;
+	state->m_isAttackRequested = m_isAttackRequested;
+}
+
+void CEnemy::RestoreState(CEnemyFormation* enemyFormation, CTexture* spriteSheetTexture, const SState& state)
+{
+	CEntity::Init(spriteSheetTexture);
+	m_enemyFormation = enemyFormation;
+	m_animationMgr.Setup(m_animTable, SPRITE_WIDTH, SPRITE_HEIGHT, spriteSheetTexture);
+
+	RestoreEntityState(state.m_entity);
+	m_initialPosX = state.m_initialPosX;
+	m_initialPosY = state.m_initialPosY;
+	m_distanceToPlayer = state.m_distanceToPlayer;
+	m_lastAttackTicks = state.m_lastAttackTicks;
+	m_fireCooldownMs = state.m_fireCooldownMs;
+	m_spot = state.m_spot;
+	m_directionX = state.m_directionX;
+	m_directionY = state.m_directionY;
+	m_canAttack = state.m_canAttack;
+	m_isAttackRequested = state.m_isAttackRequested;
+}
+
 void CEnemy::RequestAnimation(EAnimID animationIndex)
 {
 	if (m_animationMgr.GetRequestedAnimation() != static_cast<int>(animationIndex) && m_animationMgr.GetCurrentAnimation() != static_cast<int>(animationIndex))
@@ -111,17 +149,25 @@ void CEnemy::ShootProjectile()
 	float projectilePosX = m_x + (m_spriteWidth / 2.0f) - (CProjectile::ENEMY_PROJECTILE_SPRITE_WIDTH / 2.0f);
 	float projectilePosY = m_y + CProjectile::ENEMY_PROJECTILE_SPRITE_HEIGHT;
 
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-	CProjectile::EProjectileType projectileType = ingameState->IsBossMakingEnemiesShootDiagonally() ? CProjectile::EProjectileType::DIAGONAL : CProjectile::EProjectileType::REGULAR;
-	ingameState->SpawnProjectile(CProjectile::EProjectileOwner::ENEMY, projectileType, projectilePosX, projectilePosY);
+	CProjectile::EProjectileType projectileType = m_ingameState->IsBossMakingEnemiesShootDiagonally() ? CProjectile::EProjectileType::DIAGONAL : CProjectile::EProjectileType::REGULAR;
+	CGameCommandBuffer* commandBuffer = m_ingameState->GetCommandBuffer();
+	commandBuffer->SpawnProjectile(CProjectile::EProjectileOwner::ENEMY, projectileType, projectilePosX, projectilePosY);
 #if SOUND_ENABLED
-	m_enemyFormation->GetAttackSound()->Play();
+	commandBuffer->PlaySound(m_enemyFormation->GetAttackSound());
 #endif
 
 }
 
+void CEnemy::Attack()
+{
+	ShootProjectile();
+	GenerateFireCooldownTime();
+	m_lastAttackTicks = GetGameTicks();
+	m_isAttackRequested = false;
+}
+
 void CEnemy::GenerateFireCooldownTime()
 {
-	m_fireCooldownMs = Utils::GetRandomUint32(ENEMY_FIRE_COOLDOWN_LBOUND_MS, ENEMY_FIRE_COOLDOWN_UBOUND_MS);
+	m_fireCooldownMs = m_ingameState->GetRandom()->GetUint32(ENEMY_FIRE_COOLDOWN_LBOUND_MS, ENEMY_FIRE_COOLDOWN_UBOUND_MS);
 	LOG_SCR_F("generated a random number of %ld\n", m_fireCooldownMs);
 }
\ No newline at end of file
@@ -5,7 +5,6 @@
 *************************************************************************************/
 
 #include "entity.h"
-#include "enemyformation.h"
 #include "utils.h"
 
 class CEnemyFormation;
@@ -21,6 +20,21 @@ public:
 		PROPULSION = 2,
 	};
 
+	struct SState
+	{
+		SEntityState m_entity;
+		float m_initialPosX;
+		float m_initialPosY;
+		float m_distanceToPlayer;
+		Uint32 m_lastAttackTicks;
+		Uint32 m_fireCooldownMs;
+		Utils::SGridLocation8 m_spot;
+		int8_t m_directionX;
+		int8_t m_directionY;
+		bool m_canAttack;
+		bool m_isAttackRequested;
+	};
+
 	CEnemy();
 
 	void Init(CEnemyFormation* enemyFormation, CTexture* spriteSheetTexture, Uint8 row, Uint8 column, float initialPosX, float initialPosY);
@@ -30,11 +44,20 @@ public:
 
 	void ShootProjectile();
 
+	// restoring works like Init(), the enemy may come straight from the pool
+	void SaveState(SState* state) const;
+	void RestoreState(CEnemyFormation* enemyFormation, CTexture* spriteSheetTexture, const SState& state);
+
+	// Update() only flags the attack, it runs on a job thread. Attack() then shoots from the main thread
+	bool IsAttackRequested() const { return m_isAttackRequested; }
+	void Attack();
+
 	const Utils::SGridLocation8& GetSpot() const { return m_spot; }
 	float GetInitialPosX() { return m_initialPosX; }
 	float GetInitialPosY() { return m_initialPosY; }
 	bool IsAtInitialPosY() { return m_y == m_initialPosY; }
 	void SetCanAttack(bool canAttack) { m_canAttack = canAttack; }
+	bool CanAttack() const { return m_canAttack; }
 	void SetDistanceToPlayer(float distanceToPlayer) { m_distanceToPlayer = distanceToPlayer; }
 
 	static const int SPRITE_WIDTH = 70;
@@ -60,6 +83,7 @@ private:
 	int8_t m_directionY = 0;
 	Utils::SGridLocation8 m_spot;
 	bool m_canAttack = false;
+	bool m_isAttackRequested = false;
 	Uint32 m_lastAttackTicks = 0;
 	Uint32 m_fireCooldownMs = 0;
 };
\ No newline at end of file
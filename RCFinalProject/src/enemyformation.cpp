@@ -8,9 +8,16 @@
 #include <cmath>
 #include <stdio.h>
 #include "ingamestate.h"
+#include "jobsystem.h"
 #include "playership.h"
 #include "utils.h"
 
+void CEnemyFormation::SetIngameState(CIngameState* ingameState)
+{
+	m_ingameState = ingameState;
+	m_services = ingameState->GetServices();
+}
+
 void CEnemyFormation::InitTexture(CTexture* spriteSheetTexture)
 {
 	m_spriteSheetTexture = spriteSheetTexture;
@@ -33,6 +40,43 @@ void CEnemyFormation::Destroy()
 		delete enemyPtr;
 		enemyPtr = nextElement;
 	}
+
+	for (int i = 0; i < m_numPooledEnemies; i++)
+	{
+		delete m_enemyPool[i];
+		m_enemyPool[i] = nullptr;
+	}
+	m_numPooledEnemies = 0;
+}
+
+void CEnemyFormation::AllocatePool()
+{
+	while (m_numPooledEnemies < ENEMY_POOL_SIZE)
+	{
+		m_enemyPool[m_numPooledEnemies++] = new CEnemy;
+	}
+}
+
+CEnemy* CEnemyFormation::AcquireEnemy()
+{
+	if (m_numPooledEnemies > 0)
+	{
+		return m_enemyPool[--m_numPooledEnemies];
+	}
+
+	return new CEnemy;
+}
+
+void CEnemyFormation::ReleaseEnemy(CEnemy* enemy)
+{
+	if (m_numPooledEnemies < ENEMY_POOL_SIZE)
+	{
+		m_enemyPool[m_numPooledEnemies++] = enemy;
+	}
+	else
+	{
+		delete enemy;
+	}
 }
 
 void CEnemyFormation::Spawn()
@@ -53,10 +97,11 @@ void CEnemyFormation::Spawn()
 		{
 			posX = initialPosX + CEnemy::SPRITE_WIDTH * j;
 
-			// instantiate a new enemy object
-			CEnemy* newEnemy = new CEnemy;
+			// take an enemy object from the pool
+			CEnemy* newEnemy = AcquireEnemy();
 
 			// initialize the enemy
+			newEnemy->SetIngameState(m_ingameState);
 			newEnemy->Init(this, m_spriteSheetTexture, i, j, posX, posY);
 
 			// add enemy entity to linked list
@@ -88,73 +133,149 @@ void CEnemyFormation::Spawn()
 	m_state = EState::NORMAL;
 }
 
-void CEnemyFormation::Update(Uint32 elapsedTime)
+// returns every enemy to the pool, e.g. to restart the game
+void CEnemyFormation::Despawn()
+{
+	CEnemy* enemyPtr = m_entitiesList.GetHeadElement();
+	while (enemyPtr != nullptr)
+	{
+		CEnemy* nextElement = m_entitiesList.RemoveElement(enemyPtr);
+		ReleaseEnemy(enemyPtr);
+		enemyPtr = nextElement;
+	}
+
+	for (int i = 0; i < ENEMY_NUM_ENEMIES_PER_LINE; i++)
+	{
+		m_frontEnemiesTable[i] = nullptr;
+	}
+
+	m_totalEnemies = 0;
+	m_enemyCount = 0;
+}
+
+void CEnemyFormation::SaveState(SState* state)
 {
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
+	state->m_formationYMovePos = m_formationYMovePos;
+	state->m_speedMultiplier = m_speedMultiplier;
+	state->m_state = m_state;
+	state->m_totalEnemies = m_totalEnemies;
+	state->m_enemyCount = m_enemyCount;
+	state->m_previousDirectionX = m_previousDirectionX;
+	state->m_directionX = m_directionX;
+	state->m_directionY = m_directionY;
+
+	for (int i = 0; i < ENEMY_NUM_ENEMIES_PER_LINE; i++)
+	{
+		state->m_frontEnemies[i] = -1;
+	}
 
-	bool isInPlayingState = ingameState->GetState() == CIngameState::EState::PLAYING;
+	// the list only ever holds one round of enemies, which fits in the pool
+	int numEnemies = 0;
+	CEnemy* enemyPtr = m_entitiesList.GetHeadElement();
+	while (enemyPtr != nullptr)
+	{
+		assert(numEnemies < ENEMY_POOL_SIZE);
+		enemyPtr->SaveState(&state->m_enemies[numEnemies]);
+
+		for (int i = 0; i < ENEMY_NUM_ENEMIES_PER_LINE; i++)
+		{
+			if (m_frontEnemiesTable[i] == enemyPtr)
+			{
+				state->m_frontEnemies[i] = static_cast<Sint8>(numEnemies);
+			}
+		}
+
+		numEnemies++;
+		enemyPtr = m_entitiesList.GetNextElement(enemyPtr);
+	}
+	state->m_numEnemies = numEnemies;
+}
+
+void CEnemyFormation::RestoreState(const SState& state)
+{
+	Despawn();
+
+	CEnemy* restoredEnemies[ENEMY_POOL_SIZE];
+	for (int i = 0; i < state.m_numEnemies; i++)
+	{
+		CEnemy* enemy = AcquireEnemy();
+		enemy->SetIngameState(m_ingameState);
+		enemy->RestoreState(this, m_spriteSheetTexture, state.m_enemies[i]);
+		m_entitiesList.AddElement(enemy);
+		restoredEnemies[i] = enemy;
+	}
+
+	for (int i = 0; i < ENEMY_NUM_ENEMIES_PER_LINE; i++)
+	{
+		m_frontEnemiesTable[i] = state.m_frontEnemies[i] >= 0 ? restoredEnemies[state.m_frontEnemies[i]] : nullptr;
+	}
+
+	m_formationYMovePos = state.m_formationYMovePos;
+	m_speedMultiplier = state.m_speedMultiplier;
+	m_state = state.m_state;
+	m_totalEnemies = state.m_totalEnemies;
+	m_enemyCount = state.m_enemyCount;
+	m_previousDirectionX = state.m_previousDirectionX;
+	m_directionX = state.m_directionX;
+	m_directionY = state.m_directionY;
+
+	// rebuilt by the next update
+	m_enemyArray.clear();
+}
+
+void CEnemyFormation::UpdateEnemies(Uint32 elapsedTime)
+{
+	bool isInPlayingState = m_ingameState->GetState() == CIngameState::EState::PLAYING;
 	if (isInPlayingState)
 	{
 		// build front enemies table
 		UpdateFrontEnemiesTable();
 	}	
 
+	m_enemyArray.clear();
 	CEnemy* enemyPtr = m_entitiesList.GetHeadElement();
 	while (enemyPtr != nullptr)
 	{
 		// determine which enemies can attack
 		enemyPtr->SetCanAttack(enemyPtr == m_frontEnemiesTable[enemyPtr->GetSpot().m_column]);
 
-		// update enemies
-		enemyPtr->Update(elapsedTime);
+		m_enemyArray.push_back(enemyPtr);
+		enemyPtr = m_entitiesList.GetNextElement(enemyPtr);
+	}
 
-#if COLLISIONS_ENABLED
-		// check if enemy has collided against the player's ship
-		CPlayerShip* playerShip = ingameState->GetPlayerShip();
-		if (playerShip->IsAlive() && playerShip->CollidesWith(enemyPtr))
+	// every enemy only moves and animates itself, they can be updated in parallel
+	m_services->m_jobSystem->ParallelFor(static_cast<int>(m_enemyArray.size()), UPDATE_BATCH_SIZE, [this, elapsedTime](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
 		{
-			// collision has occurred, is the player using the shield? if yes, destroy the enemy
-			if (playerShip->GetState() == CPlayerShip::EState::USING_SHIELD)
-			{
-				// get the enemy position before destroying it
-				float explosionPosX = enemyPtr->GetPosX() + static_cast<float>(CEnemy::SPRITE_WIDTH / 2.0) - static_cast<float>(CExplosion::SPRITE_WIDTH / 2.0);
-				float explosionPosY = enemyPtr->GetPosY() + static_cast<float>(CEnemy::SPRITE_HEIGHT / 2.0) - static_cast<float>(CExplosion::SPRITE_HEIGHT / 2.0);
-
-				CEnemy* nextElement = m_entitiesList.RemoveElement(enemyPtr);
-				LOG_SCR_F("Deleting enemy %d\n", (int)(size_t)enemyPtr);
-				delete enemyPtr;
-				enemyPtr = nextElement;
-				
-				// call this function to handle what happens when an enemy dies
-				OnEnemyDeath();
-
-				// spawn explosion
-				ingameState->SpawnExplosion(CEntity::EEntityType::ENEMY, explosionPosX, explosionPosY);
-			}
-			else
-			{
-				// get the player position before destroying it
-				float explosionPosX = playerShip->GetPosX() + static_cast<float>(CPlayerShip::SPRITE_WIDTH / 2.0) - static_cast<float>(CExplosion::SPRITE_WIDTH / 2.0);
-				float explosionPosY = playerShip->GetPosY() + static_cast<float>(CPlayerShip::SPRITE_HEIGHT / 2.0) - static_cast<float>(CExplosion::SPRITE_HEIGHT / 2.0);
-
-				// spawn explosion
-				ingameState->SpawnExplosion(CEntity::EEntityType::PLAYERSHIP, explosionPosX, explosionPosY);
-
-				// notify the playership object that it has died
-				playerShip->OnCollision();
-
-				// notify ingamestate that player died
-				ingameState->OnPlayerDeath();
-			}
+			m_enemyArray[i]->Update(elapsedTime);
 		}
-		else
+	});
+
+	// shooting spawns projectiles, plays a sound and rolls the next cooldown, that happens in formation order
+	for (CEnemy* enemy : m_enemyArray)
+	{
+		if (enemy->IsAttackRequested())
 		{
-			enemyPtr = m_entitiesList.GetNextElement(enemyPtr);
+			enemy->Attack();
 		}
-#endif
 	}
-		
-	if (ingameState->GetState() == CIngameState::EState::PLAYER_DEATH_COOLDOWN) // if formation is returning to the initial Y position, verify that all enemies have reached their initial positions
+}
+
+void CEnemyFormation::RemoveEnemy(CEnemy* enemy)
+{
+	enemy->SetIsAlive(false);
+	m_entitiesList.RemoveElement(enemy);
+	LOG_SCR_F("Deleting enemy %d\n", (int)(size_t)enemy);
+	ReleaseEnemy(enemy);
+
+	// call this function to handle what happens when an enemy dies
+	OnEnemyDeath();
+}
+
+void CEnemyFormation::UpdateFormation(Uint32 elapsedTime)
+{
+	if (m_ingameState->GetState() == CIngameState::EState::PLAYER_DEATH_COOLDOWN) // if formation is returning to the initial Y position, verify that all enemies have reached their initial positions
 	{
 		bool isFormationAtInitialYPos = true;
 		CEnemy* enemyPtr = m_entitiesList.GetHeadElement();
@@ -172,10 +293,7 @@ void CEnemyFormation::Update(Uint32 elapsedTime)
 		if (isFormationAtInitialYPos)
 		{
 			m_state = EState::NORMAL;
-
-			CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-			assert(ingameState != nullptr);
-			ingameState->OnEnemyFormationPositionRestarted();
+			m_ingameState->OnEnemyFormationPositionRestarted();
 		}
 	}
 	else
@@ -192,7 +310,7 @@ void CEnemyFormation::Update(Uint32 elapsedTime)
 			if (m_directionX != 0) // moving horizontally
 			{
 				if ((m_directionX == -1 && leftmostEnemy->GetPosX() <= ENEMY_MOVE_LIMIT) || 
-					(m_directionX == 1 && rightmostEnemy->GetPosX() + CEnemy::SPRITE_WIDTH >= CApp::GetInstance()->GetScreenWidth() - ENEMY_MOVE_LIMIT))
+					(m_directionX == 1 && rightmostEnemy->GetPosX() + CEnemy::SPRITE_WIDTH >= m_services->m_screenWidth - ENEMY_MOVE_LIMIT))
 				{
 					m_previousDirectionX = m_directionX;
 					// if any enemy has reached an Y-Pos (limit), just move the formation Left to Right and don't let them go down further
@@ -276,8 +394,7 @@ void CEnemyFormation::SetSpeedMultiplier()
 	m_speedMultiplier = altitude == maxAltitude ? 1.0f : ENEMY_FORMATION_SPEED_INCREASE_MULTIPLIER * abs(maxAltitude - altitude);
 
 	// scale the speed multiplier by the difficulty
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-	float difficultyMultiplier = ingameState->GetCurrentDifficultyMultiplier();
+	float difficultyMultiplier = m_ingameState->GetCurrentDifficultyMultiplier();
 	m_speedMultiplier *= difficultyMultiplier;
 
 	LOG_SCR_F("Speed Multiplier = %2.2f, enemyCount = %d, difficulty multiplier = %2.2f\n", m_speedMultiplier, m_enemyCount, difficultyMultiplier);
@@ -285,8 +402,7 @@ void CEnemyFormation::SetSpeedMultiplier()
 
 void CEnemyFormation::UpdateFrontEnemiesTable()
 {
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-	assert(ingameState != nullptr);
+	assert(m_ingameState != nullptr);
 
 	struct SShortestEnemyDistance
 	{
@@ -302,7 +418,7 @@ void CEnemyFormation::UpdateFrontEnemiesTable()
 		const Utils::SGridLocation8& enemySpot = enemyPtr->GetSpot();
 
 		// calculate distance to ship on the y-axis
-		float distance = ingameState->GetPlayerShip()->GetCenterPointY() - enemyPtr->GetCenterPointY();
+		float distance = m_ingameState->GetPlayerShip()->GetCenterPointY() - enemyPtr->GetCenterPointY();
 
 		if (shortestEnemyDistancePerColumn[enemySpot.m_column].m_distance == -1.0f || distance < shortestEnemyDistancePerColumn[enemySpot.m_column].m_distance)
 		{
@@ -328,8 +444,7 @@ void CEnemyFormation::OnEnemyDeath()
 	// check if all enemies are dead
 	if (m_enemyCount == 0)
 	{
-		CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-		ingameState->OnAllEnemiesDead();
+		m_ingameState->OnAllEnemiesDead();
 	}
 
 	// update the multiplier if needed
@@ -8,9 +8,12 @@
 #include "doublelinkedlist.h"
 #include "enemy.h"
 #include "preproc.h"
+#include "services.h"
 #include "sound.h"
+#include <vector>
 
 class CEnemy;
+class CIngameState;
 
 class CEnemyFormation
 {
@@ -22,19 +25,38 @@ public:
 		NORMAL,
 	};
 
+	// defined below
+	struct SState;
+
+	void SetIngameState(CIngameState* ingameState);
 	void InitTexture(CTexture* spriteSheetTexture);
 #if SOUND_ENABLED
 	void InitSound(CSound* enemyAttackSound);
 #endif
 	void Destroy();
 
+	// enemies are recycled between rounds, the pool can be filled ahead of time (e.g. while preloading)
+	void AllocatePool();
+	CEnemy* AcquireEnemy();
+	void ReleaseEnemy(CEnemy* enemy);
+
 	void Spawn();
+	void Despawn();
 
-	void Update(Uint32 elapsedTime);
+	// the enemies are updated first (spread over the job threads), the formation itself once their collisions were
+	// resolved
+	void UpdateEnemies(Uint32 elapsedTime);
+	void UpdateFormation(Uint32 elapsedTime);
 	void Draw();
 
+	// takes a destroyed enemy out of the formation
+	void RemoveEnemy(CEnemy* enemy);
+
 	CDoubleLinkedList<CEnemy*>& GetEntities() { return m_entitiesList; }
 
+	// the enemies as of the last UpdateEnemies(), for indexed access from the job threads
+	const std::vector<CEnemy*>& GetEnemyArray() const { return m_enemyArray; }
+
 	int8_t GetDirectionX() const { return m_directionX; }
 	int8_t GetDirectionY() const { return m_directionY; }
 	float GetSpeedMultiplier() const { return m_speedMultiplier; }
@@ -45,6 +67,11 @@ public:
 
 	EState GetState() const { return m_state; }
 
+	// restoring puts every enemy back into the pool and takes what the saved formation needs out of it again, the
+	// pointers to the enemies do not survive a restore
+	void SaveState(SState* state);
+	void RestoreState(const SState& state);
+
 #if SOUND_ENABLED
 	CSound* GetAttackSound() { return m_attackSound; }
 #endif
@@ -57,17 +84,26 @@ private:
 	const float ENEMY_FORMATION_SPEED_INCREASE_THRESHOLD = 0.1f;
 	static const int ENEMY_NUM_ENEMIES_PER_LINE = 11;
 	const float ENEMY_INITIAL_POS_Y = 160.0f;
-	const int ENEMY_NUM_LINES = 5;
+	static const int ENEMY_NUM_LINES = 5;
+	static const int ENEMY_POOL_SIZE = ENEMY_NUM_ENEMIES_PER_LINE * ENEMY_NUM_LINES;
 	const int FORMATION_MOVE_LIMIT_Y = 600;
 	const float FORMATION_VERTICAL_SPEED = -40.0f;
+	const int UPDATE_BATCH_SIZE = 16; // enemies per job
 
 	void GetEnemiesInEdges(CEnemy** topmostEnemy, CEnemy** bottommostEnemy, CEnemy** leftmostEnemy, CEnemy** rightmostEnemy);
 	void SetSpeedMultiplier();
 	void UpdateFrontEnemiesTable();
 	
+	CIngameState* m_ingameState = nullptr;
+	const SServices* m_services = nullptr;
 	CTexture* m_spriteSheetTexture = nullptr;
 
 	CDoubleLinkedList<CEnemy*> m_entitiesList;
+	std::vector<CEnemy*> m_enemyArray;
+
+	// enemies not in use, ready to be spawned again
+	CEnemy* m_enemyPool[ENEMY_POOL_SIZE] = {};
+	int m_numPooledEnemies = 0;
 
 	// table to store which enemies are in the front line for EACH column - index is column, value is row
 	CEnemy* m_frontEnemiesTable[ENEMY_NUM_ENEMIES_PER_LINE] = {};
@@ -82,7 +118,23 @@ private:
 	int8_t m_directionY = 0;
 
 #if SOUND_ENABLED
-	CSound* m_attackSound;
+	CSound* m_attackSound = nullptr;
 #endif
 };
 
+// the enemies are stored in list order, the front enemies as indices into them
+struct CEnemyFormation::SState
+{
+	float m_formationYMovePos;
+	float m_speedMultiplier;
+	EState m_state;
+	Sint32 m_totalEnemies;
+	Sint32 m_enemyCount;
+	int8_t m_previousDirectionX;
+	int8_t m_directionX;
+	int8_t m_directionY;
+	Sint8 m_frontEnemies[ENEMY_NUM_ENEMIES_PER_LINE]; // -1 if there is none
+	Sint32 m_numEnemies;
+	CEnemy::SState m_enemies[ENEMY_POOL_SIZE];
+};
+
@@ -5,8 +5,21 @@
 #include "entity.h"
 
 #include <assert.h>
+#include "clock.h"
+#include "ingamestate.h"
 #include "utils.h"
 
+void CEntity::SetIngameState(CIngameState* ingameState)
+{
+	m_ingameState = ingameState;
+	m_services = ingameState->GetServices();
+}
+
+Uint32 CEntity::GetGameTicks()
+{
+	return m_services->m_clock->GetTicks();
+}
+
 void CEntity::Init(CTexture* spriteSheetTexture)
 {
 	SetSpriteSheetTexture(spriteSheetTexture);
@@ -65,6 +78,30 @@ SDL_Rect CEntity::GetColliderRect()
 	return rect;
 }
 
+void CEntity::SaveEntityState(SEntityState* state) const
+{
+	state->m_x = m_x;
+	state->m_y = m_y;
+	state->m_moveSpeedX = m_moveSpeedX;
+	state->m_moveSpeedY = m_moveSpeedY;
+	state->m_spriteWidth = m_spriteWidth;
+	state->m_spriteHeight = m_spriteHeight;
+	state->m_isAlive = m_isAlive;
+	m_animationMgr.SaveState(&state->m_animation);
+}
+
+void CEntity::RestoreEntityState(const SEntityState& state)
+{
+	m_x = state.m_x;
+	m_y = state.m_y;
+	m_moveSpeedX = state.m_moveSpeedX;
+	m_moveSpeedY = state.m_moveSpeedY;
+	m_spriteWidth = state.m_spriteWidth;
+	m_spriteHeight = state.m_spriteHeight;
+	m_isAlive = state.m_isAlive;
+	m_animationMgr.RestoreState(state.m_animation);
+}
+
 bool CEntity::CollidesWith(CEntity* entityPtr)
 {
 	assert(entityPtr != nullptr);
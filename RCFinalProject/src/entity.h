@@ -10,8 +10,11 @@
 #include <SDL.h>
 #endif
 #include "animationmanager.h"
+#include "services.h"
 #include "texture.h"
 
+class CIngameState;
+
 class CEntity
 {
 public:	
@@ -25,10 +28,28 @@ public:
 		EXPLOSION
 	};
 
+	// what changes while the game runs, shared by every kind of entity. each kind adds its own on top, see
+	// CIngameState::SaveSnapshot(). plain values only, the pointers are set up again when restoring
+	struct SEntityState
+	{
+		float m_x;
+		float m_y;
+		float m_moveSpeedX;
+		float m_moveSpeedY;
+		Sint32 m_spriteWidth;
+		Sint32 m_spriteHeight;
+		bool m_isAlive;
+		CAnimationManager::SState m_animation;
+	};
+
 	EEntityType GetType() { return m_type; }
 
 	virtual void Init(CTexture* spriteSheetTexture);
 
+	// the game the entity belongs to, there can be more than one running at the same time (see CEnvRunner). the
+	// entity uses the game's services
+	void SetIngameState(CIngameState* ingameState);
+
 	virtual void SetSpriteSheetTexture(CTexture* spriteSheetTexture);
 
 	virtual void SetPosition(float x, float y);
@@ -67,11 +88,19 @@ public:
 
 	bool CollidesWith(CEntity* entity);
 
+	void SaveEntityState(SEntityState* state) const;
+	void RestoreEntityState(const SEntityState& state);
+
 	virtual bool IsAlive() { return m_isAlive; }
 	void SetIsAlive(bool isAlive) { m_isAlive = isAlive; }
 
 protected:
+	// every timer of the entity is measured with the clock service, the game's own clock (see CIngameState)
+	Uint32 GetGameTicks();
+
 	EEntityType m_type = EEntityType::UNASSIGNED;
+	CIngameState* m_ingameState = nullptr;
+	const SServices* m_services = nullptr;
 
 	float m_x = 0;
 	float m_y = 0;
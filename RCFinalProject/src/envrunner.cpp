@@ -0,0 +1,104 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "envrunner.h"
+
+#include <assert.h>
+#include "ingamestate.h"
+#include "jobsystem.h"
+#include "utils.h"
+
+void CEnvRunner::Init(const SServices* services, int numEnvs, Uint64 seed)
+{
+	assert(m_envs.empty());
+	m_services = services;
+
+	for (int i = 0; i < numEnvs; i++)
+	{
+		CIngameState* env = new CIngameState(m_services);
+		env->InitHeadless(seed + i);
+		m_envs.push_back(env);
+	}
+
+	LOG_SCR_F("Env runner initialized: %d environments\n", numEnvs);
+}
+
+void CEnvRunner::Destroy()
+{
+	for (CIngameState* env : m_envs)
+	{
+		env->CleanUp();
+		delete env;
+	}
+	m_envs.clear();
+}
+
+void CEnvRunner::Reset(SObservation* observations)
+{
+	for (int i = 0; i < GetNumEnvs(); i++)
+	{
+		m_envs[i]->Enter();
+		Observe(m_envs[i], &observations[i]);
+	}
+}
+
+void CEnvRunner::Step(const SAction* actions, Uint32 elapsedTime, SObservation* observations, SStepResult* results)
+{
+	// a batch of environments per job, they do not share anything. each of them spreads its own update over the job
+	// threads as well, those jobs are stolen by whichever thread runs out of environments first
+	m_services->m_jobSystem->ParallelFor(GetNumEnvs(), GetBatchSize(), [this, actions, elapsedTime, observations, results](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			CIngameState* env = m_envs[i];
+			int previousScore = env->GetScore();
+			int previousLives = env->GetLives();
+
+			env->SetInput(actions[i]);
+			env->Update(elapsedTime);
+
+			SStepResult& result = results[i];
+			result.m_scoreDelta = env->GetScore() - previousScore;
+			result.m_numDeaths = previousLives - env->GetLives();
+			result.m_isDone = env->IsGameOver();
+			if (result.m_isDone)
+			{
+				env->Enter();
+			}
+
+			Observe(env, &observations[i]);
+		}
+	});
+}
+
+void CEnvRunner::ObservePlayfields(SPlayfieldObservation* observations, bool includeOccupancy)
+{
+	m_services->m_jobSystem->ParallelFor(GetNumEnvs(), GetBatchSize(), [this, observations, includeOccupancy](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			m_envs[i]->WriteObservation(&observations[i], includeOccupancy);
+		}
+	});
+}
+
+int CEnvRunner::GetBatchSize()
+{
+	int numBatches = m_services->m_jobSystem->GetNumThreads() * ENV_BATCHES_PER_THREAD;
+	return std::max(1, (GetNumEnvs() + numBatches - 1) / numBatches);
+}
+
+void CEnvRunner::Observe(CIngameState* env, SObservation* observation)
+{
+	CPlayerShip* playerShip = env->GetPlayerShip();
+	observation->m_playerPosX = playerShip->GetPosX();
+	observation->m_playerPosY = playerShip->GetPosY();
+	observation->m_score = env->GetScore();
+	observation->m_level = env->GetLevel();
+	observation->m_lives = env->GetLives();
+	observation->m_enemyCount = env->GetEnemyFormation()->GetEnemyCount();
+	observation->m_isPlayerAlive = playerShip->IsAlive();
+	observation->m_isShieldUp = playerShip->IsShieldUp();
+	observation->m_isBossAlive = env->GetBoss()->IsAlive();
+}
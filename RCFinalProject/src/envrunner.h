@@ -0,0 +1,77 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include "ingamestate.h"
+#include "playership.h"
+#include "playfieldobservation.h"
+#include "services.h"
+#include <vector>
+
+// runs many headless games side by side in lockstep, e.g. to let an AI play itself. every environment is its own
+// CIngameState with its own entities, command buffer and random numbers, they are all stepped at once on the job
+// threads with one action each and report back what happened in one batch.
+// an environment that reaches game over is restarted right away, its observation is the first one of the new game
+class CEnvRunner
+{
+public:
+	typedef CPlayerShip::SInputData SAction;
+
+	struct SObservation
+	{
+		float m_playerPosX = 0.0f;
+		float m_playerPosY = 0.0f;
+		int m_score = 0;
+		int m_level = 0;
+		int m_lives = 0;
+		int m_enemyCount = 0;
+		bool m_isPlayerAlive = false;
+		bool m_isShieldUp = false;
+		bool m_isBossAlive = false;
+	};
+
+	struct SStepResult
+	{
+		int m_scoreDelta = 0; // the reward
+		int m_numDeaths = 0;
+		bool m_isDone = false; // the game was over, and has been restarted
+	};
+
+	// environment i is seeded with seed + i, the same seed and actions play out the same way. the environments only
+	// use the job system of the services
+	void Init(const SServices* services, int numEnvs, Uint64 seed);
+	void Destroy();
+
+	// starts a new game in every environment
+	void Reset(SObservation* observations);
+
+	// actions, observations and results hold one element per environment
+	void Step(const SAction* actions, Uint32 elapsedTime, SObservation* observations, SStepResult* results);
+
+	// the full playfield of every environment as of the last step, one element per environment
+	void ObservePlayfields(SPlayfieldObservation* observations, bool includeOccupancy);
+
+	// e.g. for a tree search: save an environment, try some actions, go back to where it was
+	bool SaveSnapshot(int envIndex, CIngameState::SSnapshot* snapshot) { return m_envs[envIndex]->SaveSnapshot(snapshot); }
+	void RestoreSnapshot(int envIndex, const CIngameState::SSnapshot& snapshot) { m_envs[envIndex]->RestoreSnapshot(snapshot); }
+
+	int GetNumEnvs() { return static_cast<int>(m_envs.size()); }
+
+private:
+	// a few batches of environments per job thread: enough to keep the threads busy, few enough that the jobs
+	// each environment spreads its own update over do not pile up on top of one job per environment
+	const int ENV_BATCHES_PER_THREAD = 4;
+
+	int GetBatchSize();
+	void Observe(CIngameState* env, SObservation* observation);
+
+	const SServices* m_services = nullptr;
+	std::vector<CIngameState*> m_envs;
+};
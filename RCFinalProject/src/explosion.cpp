@@ -27,8 +27,8 @@ void CExplosion::Init(CTexture* spriteSheetTexture, EAnimID animId, Uint32 explo
 	CEntity::Init(spriteSheetTexture);
 
 	// calculate initial position
-	m_initialPosX = static_cast<float>(CApp::GetInstance()->GetScreenWidth() + GetSpriteWidth()) / 2.0f;
-	m_initialPosY = static_cast<float>(CApp::GetInstance()->GetScreenHeight() - GetSpriteHeight()) / 2.0f;
+	m_initialPosX = static_cast<float>(m_services->m_screenWidth + GetSpriteWidth()) / 2.0f;
+	m_initialPosY = static_cast<float>(m_services->m_screenHeight - GetSpriteHeight()) / 2.0f;
 	SetPosition(m_initialPosX, m_initialPosY);
 
 	// initialize animation
@@ -37,7 +37,7 @@ void CExplosion::Init(CTexture* spriteSheetTexture, EAnimID animId, Uint32 explo
 		
 	m_explosionLifetimeMs = explosionLifetimeMs;
 
-	m_lastTicks = Utils::GetTicks();
+	m_lastTicks = GetGameTicks();
 }
 
 #if SOUND_ENABLED
@@ -50,7 +50,7 @@ void CExplosion::InitSound(CSound* sound)
 
 void CExplosion::Update(Uint32 elapsedTime)
 {
-	if (Utils::GetTicks() - m_lastTicks > m_explosionLifetimeMs)
+	if (GetGameTicks() - m_lastTicks > m_explosionLifetimeMs)
 	{
 		SetIsAlive(false);
 	}
@@ -58,6 +58,23 @@ void CExplosion::Update(Uint32 elapsedTime)
 	m_animationMgr.Update(elapsedTime);
 }
 
+void CExplosion::SaveState(SState* state) const
+{
+	SaveEntityState(&state->m_entity);
+	state->m_lastTicks = m_lastTicks;
+	state->m_explosionLifetimeMs = m_explosionLifetimeMs;
+}
+
+void CExplosion::RestoreState(CTexture* spriteSheetTexture, const SState& state)
+{
+	CEntity::Init(spriteSheetTexture);
+	m_animationMgr.Setup(m_animTable, SPRITE_WIDTH, SPRITE_HEIGHT, spriteSheetTexture);
+
+	RestoreEntityState(state.m_entity);
+	m_lastTicks = state.m_lastTicks;
+	m_explosionLifetimeMs = state.m_explosionLifetimeMs;
+}
+
 void CExplosion::Draw()
 {
 	m_animationMgr.Draw(static_cast<int>(m_x), static_cast<int>(m_y));
@@ -22,6 +22,13 @@ public:
 		PLAYER_EXPLOSION = 1,
 	};
 
+	struct SState
+	{
+		SEntityState m_entity;
+		Sint32 m_lastTicks;
+		Uint32 m_explosionLifetimeMs;
+	};
+
 	CExplosion();
 
 	void Init(CTexture* spriteSheetTexture, EAnimID animId, Uint32 explosionLifetimeMs);
@@ -34,6 +41,10 @@ public:
 
 	void SetIsAlive(bool isAlive) { m_isAlive = isAlive; }
 
+	// restoring works like Init(), except the sound is not played again
+	void SaveState(SState* state) const;
+	void RestoreState(CTexture* spriteSheetTexture, const SState& state);
+
 	static const int SPRITE_WIDTH = 90;
 	static const int SPRITE_HEIGHT = 86;
 
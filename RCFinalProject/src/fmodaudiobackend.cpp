@@ -0,0 +1,176 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED && SOUND_FMOD_ENABLED
+#include "fmodaudiobackend.h"
+
+#include "assetarchive.h"
+#include "utils.h"
+
+FMOD_RESULT F_CALLBACK channelGroupCallback(FMOD_CHANNELCONTROL* /*channelControl*/,
+	FMOD_CHANNELCONTROL_TYPE /*controlType*/, FMOD_CHANNELCONTROL_CALLBACK_TYPE /*callbackType*/,
+	void* /*commandData1*/, void* /*commandData2*/)
+{
+	// for future expansion
+	return FMOD_OK;
+}
+
+bool CFmodAudioBackend::Init(CAssetArchive* assetArchive)
+{
+	m_assetArchive = assetArchive;
+
+	LOG_SCR("Initializing FMOD");
+
+	FMOD_RESULT result;
+		
+	// Create the main system object
+	result = FMOD::System_Create(&m_fmodSystem);
+	if (result != FMOD_OK)
+	{
+		LOG_SCR_F("Failed to create FMOD system object: %s\n", FMOD_ErrorString(result));
+		return false;
+	}
+
+	// initialize FMOD
+	result = m_fmodSystem->init(SOUND_MAX_CHANNELS, FMOD_INIT_NORMAL, nullptr);
+	if (result != FMOD_OK)
+	{
+		LOG_SCR_F("Failed to initialize FMOD system object: %s\n", FMOD_ErrorString(result));
+		Destroy();
+		return false;
+	}
+	
+	// create a channel group
+	result = m_fmodSystem->createChannelGroup("sfx", &m_channelGroup);
+	if (result != FMOD_OK)
+	{
+		LOG_SCR_F("Failed to create FMOD sfx channel group: %s\n", FMOD_ErrorString(result));
+		Destroy();
+		return false;
+	}
+
+	// every sound is played straight into the group, so this covers all of them (optional post processing)
+	result = m_channelGroup->setCallback(&channelGroupCallback);
+	if (result != FMOD_OK)
+	{
+		LOG_SCR_F("Failed to set callback on FMOD sfx channel group: %s\n", FMOD_ErrorString(result));
+	}
+
+	return true;
+}
+
+void CFmodAudioBackend::Destroy()
+{
+	LOG_SCR("Cleaning up FMOD");
+
+	if (m_channelGroup != nullptr)
+	{
+		m_channelGroup->release();
+		m_channelGroup = nullptr;
+	}
+	if (m_fmodSystem != nullptr)
+	{
+		m_fmodSystem->release();
+		m_fmodSystem = nullptr;
+	}
+}
+
+// creates the sound from the asset archive if it is there, from the loose file otherwise
+CAudioBackend::SoundHandle CFmodAudioBackend::CreateSound(const std::string& path)
+{
+	FMOD::Sound* sound = nullptr;
+	FMOD_RESULT result;
+
+	const void* data = nullptr;
+	size_t size = 0;
+	if (m_assetArchive->FindAsset(path, &data, &size))
+	{
+		FMOD_CREATESOUNDEXINFO soundInfo = {};
+		soundInfo.cbsize = sizeof(FMOD_CREATESOUNDEXINFO);
+		soundInfo.length = static_cast<unsigned int>(size);
+
+		// the archive stays mapped until shutdown so PCM data can be used in place, anything that needs decoding
+		// (e.g. the music modules) is copied by FMOD
+		result = m_fmodSystem->createSound(static_cast<const char*>(data), FMOD_DEFAULT | FMOD_OPENMEMORY_POINT, &soundInfo, &sound);
+		if (result == FMOD_ERR_MEMORY_CANTPOINT)
+		{
+			result = m_fmodSystem->createSound(static_cast<const char*>(data), FMOD_DEFAULT | FMOD_OPENMEMORY, &soundInfo, &sound);
+		}
+	}
+	else
+	{
+		result = m_fmodSystem->createSound(path.c_str(), FMOD_DEFAULT, nullptr, &sound);
+	}
+
+	if (result != FMOD_OK)
+	{
+		LOG_SCR_F("Unable to create FMOD sound: %s (%s)\n", path.c_str(), FMOD_ErrorString(result));
+		return nullptr;
+	}
+
+	return sound;
+}
+
+void CFmodAudioBackend::ReleaseSound(SoundHandle sound)
+{
+	ToFmodSound(sound)->release();
+}
+
+// sounds are decompressed into memory when loaded with FMOD_DEFAULT
+size_t CFmodAudioBackend::GetSoundSizeInBytes(SoundHandle sound)
+{
+	unsigned int length = 0;
+	ToFmodSound(sound)->getLength(&length, FMOD_TIMEUNIT_PCMBYTES);
+	return length;
+}
+
+void CFmodAudioBackend::Update()
+{
+	m_fmodSystem->update();
+}
+
+CAudioBackend::VoiceHandle CFmodAudioBackend::PlaySound(SoundHandle sound, float volume, bool isLooping)
+{
+	// started paused straight in the sfx group, so it is ready before the mixer gets to it
+	FMOD::Channel* channel = nullptr;
+	FMOD_RESULT result = m_fmodSystem->playSound(ToFmodSound(sound), m_channelGroup, true, &channel);
+	if (result != FMOD_OK)
+	{
+		LOG_SCR_F("Failed to play FMOD sound: %s\n", FMOD_ErrorString(result));
+		return INVALID_VOICE;
+	}
+
+	// the channel loops, not the sound, so the other users of the sound still play it once
+	if (isLooping)
+	{
+		channel->setMode(FMOD_LOOP_NORMAL);
+		channel->setLoopCount(-1);
+	}
+	channel->setVolume(volume);
+	channel->setPaused(false);
+	return static_cast<VoiceHandle>(reinterpret_cast<uintptr_t>(channel));
+}
+
+// fails harmlessly if the channel already finished
+void CFmodAudioBackend::StopVoice(VoiceHandle voice)
+{
+	ToFmodChannel(voice)->stop();
+}
+
+// FMOD invalidates the handle of a channel once it finishes (or it steals it for another sound)
+bool CFmodAudioBackend::IsVoicePlaying(VoiceHandle voice)
+{
+	bool isPlaying = false;
+	return ToFmodChannel(voice)->isPlaying(&isPlaying) == FMOD_OK && isPlaying;
+}
+
+float CFmodAudioBackend::GetVoiceAudibility(VoiceHandle voice)
+{
+	float audibility = 0.0f;
+	ToFmodChannel(voice)->getAudibility(&audibility);
+	return audibility;
+}
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED && SOUND_FMOD_ENABLED
+
+#include "audiobackend.h"
+#include <fmod.hpp>
+#include <fmod_errors.h>
+
+// FMOD core API, the FMOD sounds and channels are the handles
+class CFmodAudioBackend : public CAudioBackend
+{
+public:
+	bool Init(CAssetArchive* assetArchive) override;
+	void Destroy() override;
+	const char* GetName() override { return "fmod"; }
+
+	SoundHandle CreateSound(const std::string& path) override;
+	void ReleaseSound(SoundHandle sound) override;
+	size_t GetSoundSizeInBytes(SoundHandle sound) override;
+
+	void Update() override;
+	VoiceHandle PlaySound(SoundHandle sound, float volume, bool isLooping) override;
+	void StopVoice(VoiceHandle voice) override;
+	bool IsVoicePlaying(VoiceHandle voice) override;
+	float GetVoiceAudibility(VoiceHandle voice) override;
+
+private:
+	static FMOD::Sound* ToFmodSound(SoundHandle sound) { return static_cast<FMOD::Sound*>(sound); }
+	static FMOD::Channel* ToFmodChannel(VoiceHandle voice) { return reinterpret_cast<FMOD::Channel*>(static_cast<uintptr_t>(voice)); }
+
+	CAssetArchive* m_assetArchive = nullptr;
+	FMOD::System* m_fmodSystem = nullptr;
+	FMOD::ChannelGroup* m_channelGroup = nullptr;
+};
+
+#endif
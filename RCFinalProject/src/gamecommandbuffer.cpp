@@ -0,0 +1,88 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "gamecommandbuffer.h"
+
+void CGameCommandBuffer::Push(SCommand& command)
+{
+	m_commands.push_back(command);
+}
+
+void CGameCommandBuffer::SpawnProjectile(CProjectile::EProjectileOwner owner, CProjectile::EProjectileType projectileType, float x, float y)
+{
+	SCommand command;
+	command.m_type = ECommandType::SPAWN_PROJECTILE;
+	command.m_projectileOwner = owner;
+	command.m_projectileType = projectileType;
+	command.m_x = x;
+	command.m_y = y;
+	Push(command);
+}
+
+void CGameCommandBuffer::SpawnExplosion(CEntity::EEntityType entityType, float x, float y)
+{
+	SCommand command;
+	command.m_type = ECommandType::SPAWN_EXPLOSION;
+	command.m_entityType = entityType;
+	command.m_x = x;
+	command.m_y = y;
+	Push(command);
+}
+
+void CGameCommandBuffer::DespawnEnemy(CEnemy* enemy)
+{
+	SCommand command;
+	command.m_type = ECommandType::DESPAWN_ENEMY;
+	command.m_enemy = enemy;
+	Push(command);
+}
+
+void CGameCommandBuffer::DespawnBoss()
+{
+	SCommand command;
+	command.m_type = ECommandType::DESPAWN_BOSS;
+	Push(command);
+}
+
+void CGameCommandBuffer::OnPlayerDeath()
+{
+	SCommand command;
+	command.m_type = ECommandType::PLAYER_DEATH;
+	Push(command);
+}
+
+void CGameCommandBuffer::AddScore(int score)
+{
+	SCommand command;
+	command.m_type = ECommandType::ADD_SCORE;
+	command.m_score = score;
+	Push(command);
+}
+
+#if SOUND_ENABLED
+void CGameCommandBuffer::PlaySound(CSound* sound, float volume)
+{
+	SCommand command;
+	command.m_type = ECommandType::PLAY_SOUND;
+	command.m_sound = sound;
+	command.m_volume = volume;
+	Push(command);
+}
+#endif
+
+void CGameCommandBuffer::TakeCommands(std::vector<SCommand>& commands)
+{
+	commands.clear();
+	m_commands.swap(commands);
+}
+
+bool CGameCommandBuffer::IsEmpty()
+{
+	return m_commands.empty();
+}
+
+void CGameCommandBuffer::Clear()
+{
+	m_commands.clear();
+}
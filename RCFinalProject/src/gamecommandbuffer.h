@@ -0,0 +1,77 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include "entity.h"
+#include "preproc.h"
+#include "projectile.h"
+#include <vector>
+
+class CEnemy;
+#if SOUND_ENABLED
+class CSound;
+#endif
+
+// the side effects of the gameplay (spawning, despawning, score, sounds) are queued here while the entities update
+// and applied by the ingame state at a fixed point of its update, so no entity list changes while it is iterated.
+// commands are applied in the order they were pushed. only to be used by the thread updating the game, the jobs it
+// runs leave their results in the entities and it pushes the commands for them once the jobs are done
+class CGameCommandBuffer
+{
+public:
+	enum class ECommandType : int
+	{
+		SPAWN_PROJECTILE,
+		SPAWN_EXPLOSION,
+		DESPAWN_ENEMY,
+		DESPAWN_BOSS,
+		PLAYER_DEATH,
+		ADD_SCORE,
+		PLAY_SOUND
+	};
+
+	struct SCommand
+	{
+		ECommandType m_type = ECommandType::ADD_SCORE;
+		CEntity::EEntityType m_entityType = CEntity::EEntityType::UNASSIGNED; // SPAWN_EXPLOSION
+		CProjectile::EProjectileOwner m_projectileOwner = CProjectile::EProjectileOwner::UNASSIGNED; // SPAWN_PROJECTILE
+		CProjectile::EProjectileType m_projectileType = CProjectile::EProjectileType::UNASSIGNED; // SPAWN_PROJECTILE
+		float m_x = 0.0f; // SPAWN_PROJECTILE, SPAWN_EXPLOSION
+		float m_y = 0.0f;
+		CEnemy* m_enemy = nullptr; // DESPAWN_ENEMY
+		int m_score = 0; // ADD_SCORE
+#if SOUND_ENABLED
+		CSound* m_sound = nullptr; // PLAY_SOUND
+		float m_volume = SOUND_DEFAULT_VOLUME;
+#endif
+	};
+
+	void Push(SCommand& command);
+
+	void SpawnProjectile(CProjectile::EProjectileOwner owner, CProjectile::EProjectileType projectileType, float x, float y);
+	void SpawnExplosion(CEntity::EEntityType entityType, float x, float y);
+	void DespawnEnemy(CEnemy* enemy);
+	void DespawnBoss();
+	void OnPlayerDeath();
+	void AddScore(int score);
+#if SOUND_ENABLED
+	void PlaySound(CSound* sound, float volume = SOUND_DEFAULT_VOLUME);
+#endif
+
+	// hands over everything pushed so far in the order it has to be applied and empties the buffer. applying the
+	// commands may push new ones
+	void TakeCommands(std::vector<SCommand>& commands);
+
+	bool IsEmpty();
+	void Clear();
+
+private:
+	std::vector<SCommand> m_commands;
+};
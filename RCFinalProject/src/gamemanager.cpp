@@ -7,21 +7,59 @@
 #include "ingamestate.h"
 #include "introstate.h"
 #include <assert.h>
+#include "profiler.h"
+#include "utils.h"
 
-void CGameManager::Init()
+void CGameManager::Init(const SServices* services)
 {
+	m_services = services;
 	RequestState(INITIAL_STATE);
 }
 
 void CGameManager::Destroy()
 {
-	// destroy the current state
 	if (m_stateObj != nullptr)
 	{
-		m_stateObj->CleanUp();
-		delete m_stateObj;
+		m_stateObj->Exit();
 		m_stateObj = nullptr;
 	}
+
+	for (int i = 0; i < static_cast<int>(EGameState::COUNT); i++)
+	{
+		if (m_stateObjs[i] != nullptr)
+		{
+			m_stateObjs[i]->CleanUp();
+			delete m_stateObjs[i];
+			m_stateObjs[i] = nullptr;
+		}
+	}
+	m_currentState = EGameState::UNASSIGNED;
+	m_preloadedState = EGameState::UNASSIGNED;
+}
+
+CGameState* CGameManager::CreateStateObject(EGameState state)
+{
+	if (state == EGameState::INTRO)
+	{
+		return new CIntroState(m_services); // polymorphism
+	}
+	else if (state == EGameState::INGAME)
+	{
+		return new CIngameState(m_services); // polymorphism
+	}
+
+	return nullptr;
+}
+
+CGameState* CGameManager::GetStateObject(EGameState state)
+{
+	CGameState*& stateObj = m_stateObjs[static_cast<int>(state)];
+	if (stateObj == nullptr)
+	{
+		stateObj = CreateStateObject(state);
+	}
+
+	return stateObj;
 }
 
 void CGameManager::RequestState(EGameState state)
@@ -29,6 +67,22 @@ void CGameManager::RequestState(EGameState state)
 	m_requestedState = state;
 }
 
+void CGameManager::PreloadState(EGameState state)
+{
+	if (m_preloadedState == state)
+	{
+		return;
+	}
+
+	CGameState* stateObj = GetStateObject(state);
+	if (!stateObj->IsInitialized())
+	{
+		LOG_SCR_F("Preloading game state: %d\n", static_cast<int>(state));
+		stateObj->Preload();
+	}
+	m_preloadedState = state;
+}
+
 void CGameManager::HandleKeyDownInput(SDL_KeyboardEvent* kbEvent)
 {
 	if (m_stateObj == nullptr)
@@ -77,6 +131,17 @@ void CGameManager::HandleKeyUpInput(SDL_KeyboardEvent* kbEvent)
 	}
 }
 
+void CGameManager::OnRenderTargetsReset()
+{
+	for (int i = 0; i < static_cast<int>(EGameState::COUNT); i++)
+	{
+		if (m_stateObjs[i] != nullptr && m_stateObjs[i]->IsInitialized())
+		{
+			m_stateObjs[i]->OnRenderTargetsReset();
+		}
+	}
+}
+
 void CGameManager::Update(Uint32 elapsedTime)
 {
 	if (m_toggleBackgroundScrollingKeyPressed == 1)
@@ -89,26 +154,39 @@ void CGameManager::Update(Uint32 elapsedTime)
 	{
 		assert(m_requestedState != m_currentState);
 
-		// destroy the previous state
-		Destroy();
-		
-		// create the new state
-		if (m_requestedState == EGameState::INTRO)
+		// the previous state stays alive, it only has to let go of what it is playing
+		if (m_stateObj != nullptr)
 		{
-			m_stateObj = new CIntroState(); // polymorphism
+			m_stateObj->Exit();
 		}
-		else if (m_requestedState == EGameState::INGAME)
+
+		m_stateObj = GetStateObject(m_requestedState);
+		if (m_requestedState == m_preloadedState)
 		{
-			m_stateObj = new CIngameState(); // polymorphism
+			m_preloadedState = EGameState::UNASSIGNED;
 		}
 
 		m_currentState = m_requestedState;
 		m_requestedState = EGameState::UNASSIGNED;
 
-		m_stateObj->Init();
+		// loading only happens the first time a state is entered (unless it was preloaded)
+		Uint64 initCounter = SDL_GetPerformanceCounter();
+		if (!m_stateObj->IsInitialized())
+		{
+			m_stateObj->Init();
+		}
+		m_stateObj->Enter();
+		m_services->m_profiler->RecordStartupPhase(CProfiler::EStartupPhase::INIT_FIRST_STATE, initCounter);
+	}
+
+	// keep building the preloaded state while the current one runs
+	if (m_preloadedState != EGameState::UNASSIGNED)
+	{
+		GetStateObject(m_preloadedState)->UpdatePreload();
 	}
 
-	// there is always one state playing, no need to check for if nullptr
+	// there is always one state playing, no need to check for if nullptr. drawing only records the frame, the render
+	// thread draws it while the next update runs
 	m_stateObj->Update(elapsedTime);
 	m_stateObj->Draw();
 #if DEBUG_DRAW
@@ -11,6 +11,7 @@
 #endif
 
 #include "gamestate.h"
+#include "services.h"
 
 class CGameManager
 {
@@ -19,32 +20,57 @@ public:
 	{
 		UNASSIGNED,
 		INTRO,
-		INGAME
+		INGAME,
+		COUNT
 	};
 
-	void Init();
+	// the states are created with these services
+	void Init(const SServices* services);
 	void Destroy();
 
 	void Update(Uint32 elapsedTime);
 	void RequestState(EGameState state);
 
+	// builds the given state in the background, requesting it later switches to it without loading. states stay
+	// loaded once built, so this does nothing the second time
+	void PreloadState(EGameState state);
+
 	static const EGameState INITIAL_STATE = EGameState::INTRO;
 
 	void HandleKeyDownInput(SDL_KeyboardEvent* kbEvent);
 	void HandleKeyUpInput(SDL_KeyboardEvent* kbEvent);
 
+	// passed on to every state that was created, the preloaded ones render into their targets too
+	void OnRenderTargetsReset();
+
 	CGameState* GetState() { return m_stateObj; }
+	bool IsLoading() { return m_stateObj == nullptr || m_stateObj->IsLoading(); }
 	
 	void ToggleIsBackgroundScrollingEnabled() { m_isBackgroundScrollingEnabled = !m_isBackgroundScrollingEnabled; }
 	bool IsBackgroundScrollingEnabled() { return m_isBackgroundScrollingEnabled; }
+
+	// the games started from now on have a second player, whose input arrives with the given round trip latency
+	void SetTwoPlayerGame(bool isTwoPlayerGame, Uint32 latencyMs) { m_isTwoPlayerGame = isTwoPlayerGame; m_twoPlayerLatencyMs = latencyMs; }
+	bool IsTwoPlayerGame() { return m_isTwoPlayerGame; }
+	Uint32 GetTwoPlayerLatencyMs() { return m_twoPlayerLatencyMs; }
 	
 private:
+	CGameState* CreateStateObject(EGameState state);
+	CGameState* GetStateObject(EGameState state);
+
+	const SServices* m_services = nullptr;
+
 	EGameState m_currentState = EGameState::UNASSIGNED;
 	EGameState m_requestedState = EGameState::UNASSIGNED;
+	EGameState m_preloadedState = EGameState::UNASSIGNED;
 
+	// created the first time they are needed, switching states only calls Exit() and Enter()
+	CGameState* m_stateObjs[static_cast<int>(EGameState::COUNT)] = {};
 	CGameState* m_stateObj = nullptr;
 
 	bool m_isBackgroundScrollingEnabled = true;
+	bool m_isTwoPlayerGame = false;
+	Uint32 m_twoPlayerLatencyMs = 0;
 
 	Uint8 m_toggleBackgroundScrollingKeyPressed = 0;
 };
\ No newline at end of file
@@ -9,24 +9,46 @@
 #else
 #include <SDL.h>
 #endif
+#include "services.h"
 
+// the game manager keeps every state alive once it is created: Init() runs before a state first becomes the
+// current one and CleanUp() when the game quits, Enter() and Exit() every time it becomes / stops being current
 class CGameState
 {
 public:
+	CGameState(const SServices* services) : m_services(services) {}
+	virtual ~CGameState() {}
+
 	virtual void Init() = 0;
 	virtual void CleanUp() = 0;
+	virtual void Enter() = 0;
+	virtual void Exit() = 0;
 	virtual void HandleKeyDownInput(SDL_KeyboardEvent* kbEvent) = 0;
 	virtual void HandleKeyUpInput(SDL_KeyboardEvent* kbEvent) = 0;
 	virtual void Update(Uint32 elapsedTime) = 0;
 	virtual void Draw() = 0;
 	virtual void DrawDebug() {}
 
-protected:
+	// lets the game manager get a state ready while another one is running, Init() is not called if this already
+	// initialized it. UpdatePreload() is called every frame until the state becomes the current one
+	virtual void Preload() {}
+	virtual void UpdatePreload() {}
+
+	// true while the state only draws its loading screen
+	virtual bool IsLoading() { return false; }
+
+	// the renderer lost the contents of the render targets (or the whole device), whatever was rendered into them
+	// has to be rendered again
+	virtual void OnRenderTargetsReset() {}
+
 	bool IsInitialized() { return m_isInitialized; }
+
+protected:
 	void SetIsInitialized(bool isInitialized)
 	{
 		m_isInitialized = isInitialized;
 	}
 
+	const SServices* m_services = nullptr;
 	bool m_isInitialized = false;
 };
\ No newline at end of file
@@ -5,41 +5,209 @@
 #include "ingamestate.h"
 
 #include <assert.h>
+#include "gamemanager.h"
+#include "jobsystem.h"
+#include "renderthread.h"
+#include "rollbacksession.h"
+#include <type_traits>
 #include "utils.h"
 #include "entity.h"
 
+static_assert(std::is_trivially_copyable<CIngameState::SSnapshot>::value, "snapshots are copied as plain bytes");
+static_assert(SPlayfieldObservation::MAX_PLAYERS == CIngameState::MAX_PLAYERS, "every player has a slot in the observation");
+
+CIngameState::CIngameState(const SServices* services) : CGameState(services), m_gameServices(*services), m_starfield(&m_gameServices, &m_random)
+{
+	// the same services as the app's, but measuring time with the game's clock
+	m_gameServices.m_clock = &m_gameClock;
+	m_services = &m_gameServices;
+
+	// the entities talk to the game they belong to, not to whatever state the game manager is in
+	m_playerShip.SetIngameState(this);
+	m_secondPlayerShip.SetIngameState(this);
+	m_enemyFormation.SetIngameState(this);
+	m_boss.SetIngameState(this);
+}
+
 void CIngameState::Init()
 {
-	InitValues();
+	// usually done already, while the intro was running
+	if (!m_isPreloaded)
+	{
+		Preload();
+	}
+}
+
+void CIngameState::Enter()
+{
+	// a headless game is always played by one
+	m_isTwoPlayerGame = !m_isHeadless && m_services->m_gameManager->IsTwoPlayerGame();
+	if (m_isTwoPlayerGame && m_rollbackSession == nullptr)
+	{
+		// this machine is the first player, the loopback transport plays the second one
+		m_loopbackTransport.Init(1, m_services->m_gameManager->GetTwoPlayerLatencyMs(), TWO_PLAYER_LOOPBACK_JITTER_MS);
+		m_rollbackSession = new CRollbackSession();
+		m_rollbackSession->Init(this, &m_loopbackTransport, 0);
+	}
+
+	ResetGame();
+
+	if (m_isWarmedUp)
+	{
+		// everything was prepared while the intro was running, or by the previous game
+		StartGame();
+	}
+	else
+	{
+		// the textures and sounds are loaded in the background, the game starts once they are ready
+		RequestState(INITIAL_STATE);
+	}
+}
+
+void CIngameState::Exit()
+{
+#if SOUND_ENABLED
+	if (!m_isHeadless)
+	{
+		m_music.Stop();
+	}
+#endif
+}
+
+// everything that can be done before this is the current state: queue the assets and allocate the entities
+void CIngameState::Preload()
+{
+	QueueTextures();
 #if SOUND_ENABLED
-	InitSounds();
+	QueueSounds();
 #endif	
+	InitText();
+	m_enemyFormation.AllocatePool();
+	m_random.Seed(SDL_GetPerformanceCounter());
+
+	// owns resources from now on, even if it never becomes the current state
+	m_isInitialized = true;
+	m_isPreloaded = true;
+}
+
+void CIngameState::UpdatePreload()
+{
+	if (!m_isWarmedUp && m_services->m_assetLoader->IsIdle())
+	{
+		WarmUp();
+	}
+}
+
+void CIngameState::OnRenderTargetsReset()
+{
+	m_starfield.OnRenderTargetsReset();
+	if (m_rotatedEnemyProjectilesSheet.IsCreated())
+	{
+		m_rotatedEnemyProjectilesSheet.Redraw();
+	}
+}
+
+void CIngameState::InitHeadless(Uint64 seed)
+{
+	m_isHeadless = true;
+	m_random.Seed(seed);
+	m_enemyFormation.AllocatePool();
+
+	// the entities keep pointers to the textures and sounds, they are just never created / loaded
+	m_playerShip.Init(&m_playerShipSheetTexture);
+	m_secondPlayerShip.Init(&m_playerShipSheetTexture);
+	m_enemyFormation.InitTexture(&m_enemySpriteSheetTexture);
+	m_boss.Init(&m_enemySpriteSheetTexture);
+#if SOUND_ENABLED
+	m_playerShip.InitSound(&m_playerShootSound, &m_playerShieldSound, &m_playerShieldNullifiedSound);
+	m_secondPlayerShip.InitSound(&m_playerShootSound, &m_playerShieldSound, &m_playerShieldNullifiedSound);
+	m_enemyFormation.InitSound(&m_enemyAttackSound);
+	m_boss.InitSound(&m_bossSpawnSound, &m_bossNullifySound, &m_bossEnhanceSound);
+#endif
+
+	m_isInitialized = true;
+	m_isPreloaded = true;
+	m_isWarmedUp = true;
+}
+
+// sets up everything that needs the loaded assets
+void CIngameState::WarmUp()
+{
 	m_starfield.Init();
 	InitPlayer();
 	InitEnemies();
 	InitProjectiles();
-	InitText();
 
-	m_isInitialized = true;
+	m_isWarmedUp = true;
+}
+
+// puts everything back the way a new game starts, nothing is loaded or allocated again
+void CIngameState::ResetGame()
+{
+	InitValues();
+
+	m_commandBuffer.Clear();
+	ClearProjectiles();
+	ClearExplosions();
+	m_enemyFormation.Despawn();
+	m_boss.Despawn();
+	m_starfield.StopAnimation();
+
+	// side by side in a two player game, in the middle otherwise
+	m_playerShip.SetSpawnOffsetX(m_isTwoPlayerGame ? -TWO_PLAYER_SPAWN_OFFSET_X : 0.0f);
+	m_secondPlayerShip.SetSpawnOffsetX(TWO_PLAYER_SPAWN_OFFSET_X);
+	m_playerShip.Reset();
+	m_secondPlayerShip.Reset();
+	m_secondPlayerInput.Reset();
+}
+
+void CIngameState::StartGame()
+{
+	m_lastBossSpawnTicks = m_gameClock.GetTicks();
+
+	// both players start from frame 0, with nothing on its way
+	if (m_isTwoPlayerGame)
+	{
+		m_loopbackTransport.Reset();
+		m_rollbackSession->Reset();
+	}
 
 #if SOUND_ENABLED
 	// start playing the music
-	m_music.SetLoop(true);
-	m_music.Play(SOUND_MUSIC_VOLUME);
+	if (!m_isHeadless)
+	{
+		m_music.SetLoop(true);
+		m_music.Play(SOUND_MUSIC_VOLUME);
+	}
 #endif
 
 	// spawn enemies
 	m_enemyFormation.Spawn();
 
-	RequestState(INITIAL_STATE);
+	RequestState(EState::PLAYING);
 	RequestMessageState(INITIAL_MESSAGE_STATE);
 }
 
 void CIngameState::CleanUp()
 {
-	if (IsInitialized())
+	if (m_rollbackSession != nullptr)
+	{
+		m_rollbackSession->Destroy();
+		delete m_rollbackSession;
+		m_rollbackSession = nullptr;
+	}
+
+	if (IsInitialized() && m_isHeadless)
+	{
+		// nothing was loaded
+		ClearProjectiles();
+		m_enemyFormation.Destroy();
+		m_boss.Destroy();
+	}
+	else if (IsInitialized())
 	{
 		DestroyText();
+		ClearExplosions();
 		DestroyProjectiles();
 		DestroyEnemies();
 		DestroyPlayer();
@@ -113,7 +281,15 @@ void CIngameState::HandleKeyDownInput(SDL_KeyboardEvent* kbEvent)
 		m_playerShip.SetInputShield(1);
 		break;
 
+	case SDL_SCANCODE_P:
+		TogglePause();
+		break;
+
 #if DEBUG_ENABLE_HOTKEYS
+	case SDL_SCANCODE_F:
+		ToggleFastForward();
+		break;
+
 	case SDL_SCANCODE_B:
 		SpawnBoss(CBoss::EBossType::SAUCER);
 		break;
@@ -126,6 +302,10 @@ void CIngameState::HandleKeyDownInput(SDL_KeyboardEvent* kbEvent)
 		SpawnBoss(CBoss::EBossType::WALKER);
 		break;
 #endif
+
+	default:
+		HandleSecondPlayerKey(kbEvent->keysym.scancode, 1);
+		break;
 	}
 }
 
@@ -184,12 +364,53 @@ void CIngameState::HandleKeyUpInput(SDL_KeyboardEvent* kbEvent)
 		// request gamemanager to switch state
 		ReturnToIntroState();
 		break;
+
+	default:
+		HandleSecondPlayerKey(kbEvent->keysym.scancode, 0);
+		break;
 	}	
 }
 
+// W, A, S, D to move, Q to fire and E for the shield. the keys are not handed to the ship, they are the input the
+// loopback transport sends back as the other player's
+void CIngameState::HandleSecondPlayerKey(SDL_Scancode scancode, Uint8 value)
+{
+	if (!m_isTwoPlayerGame)
+	{
+		return;
+	}
+
+	switch (scancode)
+	{
+	case SDL_SCANCODE_W:
+		m_secondPlayerInput.m_up = value;
+		break;
+	case SDL_SCANCODE_S:
+		m_secondPlayerInput.m_down = value;
+		break;
+	case SDL_SCANCODE_A:
+		m_secondPlayerInput.m_left = value;
+		break;
+	case SDL_SCANCODE_D:
+		m_secondPlayerInput.m_right = value;
+		break;
+	case SDL_SCANCODE_Q:
+		m_secondPlayerInput.m_fire = value;
+		break;
+	case SDL_SCANCODE_E:
+		m_secondPlayerInput.m_shield = value;
+		break;
+	default:
+		break;
+	}
+}
+
 void CIngameState::InitValues()
 {
-	SetIsInitialized(false);
+	m_currentState = EState::UNASSIGNED;
+	m_requestedState = EState::UNASSIGNED;
+	m_currentMessageState = EMessageState::UNASSIGNED;
+	m_requestedMessageState = EMessageState::UNASSIGNED;
 
 	m_score = 0;
 	m_previousScore = -1;
@@ -197,21 +418,39 @@ void CIngameState::InitValues()
 	m_previousLevel = -1;
 	m_lives = GAMEPLAY_STARTING_LIVES;
 	m_previousLives = -1;
+
+	m_gameClock.SetTicks(0);
+	m_isPaused = false;
+	m_isFastForwarding = false;
+}
+
+void CIngameState::QueueTextures()
+{
+	CAssetLoader* assetLoader = m_services->m_assetLoader;
+	m_starfield.QueueTextures(assetLoader);
+	assetLoader->QueueTexture(&m_playerShipSheetTexture, TEXTURE_PLAYERSHIP_SPRITESHEET_FILENAME);
+	assetLoader->QueueTexture(&m_enemySpriteSheetTexture, TEXTURE_ENEMY_SPRITESHEET_FILENAME);
+	assetLoader->QueueTexture(&m_projectilesSheetTexture, TEXTURE_PROJECTILES_SPRITESHEET_FILENAME);
 }
 
 #if SOUND_ENABLED
-void CIngameState::InitSounds()
+void CIngameState::QueueSounds()
 {
-	m_music.CreateFromFile(SOUND_MUSIC_FILENAME);
-	m_playerShootSound.CreateFromFile(SOUND_PLAYER_PROJECTILE_FILENAME);
-	m_playerShieldSound.CreateFromFile(SOUND_PLAYER_SHIELD_FILENAME);
-	m_playerExplosionSound.CreateFromFile(SOUND_PLAYER_EXPLOSION_FILENAME);
-	m_playerShieldNullifiedSound.CreateFromFile(SOUND_PLAYER_SHIELD_NULLIFIED_FILENAME);
-	m_enemyExplosionSound.CreateFromFile(SOUND_ENEMY_EXPLOSION_FILENAME);
-	m_enemyAttackSound.CreateFromFile(SOUND_ENEMY_PROJECTILE_FILENAME);
-	m_bossSpawnSound.CreateFromFile(SOUND_BOSS_SPAWN_FILENAME);
-	m_bossNullifySound.CreateFromFile(SOUND_BOSS_NULLIFY_FILENAME);
-	m_bossEnhanceSound.CreateFromFile(SOUND_BOSS_ENHANCE_FILENAME);
+	m_music.SetMaxVoices(SOUND_MUSIC_MAX_VOICES);
+	m_enemyExplosionSound.SetMaxVoices(SOUND_ENEMY_EXPLOSION_MAX_VOICES);
+	m_enemyAttackSound.SetMaxVoices(SOUND_ENEMY_PROJECTILE_MAX_VOICES);
+
+	CAssetLoader* assetLoader = m_services->m_assetLoader;
+	assetLoader->QueueSound(&m_music, SOUND_MUSIC_FILENAME);
+	assetLoader->QueueSound(&m_playerShootSound, SOUND_PLAYER_PROJECTILE_FILENAME);
+	assetLoader->QueueSound(&m_playerShieldSound, SOUND_PLAYER_SHIELD_FILENAME);
+	assetLoader->QueueSound(&m_playerExplosionSound, SOUND_PLAYER_EXPLOSION_FILENAME);
+	assetLoader->QueueSound(&m_playerShieldNullifiedSound, SOUND_PLAYER_SHIELD_NULLIFIED_FILENAME);
+	assetLoader->QueueSound(&m_enemyExplosionSound, SOUND_ENEMY_EXPLOSION_FILENAME);
+	assetLoader->QueueSound(&m_enemyAttackSound, SOUND_ENEMY_PROJECTILE_FILENAME);
+	assetLoader->QueueSound(&m_bossSpawnSound, SOUND_BOSS_SPAWN_FILENAME);
+	assetLoader->QueueSound(&m_bossNullifySound, SOUND_BOSS_NULLIFY_FILENAME);
+	assetLoader->QueueSound(&m_bossEnhanceSound, SOUND_BOSS_ENHANCE_FILENAME);
 }
 
 void CIngameState::DestroySounds()
@@ -231,6 +470,43 @@ void CIngameState::DestroySounds()
 
 void CIngameState::Update(Uint32 elapsedTime)
 {
+	// the game clock stands still with everything else
+	if (m_isPaused)
+	{
+		return;
+	}
+
+	// the rollback session runs the frames once the game is ready to be played, at their own pace
+	if (m_isTwoPlayerGame && m_isWarmedUp && m_currentState != EState::LOADING)
+	{
+		UpdateTwoPlayerGame(elapsedTime);
+		return;
+	}
+
+	// more ticks rather than longer ones, nothing moves further in one tick than it usually does
+	int numTicks = m_isFastForwarding ? FAST_FORWARD_TICKS_PER_UPDATE : 1;
+	for (int i = 0; i < numTicks; i++)
+	{
+		Tick(elapsedTime);
+	}
+}
+
+void CIngameState::UpdateTwoPlayerGame(Uint32 elapsedTime)
+{
+	// the session sets the ships' input of every frame it runs, and may go back to frames from before the last key
+	// presses. the live keyboard input is kept aside and put back for the key events that come next
+	CPlayerShip::SInputData localInput = m_playerShip.GetInputData();
+
+	m_loopbackTransport.SetRemoteInput(m_secondPlayerInput);
+	m_rollbackSession->Update(elapsedTime, localInput);
+
+	m_playerShip.SetInputData(localInput);
+}
+
+void CIngameState::Tick(Uint32 elapsedTime)
+{
+	m_gameClock.Advance(elapsedTime);
+
 	// handle state requests
 	if (m_requestedState != EState::UNASSIGNED)
 	{
@@ -241,23 +517,43 @@ void CIngameState::Update(Uint32 elapsedTime)
 	{
 		m_currentMessageState = m_requestedMessageState;
 		m_requestedMessageState = EMessageState::UNASSIGNED;
-		m_lastMessageDisplayTicks = Utils::GetTicks();
+		m_lastMessageDisplayTicks = m_gameClock.GetTicks();
+	}
+
+	if (m_currentState == EState::LOADING)
+	{
+		UpdatePreload();
+		if (m_isWarmedUp)
+		{
+			StartGame();
+		}
+		return;
 	}
 
 	// update game loop
 	if (m_currentState == EState::PLAYING || m_currentState == EState::PLAYER_DEATH_COOLDOWN)
 	{
+		// a headless game has no game manager, the starfield's animation still decides when the player respawns
+		m_starfield.SetIsScrollingEnabled(m_isHeadless || m_services->m_gameManager->IsBackgroundScrollingEnabled());
 		m_starfield.Update(elapsedTime);
-		m_playerShip.Update(elapsedTime);
-		UpdateEnemies(elapsedTime);
-		UpdateProjectiles(elapsedTime);
+		for (int i = 0; i < GetNumPlayers(); i++)
+		{
+			GetPlayerShip(i)->Update(elapsedTime);
+		}
+		UpdateEntities(elapsedTime);
 		UpdateExplosions(elapsedTime);
 		UpdateText(elapsedTime);
 
 		if (m_currentState == EState::PLAYER_DEATH_COOLDOWN && !m_starfield.IsPlayingAnimation())
 		{
-			// respawn the player
-			m_playerShip.Respawn();
+			// respawn the players that died, the other one plays on where it is
+			for (int i = 0; i < GetNumPlayers(); i++)
+			{
+				if (!GetPlayerShip(i)->IsAlive())
+				{
+					GetPlayerShip(i)->Respawn();
+				}
+			}
 			
 			// request the playing state
 			RequestState(EState::PLAYING);
@@ -272,18 +568,33 @@ void CIngameState::Update(Uint32 elapsedTime)
 	}
 }
 
+// the enemies and projectiles are updated in phases so they can be spread over the job threads: first they all move,
+// then the collisions are found without changing anything, then the hits are applied one by one on the main thread.
+// the hits are applied in list order, so the outcome does not depend on how many threads there are.
+// nothing is spawned or despawned until ApplyCommands(), the lists stay the same for the whole update
+void CIngameState::UpdateEntities(Uint32 elapsedTime)
+{
+	UpdateEnemies(elapsedTime);
+	UpdateProjectiles(elapsedTime);
+
+#if COLLISIONS_ENABLED
+	DetectCollisions();
+	ResolveCollisions();
+#endif
+
+	ApplyCommands();
+	RemoveDeadProjectiles();
+	m_enemyFormation.UpdateFormation(elapsedTime);
+}
+
 void CIngameState::UpdateEnemies(Uint32 elapsedTime)
 {
-	m_enemyFormation.Update(elapsedTime);
+	m_enemyFormation.UpdateEnemies(elapsedTime);
 
-	if (m_currentState == EState::PLAYING)
+	// see if it is time to spawn a boss
+	if (CanSpawnBoss())
 	{
-		// see if it is time to spawn a boss
-		CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-		if (ingameState->CanSpawnBoss())
-		{
-			m_boss.Spawn(CBoss::EBossType::RANDOM);
-		}
+		m_boss.Spawn(CBoss::EBossType::RANDOM);
 	}
 
 	m_boss.Update(elapsedTime);	
@@ -291,99 +602,257 @@ void CIngameState::UpdateEnemies(Uint32 elapsedTime)
 
 bool CIngameState::CanSpawnBoss()
 {
-	return m_currentState == EState::PLAYING && !m_boss.IsAlive() && static_cast<Uint32>(m_enemyFormation.GetEnemyCount()) >= BOSS_SPAWN_MINIMUM_ENEMIES && Utils::GetTicks() - m_lastBossSpawnTicks > BOSS_SPAWN_INTERVAL_MS;
+	return m_currentState == EState::PLAYING && !m_boss.IsAlive() && static_cast<Uint32>(m_enemyFormation.GetEnemyCount()) >= BOSS_SPAWN_MINIMUM_ENEMIES && m_gameClock.GetTicks() - m_lastBossSpawnTicks > BOSS_SPAWN_INTERVAL_MS;
 }
 
 void CIngameState::UpdateProjectiles(Uint32 elapsedTime)
 {
+	m_projectileArray.clear();
 	CProjectile* projectilePtr = m_projectilesList.GetHeadElement();
 	while (projectilePtr != nullptr)
 	{
-		projectilePtr->Update(elapsedTime);
-				
-#if COLLISIONS_ENABLED
-		// check if a player projectile has collided against an ENEMY
-		if (projectilePtr->GetOwner() == CProjectile::EProjectileOwner::PLAYER)
+		m_projectileArray.push_back(projectilePtr);
+		projectilePtr = m_projectilesList.GetNextElement(projectilePtr);
+	}
+
+	m_services->m_jobSystem->ParallelFor(static_cast<int>(m_projectileArray.size()), ENTITY_BATCH_SIZE, [this, elapsedTime](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
 		{
-			CDoubleLinkedList<CEnemy*>& enemiesList = m_enemyFormation.GetEntities();
+			m_projectileArray[i]->Update(elapsedTime);
+		}
+	});
+}
 
-			CEnemy* enemyPtr = enemiesList.GetHeadElement();
-			while (enemyPtr != nullptr)
-			{
-				if (enemyPtr->CollidesWith(projectilePtr))
-				{
-					// get the enemy position before destroying it
-					float explosionPosX = enemyPtr->GetPosX() + static_cast<float>(CEnemy::SPRITE_WIDTH / 2.0) - static_cast<float>(CExplosion::SPRITE_WIDTH / 2.0);
-					float explosionPosY = enemyPtr->GetPosY() + static_cast<float>(CEnemy::SPRITE_HEIGHT / 2.0) - static_cast<float>(CExplosion::SPRITE_HEIGHT / 2.0);
+#if COLLISIONS_ENABLED
+void CIngameState::DetectCollisions()
+{
+	CJobSystem* jobSystem = m_services->m_jobSystem;
+	const std::vector<CEnemy*>& enemies = m_enemyFormation.GetEnemyArray();
 
-					CEnemy* nextElement = enemiesList.RemoveElement(enemyPtr);
-					LOG_SCR_F("Deleting enemy %d\n", (int)(size_t)enemyPtr);
-					delete enemyPtr;
-					enemyPtr = nextElement;
+	bool isAnyPlayerAlive = false;
+	for (int i = 0; i < GetNumPlayers(); i++)
+	{
+		isAnyPlayerAlive = isAnyPlayerAlive || GetPlayerShip(i)->IsAlive();
+	}
 
-					m_enemyFormation.OnEnemyDeath();
+	// check if an enemy has collided against a player's ship, the first player's if against both
+	m_enemyHits.assign(enemies.size(), SHitRecord());
+	if (isAnyPlayerAlive)
+	{
+		jobSystem->ParallelFor(static_cast<int>(enemies.size()), ENTITY_BATCH_SIZE, [this, &enemies](int begin, int end)
+		{
+			for (int i = begin; i < end; i++)
+			{
+				for (int playerIndex = 0; playerIndex < GetNumPlayers(); playerIndex++)
+				{
+					CPlayerShip* playerShip = GetPlayerShip(playerIndex);
+					if (playerShip->IsAlive() && playerShip->CollidesWith(enemies[i]))
+					{
+						m_enemyHits[i] = SHitRecord{ enemies[i], playerShip };
+						break;
+					}
+				}
+			}
+		});
+	}
 
-					// spawn explosion
-					SpawnExplosion(CEntity::EEntityType::ENEMY, explosionPosX, explosionPosY);
+	// check what each projectile has collided against
+	m_projectileHits.assign(m_projectileArray.size(), SHitRecord());
+	jobSystem->ParallelFor(static_cast<int>(m_projectileArray.size()), ENTITY_BATCH_SIZE, [this, &enemies](int begin, int end)
+	{
+		for (int i = begin; i < end; i++)
+		{
+			m_projectileHits[i] = SHitRecord{ m_projectileArray[i], FindProjectileTarget(m_projectileArray[i], enemies) };
+		}
+	});
+}
 
-					// award the player score
-					m_score += CEnemyFormation::ENEMY_POINTS_WORTH;
+// runs on the job threads, must not change anything
+CEntity* CIngameState::FindProjectileTarget(CProjectile* projectile, const std::vector<CEnemy*>& enemies)
+{
+	if (!projectile->IsAlive())
+	{
+		return nullptr;
+	}
 
-					projectilePtr->OnCollision();
-					break; // projectile expires after first hit
-				}
-				else
-				{
-					enemyPtr = enemiesList.GetNextElement(enemyPtr);
-				}
+	// player projectiles hit enemies, or the boss
+	if (projectile->GetOwner() == CProjectile::EProjectileOwner::PLAYER)
+	{
+		for (CEnemy* enemy : enemies)
+		{
+			if (enemy->CollidesWith(projectile))
+			{
+				return enemy;
 			}
+		}
 
-			// check if a player projectile has collided against a BOSS
-			if (m_boss.IsAlive() && m_boss.CollidesWith(projectilePtr))
+		if (m_boss.IsAlive() && m_boss.CollidesWith(projectile))
+		{
+			return &m_boss;
+		}
+	}
+	else if (projectile->GetOwner() == CProjectile::EProjectileOwner::ENEMY)
+	{
+		for (int i = 0; i < GetNumPlayers(); i++)
+		{
+			CPlayerShip* playerShip = GetPlayerShip(i);
+			if (playerShip->IsAlive() && playerShip->CollidesWith(projectile))
 			{
-				// despawn the boss object
-				m_boss.Despawn();
+				return playerShip;
+			}
+		}
+	}
 
-				// spawn explosion
-				float explosionPosX = m_boss.GetPosX() + static_cast<float>(m_boss.GetSpriteWidth() / 2.0) - static_cast<float>(CExplosion::SPRITE_WIDTH / 2.0);
-				float explosionPosY = m_boss.GetPosY() + static_cast<float>(m_boss.GetSpriteHeight() / 2.0) - static_cast<float>(CExplosion::SPRITE_HEIGHT / 2.0);
-				SpawnExplosion(CEntity::EEntityType::BOSS, explosionPosX, explosionPosY);
+	return nullptr;
+}
+
+void CIngameState::ResolveCollisions()
+{
+	for (const SHitRecord& hit : m_enemyHits)
+	{
+		// the player may have died from an earlier hit
+		CPlayerShip* playerShip = static_cast<CPlayerShip*>(hit.m_target);
+		if (playerShip == nullptr || !playerShip->IsAlive())
+		{
+			continue;
+		}
+
+		// collision has occurred, is the player using the shield? if yes, destroy the enemy
+		if (playerShip->IsShieldUp())
+		{
+			DestroyEnemy(static_cast<CEnemy*>(hit.m_entity));
+		}
+		else
+		{
+			DestroyPlayerShip(playerShip);
+		}
+	}
 
-				// award the player score
-				m_score += m_boss.GetPointsWorth();
+	for (const SHitRecord& hit : m_projectileHits)
+	{
+		// an earlier hit may have destroyed the target already, the projectile flies on then
+		if (hit.m_target == nullptr || !hit.m_target->IsAlive())
+		{
+			continue;
+		}
 
-				// projectile expires after first hit
-				projectilePtr->OnCollision();
+		if (hit.m_target->GetType() == CEntity::EEntityType::ENEMY)
+		{
+			DestroyEnemy(static_cast<CEnemy*>(hit.m_target));
 
-				// update the boss spawn timer for next boss
-				m_lastBossSpawnTicks = Utils::GetTicks();
-			}
+			// award the player score
+			m_commandBuffer.AddScore(CEnemyFormation::ENEMY_POINTS_WORTH);
 		}
-		else if (m_playerShip.IsAlive() && projectilePtr->GetOwner() == CProjectile::EProjectileOwner::ENEMY) // check if an enemy projectile has collided against the player
+		else if (hit.m_target->GetType() == CEntity::EEntityType::BOSS)
 		{
-			if (m_playerShip.CollidesWith(projectilePtr))
-			{
-				if (!m_playerShip.IsShieldUp())
-				{
-					// get the player position before destroying it
-					float explosionPosX = m_playerShip.GetPosX() + static_cast<float>(CPlayerShip::SPRITE_WIDTH / 2.0) - static_cast<float>(CExplosion::SPRITE_WIDTH / 2.0);
-					float explosionPosY = m_playerShip.GetPosY() + static_cast<float>(CPlayerShip::SPRITE_HEIGHT / 2.0) - static_cast<float>(CExplosion::SPRITE_HEIGHT / 2.0);
+			DestroyBoss();
+		}
+		else if (hit.m_target->GetType() == CEntity::EEntityType::PLAYERSHIP && !static_cast<CPlayerShip*>(hit.m_target)->IsShieldUp())
+		{
+			DestroyPlayerShip(static_cast<CPlayerShip*>(hit.m_target));
+		}
+
+		// projectile expires after first hit
+		hit.m_entity->OnCollision();
+	}
+}
+
+// the entities that were hit are marked dead right away so later hits in the same update skip them, everything else
+// is queued and happens in ApplyCommands()
+void CIngameState::DestroyEnemy(CEnemy* enemy)
+{
+	enemy->SetIsAlive(false);
+
+	float explosionPosX = enemy->GetPosX() + static_cast<float>(CEnemy::SPRITE_WIDTH / 2.0) - static_cast<float>(CExplosion::SPRITE_WIDTH / 2.0);
+	float explosionPosY = enemy->GetPosY() + static_cast<float>(CEnemy::SPRITE_HEIGHT / 2.0) - static_cast<float>(CExplosion::SPRITE_HEIGHT / 2.0);
+
+	m_commandBuffer.DespawnEnemy(enemy);
+	m_commandBuffer.SpawnExplosion(CEntity::EEntityType::ENEMY, explosionPosX, explosionPosY);
+}
 
-					// spawn explosion
-					SpawnExplosion(CEntity::EEntityType::PLAYERSHIP, explosionPosX, explosionPosY);
+void CIngameState::DestroyBoss()
+{
+	m_boss.SetIsAlive(false);
+
+	float explosionPosX = m_boss.GetPosX() + static_cast<float>(m_boss.GetSpriteWidth() / 2.0) - static_cast<float>(CExplosion::SPRITE_WIDTH / 2.0);
+	float explosionPosY = m_boss.GetPosY() + static_cast<float>(m_boss.GetSpriteHeight() / 2.0) - static_cast<float>(CExplosion::SPRITE_HEIGHT / 2.0);
+
+	m_commandBuffer.DespawnBoss();
+	m_commandBuffer.SpawnExplosion(CEntity::EEntityType::BOSS, explosionPosX, explosionPosY);
+
+	// award the player score
+	m_commandBuffer.AddScore(m_boss.GetPointsWorth());
+}
+
+void CIngameState::DestroyPlayerShip(CPlayerShip* playerShip)
+{
+	// notify the playership object that it has died
+	playerShip->OnCollision();
+
+	float explosionPosX = playerShip->GetPosX() + static_cast<float>(CPlayerShip::SPRITE_WIDTH / 2.0) - static_cast<float>(CExplosion::SPRITE_WIDTH / 2.0);
+	float explosionPosY = playerShip->GetPosY() + static_cast<float>(CPlayerShip::SPRITE_HEIGHT / 2.0) - static_cast<float>(CExplosion::SPRITE_HEIGHT / 2.0);
+
+	m_commandBuffer.SpawnExplosion(CEntity::EEntityType::PLAYERSHIP, explosionPosX, explosionPosY);
+	m_commandBuffer.OnPlayerDeath();
+}
+#endif
 
-					// notify the playership object that it has died
-					m_playerShip.OnCollision();
+// the sync point of the update: everything the entities asked for is applied here, in the order it was asked for
+void CIngameState::ApplyCommands()
+{
+	// applying a command may queue more
+	while (!m_commandBuffer.IsEmpty())
+	{
+		m_commandBuffer.TakeCommands(m_commands);
+		for (const CGameCommandBuffer::SCommand& command : m_commands)
+		{
+			switch (command.m_type)
+			{
+			case CGameCommandBuffer::ECommandType::SPAWN_PROJECTILE:
+				SpawnProjectile(command.m_projectileOwner, command.m_projectileType, command.m_x, command.m_y);
+				break;
+			case CGameCommandBuffer::ECommandType::SPAWN_EXPLOSION:
+				// only for show
+				if (!m_isHeadless)
+				{
+					SpawnExplosion(command.m_entityType, command.m_x, command.m_y);
+				}
+				break;
+			case CGameCommandBuffer::ECommandType::DESPAWN_ENEMY:
+				m_enemyFormation.RemoveEnemy(command.m_enemy);
+				break;
+			case CGameCommandBuffer::ECommandType::DESPAWN_BOSS:
+				m_boss.Despawn();
 
-					OnPlayerDeath();
+				// update the boss spawn timer for next boss
+				m_lastBossSpawnTicks = m_gameClock.GetTicks();
+				break;
+			case CGameCommandBuffer::ECommandType::PLAYER_DEATH:
+				OnPlayerDeath();
+				break;
+			case CGameCommandBuffer::ECommandType::ADD_SCORE:
+				m_score += command.m_score;
+				break;
+			case CGameCommandBuffer::ECommandType::PLAY_SOUND:
+#if SOUND_ENABLED
+				if (!m_isHeadless && !m_isResimulating)
+				{
+					command.m_sound->Play(command.m_volume);
 				}
-								
-				// projectile expires after first hit
-				projectilePtr->OnCollision();
+#endif
+				break;
 			}
 		}
-#endif
+	}
+	m_commands.clear();
+}
 
+void CIngameState::RemoveDeadProjectiles()
+{
+	CProjectile* projectilePtr = m_projectilesList.GetHeadElement();
+	while (projectilePtr != nullptr)
+	{
 		// remove any of the dead projectiles from the list
 		if (projectilePtr->IsAlive())
 		{
@@ -422,6 +891,24 @@ void CIngameState::UpdateExplosions(Uint32 elapsedTime)
 }
 
 void CIngameState::UpdateText(Uint32 elapsedTime)
+{
+	// a headless game shows nothing, only the messages' timing matters
+	if (!m_isHeadless && !m_isResimulating)
+	{
+		UpdateValueTextures();
+	}
+
+	if (m_currentMessageState != EMessageState::NONE && m_gameClock.GetTicks() - m_lastMessageDisplayTicks > GetCurrentMessageDuration())
+	{
+		if (m_currentMessageState == EMessageState::GAME_OVER)
+		{
+			ReturnToIntroState();
+		}
+		RequestMessageState(EMessageState::NONE);
+	}
+}
+
+void CIngameState::UpdateValueTextures()
 {
 	// detect if any of the values has changed... if yes, update the text texture(s) - this is good to avoid re-creating the texture every frame
 
@@ -431,7 +918,7 @@ void CIngameState::UpdateText(Uint32 elapsedTime)
 	if (m_score != m_previousScore)
 	{
 		sprintf_s(buffer, "%d\0", m_score);
-		m_scoreValueTexture.CreateFromText(buffer, SDL_Color{ 255, 255, 0, 255 });
+		m_scoreValueTexture.CreateFromText(buffer, SDL_Color{ 255, 255, 0, 255 }, CTexture::EFont::REGULAR, false);
 		m_previousScore = m_score;
 		LOG_SCR_F("Updated score value texture: %d\n", m_score);
 	}
@@ -439,7 +926,7 @@ void CIngameState::UpdateText(Uint32 elapsedTime)
 	if (m_level != m_previousLevel)
 	{
 		sprintf_s(buffer, "%d\0", m_level);
-		m_levelValueTexture.CreateFromText(buffer, SDL_Color{ 255, 255, 0, 255 });
+		m_levelValueTexture.CreateFromText(buffer, SDL_Color{ 255, 255, 0, 255 }, CTexture::EFont::REGULAR, false);
 		m_previousLevel = m_level;
 		LOG_SCR_F("Updated level value texture: %d\n", m_level);
 	}
@@ -447,27 +934,25 @@ void CIngameState::UpdateText(Uint32 elapsedTime)
 	if (m_lives != m_previousLives)
 	{
 		sprintf_s(buffer, "%d\0", m_lives);
-		m_livesValueTexture.CreateFromText(buffer, SDL_Color{ 255, 255, 0, 255 });
+		m_livesValueTexture.CreateFromText(buffer, SDL_Color{ 255, 255, 0, 255 }, CTexture::EFont::REGULAR, false);
 		m_previousLives = m_lives;
 		LOG_SCR_F("Updated lives value texture: %d\n", m_lives);
 	}
-
-	if (m_currentMessageState != EMessageState::NONE && Utils::GetTicks() - m_lastMessageDisplayTicks > GetCurrentMessageDuration())
-	{
-		if (m_currentMessageState == EMessageState::GAME_OVER)
-		{
-			ReturnToIntroState();
-		}
-		RequestMessageState(EMessageState::NONE);
-	}
 }
 
 void CIngameState::Draw()
 {
-	if (m_currentState == EState::PLAYING || m_currentState == EState::PLAYER_DEATH_COOLDOWN)
+	if (m_currentState == EState::LOADING)
+	{
+		m_services->m_renderThread->DrawProgressBar(m_services->m_assetLoader->GetProgress());
+	}
+	else if (m_currentState == EState::PLAYING || m_currentState == EState::PLAYER_DEATH_COOLDOWN)
 	{
 		m_starfield.Draw();
-		m_playerShip.Draw();
+		for (int i = 0; i < GetNumPlayers(); i++)
+		{
+			GetPlayerShip(i)->Draw();
+		}
 		DrawEnemies();
 		DrawProjectiles();
 		DrawExplosions();		
@@ -503,7 +988,7 @@ void CIngameState::DrawExplosions()
 
 void CIngameState::DrawMessage(CTexture* texture)
 {
-	texture->Draw((CApp::GetInstance()->GetScreenWidth() - texture->GetWidth()) / 2, (CApp::GetInstance()->GetScreenHeight() - texture->GetHeight()) / 2);
+	texture->Draw((m_services->m_screenWidth - texture->GetWidth()) / 2, (m_services->m_screenHeight - texture->GetHeight()) / 2);
 }
 
 void CIngameState::DrawText()
@@ -516,11 +1001,11 @@ void CIngameState::DrawText()
 	m_livesValueTexture.Draw(LABEL_LIVES_VALUE_POSX, LABELS_POSY);
 	if (IsBossNullifyingPlayerShield())
 	{
-		m_shieldNullifiedLabelTexture.Draw(CApp::GetInstance()->GetScreenWidth() - LABEL_BOSS_EFFECT_POSX_OFFSET - m_shieldNullifiedLabelTexture.GetWidth(), LABELS_POSY);
+		m_shieldNullifiedLabelTexture.Draw(m_services->m_screenWidth - LABEL_BOSS_EFFECT_POSX_OFFSET - m_shieldNullifiedLabelTexture.GetWidth(), LABELS_POSY);
 	}
 	else if (IsBossMakingEnemiesShootDiagonally())
 	{
-		m_enemiesEnhancedLabelTexture.Draw(CApp::GetInstance()->GetScreenWidth() - LABEL_BOSS_EFFECT_POSX_OFFSET - m_enemiesEnhancedLabelTexture.GetWidth(), LABELS_POSY);
+		m_enemiesEnhancedLabelTexture.Draw(m_services->m_screenWidth - LABEL_BOSS_EFFECT_POSX_OFFSET - m_enemiesEnhancedLabelTexture.GetWidth(), LABELS_POSY);
 	}
 
 	if (m_currentMessageState == EMessageState::GET_READY)
@@ -535,31 +1020,33 @@ void CIngameState::DrawText()
 	{
 		DrawMessage(&m_gameOverMessageTexture);
 	}
+	else if (m_isPaused)
+	{
+		DrawMessage(&m_pausedMessageTexture);
+	}
 }
 
 void CIngameState::InitPlayer()
 {
-	// load gfx
-	if (m_playerShipSheetTexture.CreateFromFile(TEXTURE_PLAYERSHIP_SPRITESHEET_FILENAME))
-	{	
-		LOG_SCR("Playership texture created");
-
-		// create ship
+	// the gfx were loaded by the asset loader
+	if (m_playerShipSheetTexture.IsCreated())
+	{
+		// create ships, the second one only plays in a two player game
 		m_playerShip.Init(&m_playerShipSheetTexture);
+		m_secondPlayerShip.Init(&m_playerShipSheetTexture);
 
 #if SOUND_ENABLED
 		m_playerShip.InitSound(&m_playerShootSound, &m_playerShieldSound, &m_playerShieldNullifiedSound);
+		m_secondPlayerShip.InitSound(&m_playerShootSound, &m_playerShieldSound, &m_playerShieldNullifiedSound);
 #endif
 	}	
 }
 
 void CIngameState::InitEnemies()
 {
-	// load gfx
-	if (m_enemySpriteSheetTexture.CreateFromFile(TEXTURE_ENEMY_SPRITESHEET_FILENAME))
+	// the gfx were loaded by the asset loader
+	if (m_enemySpriteSheetTexture.IsCreated())
 	{
-		LOG_SCR("Enemies texture created");
-
 		// regular enemies
 		m_enemyFormation.InitTexture(&m_enemySpriteSheetTexture);
 #if SOUND_ENABLED
@@ -571,16 +1058,18 @@ void CIngameState::InitEnemies()
 #if SOUND_ENABLED
 		m_boss.InitSound(&m_bossSpawnSound, &m_bossNullifySound, &m_bossEnhanceSound);
 #endif
-		m_lastBossSpawnTicks = Utils::GetTicks();
 	}
 }
 
 void CIngameState::InitProjectiles()
 {
-	// load gfx
-	if (m_projectilesSheetTexture.CreateFromFile(TEXTURE_PROJECTILES_SPRITESHEET_FILENAME))
+	// the gfx were loaded by the asset loader
+	if (m_projectilesSheetTexture.IsCreated())
 	{
-		LOG_SCR("Projectiles texture created");
+		// pre-render the enemy projectile at the angles diagonal projectiles can be fired at
+		const SAnimationDef& animDef = CProjectile::GetAnimationDef(CProjectile::EAnimID::ENEMY_IDLE);
+		SDL_Rect firstFrameRect{ animDef.m_startPosX, animDef.m_startPosY, CProjectile::ENEMY_PROJECTILE_SPRITE_WIDTH, CProjectile::ENEMY_PROJECTILE_SPRITE_HEIGHT };
+		m_rotatedEnemyProjectilesSheet.Create(&m_projectilesSheetTexture, firstFrameRect, animDef.m_numFrames, CProjectile::ROTATED_SPRITESHEET_ANGLE_STEPS);
 	}
 }
 
@@ -599,6 +1088,7 @@ void CIngameState::InitText()
 	m_getReadyMessageTexture.CreateFromText(MESSAGE_GET_READY_TEXT, MESSAGE_GET_READY_COLOR, CTexture::EFont::BIG);
 	m_successMessageTexture.CreateFromText(MESSAGE_SUCCESS_TEXT, MESSAGE_SUCCESS_COLOR, CTexture::EFont::BIG);
 	m_gameOverMessageTexture.CreateFromText(MESSAGE_GAMEOVER_TEXT, MESSAGE_GAMEOVER_COLOR, CTexture::EFont::BIG);
+	m_pausedMessageTexture.CreateFromText(MESSAGE_PAUSED_TEXT, MESSAGE_PAUSED_COLOR, CTexture::EFont::BIG);
 }
 
 void CIngameState::DestroyPlayer()
@@ -618,6 +1108,15 @@ void CIngameState::DestroyEnemies()
 }
 
 void CIngameState::DestroyProjectiles()
+{
+	ClearProjectiles();
+
+	m_rotatedEnemyProjectilesSheet.Destroy();
+	m_projectilesSheetTexture.Destroy();
+	LOG_SCR("Projectiles texture destroyed");
+}
+
+void CIngameState::ClearProjectiles()
 {
 	CProjectile* projectilePtr = m_projectilesList.GetHeadElement();
 	while (projectilePtr != nullptr)
@@ -627,13 +1126,23 @@ void CIngameState::DestroyProjectiles()
 		delete projectilePtr;
 		projectilePtr = nextElement;
 	}
+}
 
-	m_projectilesSheetTexture.Destroy();
-	LOG_SCR("Projectiles texture destroyed");
+void CIngameState::ClearExplosions()
+{
+	CExplosion* explosionPtr = m_explosionsList.GetHeadElement();
+	while (explosionPtr != nullptr)
+	{
+		CExplosion* nextElement = m_explosionsList.RemoveElement(explosionPtr);
+		LOG_SCR_F("Deleting explosion %d\n", (int)(size_t)explosionPtr);
+		delete explosionPtr;
+		explosionPtr = nextElement;
+	}
 }
 
 void CIngameState::DestroyText()
 {
+	m_pausedMessageTexture.Destroy();
 	m_gameOverMessageTexture.Destroy();
 	m_successMessageTexture.Destroy();
 	m_getReadyMessageTexture.Destroy();
@@ -649,7 +1158,9 @@ void CIngameState::SpawnProjectile(CProjectile::EProjectileOwner owner, CProject
 {
 	// create projectile
 	CProjectile* newProjectile = new CProjectile();
+	newProjectile->SetIngameState(this);
 	newProjectile->Init(owner, projectileType, &m_projectilesSheetTexture, x, y);
+	newProjectile->SetRotatedSpriteSheet(&m_rotatedEnemyProjectilesSheet);
 
 	// add projectile to linked list	
 	m_projectilesList.AddElement(newProjectile);
@@ -661,6 +1172,7 @@ void CIngameState::SpawnExplosion(CEntity::EEntityType entityType, float x, floa
 {
 	// create explosion
 	CExplosion* newExplosion = new CExplosion;
+	newExplosion->SetIngameState(this);
 
 	// determine what sound, lifetime and animId to play
 	bool isBigExplosion = entityType == CEntity::EEntityType::PLAYERSHIP || entityType == CEntity::EEntityType::BOSS;
@@ -673,7 +1185,10 @@ void CIngameState::SpawnExplosion(CEntity::EEntityType entityType, float x, floa
 
 	newExplosion->Init(&m_projectilesSheetTexture, animId, explosionLifetimeMs);
 #if SOUND_ENABLED
-	newExplosion->InitSound(sound);
+	if (!m_isResimulating)
+	{
+		newExplosion->InitSound(sound);
+	}
 #endif
 	newExplosion->SetPosition(x, y);
 
@@ -683,8 +1198,236 @@ void CIngameState::SpawnExplosion(CEntity::EEntityType entityType, float x, floa
 	LOG_SCR_F("Spawned an explosion: %d\n", (int)(size_t)newExplosion);
 }
 
+void CIngameState::WriteObservation(SPlayfieldObservation* observation, bool includeOccupancy)
+{
+	observation->m_version = SPlayfieldObservation::VERSION;
+	observation->m_sizeInBytes = sizeof(SPlayfieldObservation);
+
+	observation->m_score = m_score;
+	observation->m_level = m_level;
+	observation->m_lives = m_lives;
+	observation->m_state = static_cast<Uint32>(m_currentState);
+
+	observation->m_numPlayers = GetNumPlayers();
+	for (int i = 0; i < MAX_PLAYERS; i++)
+	{
+		CPlayerShip* playerShip = GetPlayerShip(i);
+		bool isPlaying = i < GetNumPlayers();
+		observation->m_playerPosX[i] = isPlaying ? playerShip->GetCenterPointX() : 0.0f;
+		observation->m_playerPosY[i] = isPlaying ? playerShip->GetCenterPointY() : 0.0f;
+		observation->m_isPlayerAlive[i] = isPlaying && playerShip->IsAlive();
+		observation->m_isShieldUp[i] = isPlaying && playerShip->IsShieldUp();
+	}
+	observation->m_isShieldNullified = IsBossNullifyingPlayerShield();
+	observation->m_areEnemiesEnhanced = IsBossMakingEnemiesShootDiagonally();
+	observation->m_unusedPlayers = 0;
+
+	observation->m_bossPosX = m_boss.GetCenterPointX();
+	observation->m_bossPosY = m_boss.GetCenterPointY();
+	observation->m_isBossAlive = m_boss.IsAlive();
+	observation->m_bossType = static_cast<Uint8>(m_boss.GetBossType());
+	observation->m_bossState = static_cast<Uint8>(m_boss.GetState());
+	observation->m_unused = 0;
+
+	observation->m_hasOccupancy = includeOccupancy;
+	if (includeOccupancy)
+	{
+		observation->ClearOccupancy();
+		for (int i = 0; i < GetNumPlayers(); i++)
+		{
+			if (GetPlayerShip(i)->IsAlive())
+			{
+				observation->MarkOccupancy(GetPlayerShip(i)->GetRect(), SPlayfieldObservation::OCCUPANCY_PLAYER);
+			}
+		}
+		if (m_boss.IsAlive())
+		{
+			observation->MarkOccupancy(m_boss.GetRect(), SPlayfieldObservation::OCCUPANCY_BOSS);
+		}
+	}
+
+	Uint32 numEnemies = 0;
+	CDoubleLinkedList<CEnemy*>& enemies = m_enemyFormation.GetEntities();
+	CEnemy* enemyPtr = enemies.GetHeadElement();
+	while (enemyPtr != nullptr && numEnemies < SPlayfieldObservation::MAX_ENEMIES)
+	{
+		observation->m_enemyPosX[numEnemies] = enemyPtr->GetCenterPointX();
+		observation->m_enemyPosY[numEnemies] = enemyPtr->GetCenterPointY();
+		observation->m_enemyRow[numEnemies] = enemyPtr->GetSpot().m_row;
+		observation->m_enemyColumn[numEnemies] = enemyPtr->GetSpot().m_column;
+		observation->m_enemyCanAttack[numEnemies] = enemyPtr->CanAttack();
+		if (includeOccupancy)
+		{
+			observation->MarkOccupancy(enemyPtr->GetRect(), SPlayfieldObservation::OCCUPANCY_ENEMY);
+		}
+
+		numEnemies++;
+		enemyPtr = enemies.GetNextElement(enemyPtr);
+	}
+	observation->m_numEnemies = numEnemies;
+
+	Uint32 numProjectiles = 0;
+	CProjectile* projectilePtr = m_projectilesList.GetHeadElement();
+	while (projectilePtr != nullptr && numProjectiles < SPlayfieldObservation::MAX_PROJECTILES)
+	{
+		bool isPlayerProjectile = projectilePtr->GetOwner() == CProjectile::EProjectileOwner::PLAYER;
+		observation->m_projectilePosX[numProjectiles] = projectilePtr->GetCenterPointX();
+		observation->m_projectilePosY[numProjectiles] = projectilePtr->GetCenterPointY();
+		observation->m_projectileVelocityX[numProjectiles] = projectilePtr->GetVelocityX();
+		observation->m_projectileVelocityY[numProjectiles] = projectilePtr->GetVelocityY();
+		observation->m_projectileOwner[numProjectiles] = static_cast<Uint8>(projectilePtr->GetOwner());
+		if (includeOccupancy)
+		{
+			observation->MarkOccupancy(projectilePtr->GetRect(), isPlayerProjectile ? SPlayfieldObservation::OCCUPANCY_PLAYER_PROJECTILE : SPlayfieldObservation::OCCUPANCY_ENEMY_PROJECTILE);
+		}
+
+		numProjectiles++;
+		projectilePtr = m_projectilesList.GetNextElement(projectilePtr);
+	}
+	observation->m_numProjectiles = numProjectiles;
+}
+
+bool CIngameState::SaveSnapshot(SSnapshot* snapshot)
+{
+	// nothing may be half done
+	assert(m_commandBuffer.IsEmpty());
+
+	snapshot->m_currentState = m_currentState;
+	snapshot->m_requestedState = m_requestedState;
+	snapshot->m_currentMessageState = m_currentMessageState;
+	snapshot->m_requestedMessageState = m_requestedMessageState;
+	snapshot->m_gameTicks = m_gameClock.GetTicks();
+	snapshot->m_lastBossSpawnTicks = m_lastBossSpawnTicks;
+	snapshot->m_lastMessageDisplayTicks = m_lastMessageDisplayTicks;
+	snapshot->m_score = m_score;
+	snapshot->m_level = m_level;
+	snapshot->m_lives = m_lives;
+	snapshot->m_randomState = m_random.GetState();
+
+	m_starfield.SaveState(&snapshot->m_starfield);
+	m_playerShip.SaveState(&snapshot->m_playerShip);
+	m_secondPlayerShip.SaveState(&snapshot->m_secondPlayerShip);
+	m_boss.SaveState(&snapshot->m_boss);
+	m_enemyFormation.SaveState(&snapshot->m_enemyFormation);
+
+	int numProjectiles = 0;
+	CProjectile* projectilePtr = m_projectilesList.GetHeadElement();
+	while (projectilePtr != nullptr)
+	{
+		if (numProjectiles == SSnapshot::MAX_PROJECTILES)
+		{
+			LOG_SCR("Unable to save snapshot: too many projectiles");
+			return false;
+		}
+		projectilePtr->SaveState(&snapshot->m_projectiles[numProjectiles++]);
+		projectilePtr = m_projectilesList.GetNextElement(projectilePtr);
+	}
+	snapshot->m_numProjectiles = numProjectiles;
+
+	int numExplosions = 0;
+	CExplosion* explosionPtr = m_explosionsList.GetHeadElement();
+	while (explosionPtr != nullptr)
+	{
+		if (numExplosions == SSnapshot::MAX_EXPLOSIONS)
+		{
+			LOG_SCR("Unable to save snapshot: too many explosions");
+			return false;
+		}
+		explosionPtr->SaveState(&snapshot->m_explosions[numExplosions++]);
+		explosionPtr = m_explosionsList.GetNextElement(explosionPtr);
+	}
+	snapshot->m_numExplosions = numExplosions;
+
+	return true;
+}
+
+void CIngameState::RestoreSnapshot(const SSnapshot& snapshot)
+{
+	assert(m_commandBuffer.IsEmpty());
+
+	m_currentState = snapshot.m_currentState;
+	m_requestedState = snapshot.m_requestedState;
+	m_currentMessageState = snapshot.m_currentMessageState;
+	m_requestedMessageState = snapshot.m_requestedMessageState;
+	m_gameClock.SetTicks(snapshot.m_gameTicks);
+	m_lastBossSpawnTicks = snapshot.m_lastBossSpawnTicks;
+	m_lastMessageDisplayTicks = snapshot.m_lastMessageDisplayTicks;
+	m_score = snapshot.m_score;
+	m_level = snapshot.m_level;
+	m_lives = snapshot.m_lives;
+	m_random.SetState(snapshot.m_randomState);
+
+	m_starfield.RestoreState(snapshot.m_starfield);
+	m_playerShip.RestoreState(snapshot.m_playerShip);
+	m_secondPlayerShip.RestoreState(snapshot.m_secondPlayerShip);
+	m_boss.RestoreState(snapshot.m_boss);
+	m_enemyFormation.RestoreState(snapshot.m_enemyFormation);
+	RestoreProjectiles(snapshot);
+	RestoreExplosions(snapshot);
+
+	// they point at entities that may be gone, rebuilt by the next update
+	m_projectileArray.clear();
+	m_enemyHits.clear();
+	m_projectileHits.clear();
+}
+
+// the projectiles there are take the saved ones in list order, new ones are only created if there are not enough
+void CIngameState::RestoreProjectiles(const SSnapshot& snapshot)
+{
+	CProjectile* projectilePtr = m_projectilesList.GetHeadElement();
+	for (int i = 0; i < snapshot.m_numProjectiles; i++)
+	{
+		if (projectilePtr == nullptr)
+		{
+			projectilePtr = new CProjectile();
+			projectilePtr->SetIngameState(this);
+			projectilePtr->SetRotatedSpriteSheet(&m_rotatedEnemyProjectilesSheet);
+			m_projectilesList.AddElement(projectilePtr);
+		}
+		projectilePtr->RestoreState(&m_projectilesSheetTexture, snapshot.m_projectiles[i]);
+		projectilePtr = m_projectilesList.GetNextElement(projectilePtr);
+	}
+
+	// the ones left over were not there yet
+	while (projectilePtr != nullptr)
+	{
+		CProjectile* nextElement = m_projectilesList.RemoveElement(projectilePtr);
+		delete projectilePtr;
+		projectilePtr = nextElement;
+	}
+}
+
+void CIngameState::RestoreExplosions(const SSnapshot& snapshot)
+{
+	CExplosion* explosionPtr = m_explosionsList.GetHeadElement();
+	for (int i = 0; i < snapshot.m_numExplosions; i++)
+	{
+		if (explosionPtr == nullptr)
+		{
+			explosionPtr = new CExplosion();
+			explosionPtr->SetIngameState(this);
+			m_explosionsList.AddElement(explosionPtr);
+		}
+		explosionPtr->RestoreState(&m_projectilesSheetTexture, snapshot.m_explosions[i]);
+		explosionPtr = m_explosionsList.GetNextElement(explosionPtr);
+	}
+
+	while (explosionPtr != nullptr)
+	{
+		CExplosion* nextElement = m_explosionsList.RemoveElement(explosionPtr);
+		delete explosionPtr;
+		explosionPtr = nextElement;
+	}
+}
+
 void CIngameState::OnPlayerDeath()
 {
+	// both ships of a two player game can be lost in the same update
+	if (m_lives == 0)
+	{
+		return;
+	}
+
 	m_lives--;
 	if (m_lives == 0)
 	{
@@ -695,8 +1438,11 @@ void CIngameState::OnPlayerDeath()
 		// speed up starfield speed
 		m_starfield.StartAnimation();
 
-		// request state
-		RequestState(EState::PLAYER_DEATH_COOLDOWN);
+		// request state, the other player may have died just before
+		if (m_currentState != EState::PLAYER_DEATH_COOLDOWN && m_requestedState != EState::PLAYER_DEATH_COOLDOWN)
+		{
+			RequestState(EState::PLAYER_DEATH_COOLDOWN);
+		}
 	}
 }
 
@@ -707,7 +1453,7 @@ void CIngameState::OnEnemyFormationPositionRestarted()
 void CIngameState::OnBossLeave()
 {
 	// update the timer to wait for the next boss
-	m_lastBossSpawnTicks = Utils::GetTicks();
+	m_lastBossSpawnTicks = m_gameClock.GetTicks();
 }
 
 void CIngameState::OnAllEnemiesDead()
@@ -758,7 +1504,7 @@ void CIngameState::HandleLevelCompletion()
 	m_enemyFormation.Spawn();
 
 	// reset the boss spawn timer
-	m_lastBossSpawnTicks = Utils::GetTicks();
+	m_lastBossSpawnTicks = m_gameClock.GetTicks();
 }
 
 float CIngameState::GetCurrentDifficultyMultiplier()
@@ -768,7 +1514,13 @@ float CIngameState::GetCurrentDifficultyMultiplier()
 
 void CIngameState::ReturnToIntroState()
 {
-	CApp::GetInstance()->GetGameManager()->RequestState(CGameManager::EGameState::INTRO);
+	// a headless game is not run by the game manager, whoever runs it restarts it once it is over
+	if (m_isHeadless)
+	{
+		return;
+	}
+
+	m_services->m_gameManager->RequestState(CGameManager::EGameState::INTRO);
 }
 
 #if DEBUG_DRAW
@@ -778,18 +1530,18 @@ void CIngameState::DrawDebug()
 	
 	// draw edges where enemies can move
 	SDL_Color enemyEdgesColor{ 255, 255, 255, 255 };
-	CApp::GetInstance()->DrawLine(ENEMY_MOVE_LIMIT, 0, ENEMY_MOVE_LIMIT, CApp::GetInstance()->GetScreenHeight(), enemyEdgesColor);
-	int x = CApp::GetInstance()->GetScreenWidth() - ENEMY_MOVE_LIMIT;
-	CApp::GetInstance()->DrawLine(x, 0, x, CApp::GetInstance()->GetScreenHeight(), enemyEdgesColor);
+	m_services->m_renderThread->DrawLine(ENEMY_MOVE_LIMIT, 0, ENEMY_MOVE_LIMIT, m_services->m_screenHeight, enemyEdgesColor);
+	int x = m_services->m_screenWidth - ENEMY_MOVE_LIMIT;
+	m_services->m_renderThread->DrawLine(x, 0, x, m_services->m_screenHeight, enemyEdgesColor);
 
 	// draw Y limit to where player can move
 	SDL_Color playerLimitColor{ 0, 128, 0, 255 };
-	CApp::GetInstance()->DrawLine(0, CPlayerShip::MOVE_LIMIT_Y, CApp::GetInstance()->GetScreenWidth(), CPlayerShip::MOVE_LIMIT_Y, playerLimitColor);
+	m_services->m_renderThread->DrawLine(0, CPlayerShip::MOVE_LIMIT_Y, m_services->m_screenWidth, CPlayerShip::MOVE_LIMIT_Y, playerLimitColor);
 
 	// draw boss spawn y-position bounds
 	SDL_Color bossSpawnBoundsColor{ 128, 0, 0, 255 };
-	CApp::GetInstance()->DrawLine(0, CBoss::BOSS_SPAWN_Y_LBOUND, CApp::GetInstance()->GetScreenWidth(), CBoss::BOSS_SPAWN_Y_LBOUND, bossSpawnBoundsColor);
-	CApp::GetInstance()->DrawLine(0, CBoss::BOSS_SPAWN_Y_UBOUND, CApp::GetInstance()->GetScreenWidth(), CBoss::BOSS_SPAWN_Y_UBOUND, bossSpawnBoundsColor);
+	m_services->m_renderThread->DrawLine(0, CBoss::BOSS_SPAWN_Y_LBOUND, m_services->m_screenWidth, CBoss::BOSS_SPAWN_Y_LBOUND, bossSpawnBoundsColor);
+	m_services->m_renderThread->DrawLine(0, CBoss::BOSS_SPAWN_Y_UBOUND, m_services->m_screenWidth, CBoss::BOSS_SPAWN_Y_UBOUND, bossSpawnBoundsColor);
 	
 #endif
 }
@@ -5,18 +5,26 @@
 *************************************************************************************/
 
 #include "boss.h"
+#include "clock.h"
 #include "doublelinkedlist.h"
 #include "enemyformation.h"
 #include "explosion.h"
+#include "gamecommandbuffer.h"
 #include "gamestate.h"
+#include "loopbacktransport.h"
 #include "projectile.h"
 #include "playership.h"
+#include "playfieldobservation.h"
 #include "preproc.h"
+#include "random.h"
 #if SOUND_ENABLED
 #include "sound.h"
 #endif
 #include "starfield.h"
 #include <string>
+#include <vector>
+
+class CRollbackSession;
 
 class CIngameState : public CGameState
 {
@@ -24,6 +32,7 @@ public:
 	enum class EState : int
 	{
 		UNASSIGNED,
+		LOADING,
 		PLAYING,
 		PLAYER_DEATH_COOLDOWN
 	};
@@ -37,21 +46,42 @@ public:
 		MISSION_SUCCESSFUL
 	};
 
+	CIngameState(const SServices* services);
+
+	// a two player game has a second ship, controlled from the other half of the keyboard
+	static const int MAX_PLAYERS = 2;
+
 	void Init();
 	void CleanUp();
+	void Enter() override;
+	void Exit() override;
+
+	void Preload() override;
+	void UpdatePreload() override;
+	bool IsLoading() override { return m_currentState == EState::LOADING; }
+	void OnRenderTargetsReset() override;
+
+	// a game without graphics or sound, e.g. one of the environments of the env runner. nothing is loaded and nothing
+	// is drawn, the game starts with Enter() like any other. the services only need the job system
+	void InitHeadless(Uint64 seed);
+	bool IsHeadless() { return m_isHeadless; }
 
 	void HandleKeyDownInput(SDL_KeyboardEvent* kbEvent);
 	void HandleKeyUpInput(SDL_KeyboardEvent* kbEvent);
 
 	void InitValues();
+	void QueueTextures();
 #if SOUND_ENABLED
-	void InitSounds();
+	void QueueSounds();
 #endif
 	void InitPlayer();
 	void InitEnemies();
 	void InitProjectiles();
 	void InitExplosions();
 	void InitText();
+	void WarmUp();
+	void ResetGame();
+	void StartGame();
 
 #if SOUND_ENABLED
 	void DestroySounds();
@@ -60,12 +90,26 @@ public:
 	void DestroyEnemies();
 	void DestroyProjectiles();
 	void DestroyText();
+	void ClearProjectiles();
+	void ClearExplosions();
 
 	void Update(Uint32 elapsedTime);
+
+	// one step of the game. Update() runs it once per frame, or leaves it to the rollback session in a two player game
+	void Tick(Uint32 elapsedTime);
+
+	void UpdateEntities(Uint32 elapsedTime);
 	void UpdateEnemies(Uint32 elapsedTime);
 	void UpdateProjectiles(Uint32 elapsedTime);
+#if COLLISIONS_ENABLED
+	void DetectCollisions();
+	void ResolveCollisions();
+#endif
+	void ApplyCommands();
+	void RemoveDeadProjectiles();
 	void UpdateExplosions(Uint32 elapsedTime);
 	void UpdateText(Uint32 elapsedTime);
+	void UpdateValueTextures();
 
 	void Draw();
 	void DrawEnemies();
@@ -76,11 +120,46 @@ public:
 	void SpawnProjectile(CProjectile::EProjectileOwner, CProjectile::EProjectileType projectileType, float x, float y);
 	void SpawnExplosion(CEntity::EEntityType entityType, float x, float y);
 
-	CPlayerShip* GetPlayerShip() { return &m_playerShip; }
+	CPlayerShip* GetPlayerShip(int playerIndex = 0) { return playerIndex == 0 ? &m_playerShip : &m_secondPlayerShip; }
+	int GetNumPlayers() { return m_isTwoPlayerGame ? MAX_PLAYERS : 1; }
 	CBoss* GetBoss() { return &m_boss; }
 	CStarfield* GetStarfield() { return &m_starfield; }
+	CEnemyFormation* GetEnemyFormation() { return &m_enemyFormation; }
+	CGameCommandBuffer* GetCommandBuffer() { return &m_commandBuffer; }
+	CRandom* GetRandom() { return &m_random; }
+	const SServices* GetServices() { return m_services; }
 	EState GetState() { return m_currentState; }
 
+	// a paused game is drawn but not updated. fast-forward runs several ticks per update
+	void TogglePause() { m_isPaused = !m_isPaused; }
+	bool IsPaused() { return m_isPaused; }
+	void ToggleFastForward() { m_isFastForwarding = !m_isFastForwarding; }
+
+	// replaces the keyboard input, e.g. with the action of an AI
+	void SetInput(const CPlayerShip::SInputData& inputData) { m_playerShip.SetInputData(inputData); }
+	void SetPlayerInput(int playerIndex, const CPlayerShip::SInputData& inputData) { GetPlayerShip(playerIndex)->SetInputData(inputData); }
+
+	// set while the rollback session runs frames again that were run already, their sounds were heard and the
+	// text was updated the first time
+	void SetIsResimulating(bool isResimulating) { m_isResimulating = isResimulating; }
+
+	int GetScore() { return m_score; }
+	int GetLevel() { return m_level; }
+	int GetLives() { return m_lives; }
+	bool IsGameOver() { return m_lives == 0; }
+
+	// fills in the observation of this tick, allocates nothing. the occupancy raster costs a bit more, it is only
+	// written if asked for
+	void WriteObservation(SPlayfieldObservation* observation, bool includeOccupancy);
+
+	// the whole simulation as plain values (defined below): the game, the entities, the starfield, the timers and the
+	// random numbers. cheap enough to take and restore every tick, e.g. for rollback or tree search, and it can be
+	// copied around or written to a file as is. only between two updates, never during one. restoring reuses the
+	// entities there are, the pointers to them do not survive it. returns false if the game does not fit
+	struct SSnapshot;
+	bool SaveSnapshot(SSnapshot* snapshot);
+	void RestoreSnapshot(const SSnapshot& snapshot);
+
 	void OnPlayerDeath();
 	void OnEnemyFormationPositionRestarted();
 	void OnBossLeave();
@@ -102,7 +181,7 @@ public:
 #endif
 
 private:
-	const EState INITIAL_STATE = EState::PLAYING;
+	const EState INITIAL_STATE = EState::LOADING;
 	const EMessageState INITIAL_MESSAGE_STATE = EMessageState::GET_READY;
 
 	// gameplay
@@ -137,6 +216,16 @@ private:
 	const Uint32 BOSS_SPAWN_INTERVAL_MS = 12000; // when does the next boss spawn after game start or last boss' death
 	const Uint32 BOSS_SPAWN_MINIMUM_ENEMIES = 8; // boss can spawn if there are this amount of enemies or more
 
+	// two player game: the ships spawn side by side, the second player's input arrives as if over the network
+	const float TWO_PLAYER_SPAWN_OFFSET_X = 100.0f;
+	const Uint32 TWO_PLAYER_LOOPBACK_JITTER_MS = 10;
+
+	// ticks of the usual length, each one no further than usual for the collisions
+	const int FAST_FORWARD_TICKS_PER_UPDATE = 4;
+
+	// entities per job when updating / checking collisions in parallel
+	const int ENTITY_BATCH_SIZE = 32;
+
 	// explosion
 	const Uint32 PLAYER_EXPLOSION_LIFETIME_MS = 1654;
 	const Uint32 ENEMY_EXPLOSION_LIFETIME_MS = 580;
@@ -162,6 +251,11 @@ private:
 	const std::string SOUND_BOSS_NULLIFY_FILENAME = "boss-nullify.wav";
 	const std::string SOUND_BOSS_ENHANCE_FILENAME = "boss-enhance.wav";
 
+	// the whole formation can shoot or die in the same moment, a few overlapping instances sound the same
+	const int SOUND_MUSIC_MAX_VOICES = 1;
+	const int SOUND_ENEMY_PROJECTILE_MAX_VOICES = 3;
+	const int SOUND_ENEMY_EXPLOSION_MAX_VOICES = 3;
+
 	// messages
 	const std::string MESSAGE_GET_READY_TEXT = "GET READY!";
 	const SDL_Color MESSAGE_GET_READY_COLOR{ 255, 255, 0, 255 };
@@ -171,54 +265,97 @@ private:
 	const SDL_Color MESSAGE_SUCCESS_COLOR{ 0, 255, 0, 255 };
 	const Uint32 MESSAGE_SUCCESS_DURATION_MS = 1000;
 
+	const std::string MESSAGE_PAUSED_TEXT = "PAUSED";
+	const SDL_Color MESSAGE_PAUSED_COLOR{ 255, 255, 0, 255 };
+
 	const std::string MESSAGE_GAMEOVER_TEXT = "GAME OVER";
 	const SDL_Color MESSAGE_GAMEOVER_COLOR{ 255, 0, 0, 255 };
 	const Uint32 MESSAGE_GAMEOVER_DURATION_MS = 5000;
 
+	// what an entity ran into, found by the collision jobs and applied afterwards on the main thread
+	struct SHitRecord
+	{
+		CEntity* m_entity = nullptr;
+		CEntity* m_target = nullptr; // nullptr if it did not hit anything
+	};
+
 	void RequestState(EState state);
 	void RequestMessageState(EMessageState state);
 
+	void HandleSecondPlayerKey(SDL_Scancode scancode, Uint8 value);
+	void UpdateTwoPlayerGame(Uint32 elapsedTime);
+
+#if COLLISIONS_ENABLED
+	CEntity* FindProjectileTarget(CProjectile* projectile, const std::vector<CEnemy*>& enemies);
+	void DestroyEnemy(CEnemy* enemy);
+	void DestroyBoss();
+	void DestroyPlayerShip(CPlayerShip* playerShip);
+#endif
+
 	void DrawMessage(CTexture* texture);
 	Uint32 GetCurrentMessageDuration();
 
 	void ReturnToIntroState();
 
+	void RestoreProjectiles(const SSnapshot& snapshot);
+	void RestoreExplosions(const SSnapshot& snapshot);
+
 	bool IsLevelComplete();
 	void HandleLevelCompletion();
 
+	// the game's own clock, advanced by every Tick(). everything the game owns gets it as its clock service, so the
+	// gameplay timers play out the same paused, fast-forwarded or stepped as fast as a headless game can go
+	CClock m_gameClock;
+	SServices m_gameServices;
+
 	CStarfield m_starfield;
 	CPlayerShip m_playerShip;
+	CPlayerShip m_secondPlayerShip;
 	CEnemyFormation m_enemyFormation;
 	CDoubleLinkedList<CProjectile*> m_projectilesList;
 	CDoubleLinkedList<CExplosion*> m_explosionsList;
 	CBoss m_boss;
 
-	CTexture m_playerShipSheetTexture;
-	CTexture m_enemySpriteSheetTexture;
-	CTexture m_projectilesSheetTexture;
-	CTexture m_scoreLabelTexture;
-	CTexture m_scoreValueTexture;
-	CTexture m_levelLabelTexture;
-	CTexture m_levelValueTexture;
-	CTexture m_livesLabelTexture;
-	CTexture m_livesValueTexture;
-	CTexture m_shieldNullifiedLabelTexture;
-	CTexture m_enemiesEnhancedLabelTexture;
-	CTexture m_getReadyMessageTexture;
-	CTexture m_successMessageTexture;
-	CTexture m_gameOverMessageTexture;
+	// rebuilt every update, the job threads need indexed access. one hit record per enemy / projectile
+	std::vector<CProjectile*> m_projectileArray;
+	std::vector<SHitRecord> m_enemyHits;
+	std::vector<SHitRecord> m_projectileHits;
+
+	// spawns, despawns, score and sounds requested during the update, applied in ApplyCommands()
+	CGameCommandBuffer m_commandBuffer;
+	std::vector<CGameCommandBuffer::SCommand> m_commands;
+
+	// every random decision of the game comes from here
+	CRandom m_random;
+
+	CTexture m_playerShipSheetTexture{ &m_gameServices };
+	CTexture m_enemySpriteSheetTexture{ &m_gameServices };
+	CTexture m_projectilesSheetTexture{ &m_gameServices };
+	CRotatedSpriteSheet m_rotatedEnemyProjectilesSheet{ &m_gameServices };
+	CTexture m_scoreLabelTexture{ &m_gameServices };
+	CTexture m_scoreValueTexture{ &m_gameServices };
+	CTexture m_levelLabelTexture{ &m_gameServices };
+	CTexture m_levelValueTexture{ &m_gameServices };
+	CTexture m_livesLabelTexture{ &m_gameServices };
+	CTexture m_livesValueTexture{ &m_gameServices };
+	CTexture m_shieldNullifiedLabelTexture{ &m_gameServices };
+	CTexture m_enemiesEnhancedLabelTexture{ &m_gameServices };
+	CTexture m_getReadyMessageTexture{ &m_gameServices };
+	CTexture m_successMessageTexture{ &m_gameServices };
+	CTexture m_gameOverMessageTexture{ &m_gameServices };
+	CTexture m_pausedMessageTexture{ &m_gameServices };
 
 #if SOUND_ENABLED
-	CSound m_music;
-	CSound m_playerShootSound;
-	CSound m_playerShieldSound;
-	CSound m_playerExplosionSound;
-	CSound m_playerShieldNullifiedSound;
-	CSound m_enemyExplosionSound;
-	CSound m_enemyAttackSound;
-	CSound m_bossSpawnSound;
-	CSound m_bossNullifySound;
-	CSound m_bossEnhanceSound;
+	CSound m_music{ &m_gameServices };
+	CSound m_playerShootSound{ &m_gameServices };
+	CSound m_playerShieldSound{ &m_gameServices };
+	CSound m_playerExplosionSound{ &m_gameServices };
+	CSound m_playerShieldNullifiedSound{ &m_gameServices };
+	CSound m_enemyExplosionSound{ &m_gameServices };
+	CSound m_enemyAttackSound{ &m_gameServices };
+	CSound m_bossSpawnSound{ &m_gameServices };
+	CSound m_bossNullifySound{ &m_gameServices };
+	CSound m_bossEnhanceSound{ &m_gameServices };
 #endif
 
 	EState m_currentState = EState::UNASSIGNED;
@@ -228,6 +365,8 @@ private:
 
 	Uint32 m_lastBossSpawnTicks = 0;
 	Uint32 m_lastMessageDisplayTicks = 0;
+	bool m_isPaused = false;
+	bool m_isFastForwarding = false;
 
 	int m_score = 0;
 	int m_previousScore = -1;
@@ -237,4 +376,45 @@ private:
 	int m_previousLives = -1;
 
 	float m_difficultyMultiplier = 1.0f;
+
+	bool m_isPreloaded = false;
+	bool m_isWarmedUp = false;
+	bool m_isHeadless = false;
+
+	// the second player's keys, handed to the loopback transport. created on the first two player game
+	CPlayerShip::SInputData m_secondPlayerInput;
+	CLoopbackTransport m_loopbackTransport;
+	CRollbackSession* m_rollbackSession = nullptr;
+	bool m_isTwoPlayerGame = false;
+	bool m_isResimulating = false;
+};
+
+struct CIngameState::SSnapshot
+{
+	static const int MAX_PROJECTILES = 256;
+	static const int MAX_EXPLOSIONS = 64;
+
+	EState m_currentState;
+	EState m_requestedState;
+	EMessageState m_currentMessageState;
+	EMessageState m_requestedMessageState;
+	Uint32 m_gameTicks;
+	Uint32 m_lastBossSpawnTicks;
+	Uint32 m_lastMessageDisplayTicks;
+	Sint32 m_score;
+	Sint32 m_level;
+	Sint32 m_lives;
+	Uint64 m_randomState;
+
+	CStarfield::SState m_starfield;
+	CPlayerShip::SState m_playerShip;
+	CPlayerShip::SState m_secondPlayerShip;
+	CBoss::SState m_boss;
+	CEnemyFormation::SState m_enemyFormation;
+
+	// in list order
+	Sint32 m_numProjectiles;
+	Sint32 m_numExplosions;
+	CProjectile::SState m_projectiles[MAX_PROJECTILES];
+	CExplosion::SState m_explosions[MAX_EXPLOSIONS];
 };
\ No newline at end of file
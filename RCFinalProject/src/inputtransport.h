@@ -0,0 +1,32 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include "playership.h"
+
+// the input of one player for one frame of a rollback session, see CRollbackSession
+struct SInputMessage
+{
+	Uint32 m_frame = 0;
+	Uint8 m_playerIndex = 0;
+	CPlayerShip::SInputData m_inputData;
+};
+
+// carries the inputs between the machines of a two player game. messages may arrive late, but never changed
+class CInputTransport
+{
+public:
+	virtual ~CInputTransport() {}
+
+	virtual void Send(const SInputMessage& message) = 0;
+
+	// false once there is nothing left that has arrived
+	virtual bool Receive(SInputMessage* message) = 0;
+};
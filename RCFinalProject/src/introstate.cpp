@@ -4,13 +4,15 @@
 
 #include "introstate.h"
 
-#include "app.h"
 #include <assert.h>
+#include "assetloader.h"
+#include "clock.h"
+#include "gamemanager.h"
+#include "renderthread.h"
 #include "utils.h"
 
 void CIntroState::Init()
 {
-	InitValues();
 #if SOUND_ENABLED
 	InitSounds();
 #endif	
@@ -18,14 +20,32 @@ void CIntroState::Init()
 	InitText();
 
 	m_isInitialized = true;
+}
+
+void CIntroState::Enter()
+{
+	InitValues();
+
+	// the textures and sounds are loaded in the background the first time, the state starts once they are ready
+	RequestState(INITIAL_STATE);
+}
 
+void CIntroState::Exit()
+{
+#if SOUND_ENABLED
+	m_music.Stop();
+#endif
+}
+
+void CIntroState::OnAssetsLoaded()
+{
 #if SOUND_ENABLED
 	// start playing the music
 	m_music.SetLoop(true);
 	m_music.Play(SOUND_MUSIC_VOLUME);
 #endif
 
-	RequestState(INITIAL_STATE);
+	RequestState(EState::ANIMATE_LASER);
 }
 
 void CIntroState::CleanUp()
@@ -77,16 +97,21 @@ void CIntroState::HandleKeyUpInput(SDL_KeyboardEvent* kbEvent)
 
 void CIntroState::InitValues()
 {
-	SetIsInitialized(false);
+	m_currentState = EState::UNASSIGNED;
+	m_requestedState = EState::UNASSIGNED;
 
 	m_backgroundPosY = BACKGROUND_STARTING_Y;
 	m_laserPosY = LASER_STARTING_Y;
+
+	// the key that started the last game was released in another state
+	m_inputData.Reset();
 }
 
 #if SOUND_ENABLED
 void CIntroState::InitSounds()
 {
-	m_music.CreateFromFile(SOUND_MUSIC_FILENAME.c_str());
+	m_music.SetMaxVoices(SOUND_MUSIC_MAX_VOICES);
+	m_services->m_assetLoader->QueueSound(&m_music, SOUND_MUSIC_FILENAME);
 }
 
 void CIntroState::DestroySounds()
@@ -104,8 +129,17 @@ void CIntroState::Update(Uint32 elapsedTime)
 		m_requestedState = EState::UNASSIGNED;
 	}
 
+	if (m_currentState == EState::LOADING)
+	{
+		if (m_services->m_assetLoader->IsIdle())
+		{
+			OnAssetsLoaded();
+		}
+		return;
+	}
+
 	// always move the background
-	if (CApp::GetInstance()->GetGameManager()->IsBackgroundScrollingEnabled())
+	if (m_services->m_gameManager->IsBackgroundScrollingEnabled())
 	{
 		m_backgroundPosY += Utils::ScaleSpeed(elapsedTime, BACKGROUND_MOVE_SPEED);
 		if (m_backgroundPosY <= 0.0f)
@@ -128,8 +162,11 @@ void CIntroState::Update(Uint32 elapsedTime)
 	}
 	else if (m_currentState == EState::DRAW_TITLE)
 	{
-		m_lastHitKeyLabelColorSwitchTicks = Utils::GetTicks();
+		m_lastHitKeyLabelColorSwitchTicks = m_services->m_clock->GetTicks();
 		RequestState(EState::IDLE);
+
+		// nothing else is going on while waiting for a key, get the game ready in the meantime
+		m_services->m_gameManager->PreloadState(CGameManager::EGameState::INGAME);
 	}
 	else if (m_currentState == EState::IDLE)
 	{
@@ -139,7 +176,7 @@ void CIntroState::Update(Uint32 elapsedTime)
 	if (m_inputData.m_anyKey == 1)
 	{
 		// request gamemanager to switch state
-		CApp::GetInstance()->GetGameManager()->RequestState(CGameManager::EGameState::INGAME);
+		m_services->m_gameManager->RequestState(CGameManager::EGameState::INGAME);
 	}
 
 	UpdateText(elapsedTime);
@@ -148,7 +185,7 @@ void CIntroState::Update(Uint32 elapsedTime)
 void CIntroState::UpdateText(Uint32 elapsedTime)
 {
 	// switch the text color
-	if (Utils::GetTicks() - m_lastHitKeyLabelColorSwitchTicks > HIT_KEY_LABEL_COLOR_SWITCH_TIME_MS)
+	if (m_services->m_clock->GetTicks() - m_lastHitKeyLabelColorSwitchTicks > HIT_KEY_LABEL_COLOR_SWITCH_TIME_MS)
 	{
 		m_hitKeyLabelColorSwitchToggle = !m_hitKeyLabelColorSwitchToggle;
 		if (m_hitKeyLabelColorSwitchToggle)
@@ -159,15 +196,20 @@ void CIntroState::UpdateText(Uint32 elapsedTime)
 		{
 			m_hitKeyToStartLabelTexture.SetTint(m_originalHitKeyLabelTintRed, m_originalHitKeyLabelTintGreen, m_originalHitKeyLabelTintBlue);
 		}
-		m_lastHitKeyLabelColorSwitchTicks = Utils::GetTicks();
+		m_lastHitKeyLabelColorSwitchTicks = m_services->m_clock->GetTicks();
 	}
 }
 
 void CIntroState::Draw()
 {
-	CApp* app = CApp::GetInstance();
-	int screenWidth = app->GetScreenWidth();
-	int screenHeight = app->GetScreenHeight();
+	int screenWidth = m_services->m_screenWidth;
+	int screenHeight = m_services->m_screenHeight;
+
+	if (m_currentState == EState::LOADING)
+	{
+		m_services->m_renderThread->DrawProgressBar(m_services->m_assetLoader->GetProgress());
+		return;
+	}
 
 	// draw background
 	SDL_Rect backgroundRect{ 1080, static_cast<int>(m_backgroundPosY), screenWidth, screenHeight };
@@ -193,8 +235,7 @@ void CIntroState::Draw()
 
 void CIntroState::DrawCenteredTextLabel(CTexture& texture, int posY, bool drawBox)
 {
-	CApp* app = CApp::GetInstance();
-	int screenWidth = app->GetScreenWidth();
+	int screenWidth = m_services->m_screenWidth;
 	int halfScreenWidth = screenWidth / 2;
 	int halfBoxTextSpacing = BOX_TEXT_SPACING / 2;
 	int textureWidth = texture.GetWidth();
@@ -202,7 +243,7 @@ void CIntroState::DrawCenteredTextLabel(CTexture& texture, int posY, bool drawBo
 	int posX = (screenWidth - textureWidth) / 2;
 	if (drawBox)
 	{		
-		app->DrawBox(posX - halfBoxTextSpacing, posY - halfBoxTextSpacing,
+		m_services->m_renderThread->DrawBox(posX - halfBoxTextSpacing, posY - halfBoxTextSpacing,
 			textureWidth + BOX_TEXT_SPACING,
 			texture.GetHeight() + BOX_TEXT_SPACING,
 			true, 
@@ -215,8 +256,7 @@ void CIntroState::DrawCenteredTextLabel(CTexture& texture, int posY, bool drawBo
 
 void CIntroState::DrawText()
 {
-	CApp* app = CApp::GetInstance();
-	int screenWidth = app->GetScreenWidth();
+	int screenWidth = m_services->m_screenWidth;
 	int halfScreenWidth = screenWidth / 2;
 	
 	DrawCenteredTextLabel(m_hitKeyToStartLabelTexture, static_cast<int>(LABEL_HIT_KEY_TO_START_POS_Y), false);
@@ -226,7 +266,7 @@ void CIntroState::DrawText()
 
 void CIntroState::InitTextures()
 {
-	m_spriteSheetTexture.CreateFromFile(TEXTURE_SPRITESHEET_FILENAME);
+	m_services->m_assetLoader->QueueTexture(&m_spriteSheetTexture, TEXTURE_SPRITESHEET_FILENAME);
 }
 
 void CIntroState::DestroyTextures()
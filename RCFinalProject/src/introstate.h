@@ -18,13 +18,19 @@ public:
 	enum class EState : int
 	{
 		UNASSIGNED,
+		LOADING,
 		ANIMATE_LASER,
 		DRAW_TITLE,
 		IDLE,
 	};
 
+	CIntroState(const SServices* services) : CGameState(services) {}
+
 	void Init();
 	void CleanUp();
+	void Enter() override;
+	void Exit() override;
+	bool IsLoading() override { return m_currentState == EState::LOADING; }
 
 	void HandleKeyDownInput(SDL_KeyboardEvent* kbEvent);
 	void HandleKeyUpInput(SDL_KeyboardEvent* kbEvent);
@@ -35,6 +41,7 @@ public:
 #endif
 	void InitTextures();
 	void InitText();
+	void OnAssetsLoaded();
 
 #if SOUND_ENABLED
 	void DestroySounds();
@@ -74,6 +81,7 @@ private:
 	// sounds
 	const std::string SOUND_MUSIC_FILENAME = "mus-menu.mod";
 	const float SOUND_MUSIC_VOLUME = 0.75f;
+	const int SOUND_MUSIC_MAX_VOICES = 1;
 
 	// labels
 	const std::string LABEL_HIT_KEY_TO_START_TEXT = "HIT A KEY TO START!";
@@ -88,7 +96,7 @@ private:
 	const SDL_Color LABEL_YELLOW_COLOR{ 255, 255, 0, 255 };
 	const SDL_Color LABEL_CYAN_COLOR{ 0, 255, 255, 255 };
 
-	const EState INITIAL_STATE = EState::ANIMATE_LASER;
+	const EState INITIAL_STATE = EState::LOADING;
 
 	// background texture movement
 	const float BACKGROUND_STARTING_Y = 1080.0f * 2.0f;
@@ -113,13 +121,13 @@ private:
 	void SetInputAnyKey(Uint8 v) { m_inputData.m_anyKey = v; }
 	void DrawCenteredTextLabel(CTexture& texture, int posY, bool drawBox);
 	
-	CTexture m_spriteSheetTexture;
-	CTexture m_copyrightLabelTexture;
-	CTexture m_hitKeyToStartLabelTexture;
-	CTexture m_hitKeyToToggleBackgroundScrollingTexture;
+	CTexture m_spriteSheetTexture{ m_services };
+	CTexture m_copyrightLabelTexture{ m_services };
+	CTexture m_hitKeyToStartLabelTexture{ m_services };
+	CTexture m_hitKeyToToggleBackgroundScrollingTexture{ m_services };
 
 #if SOUND_ENABLED
-	CSound m_music;
+	CSound m_music{ m_services };
 #endif
 
 	EState m_currentState = EState::UNASSIGNED;
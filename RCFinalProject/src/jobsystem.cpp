@@ -0,0 +1,330 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "jobsystem.h"
+
+#include <assert.h>
+#include "profiler.h"
+#include "utils.h"
+
+// index of the job thread running the code, -1 on any other thread
+static thread_local int s_threadIndex = -1;
+
+// jobs run by Wait() inside another job, their time is already part of the outer job's
+static thread_local int s_executeDepth = 0;
+
+void CJobSystem::Init()
+{
+	// the main thread takes one of the cores
+	m_numThreads = std::max(1, std::min(MAX_THREADS, SDL_GetCPUCount()));
+	LOG_SCR_F("Starting job system with %d worker threads\n", m_numThreads - 1);
+
+	for (int i = 0; i < m_numThreads; i++)
+	{
+		m_threadData[i].m_jobs = new SJob[MAX_JOBS_PER_THREAD];
+		m_threadData[i].m_numAllocatedJobs = 0;
+	}
+
+	s_threadIndex = 0;
+	m_isShuttingDown = false;
+	for (int i = 1; i < m_numThreads; i++)
+	{
+		m_workerThreads.emplace_back(&CJobSystem::WorkerThreadMain, this, i);
+	}
+}
+
+void CJobSystem::Destroy()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_sleepMutex);
+		m_isShuttingDown = true;
+	}
+	m_sleepCondition.notify_all();
+
+	for (std::thread& workerThread : m_workerThreads)
+	{
+		workerThread.join();
+	}
+	m_workerThreads.clear();
+
+	for (int i = 0; i < m_numThreads; i++)
+	{
+		m_threadData[i].m_queue.clear();
+		delete[] m_threadData[i].m_jobs;
+		m_threadData[i].m_jobs = nullptr;
+		for (SJob* job : m_threadData[i].m_overflowJobs)
+		{
+			delete job;
+		}
+		m_threadData[i].m_overflowJobs.clear();
+	}
+	m_numQueuedJobs = 0;
+	s_threadIndex = -1;
+}
+
+CJobSystem::SJob* CJobSystem::AllocateJob()
+{
+	assert(s_threadIndex >= 0);
+
+	// only the owning thread allocates from its ring, no need to lock. a job is free again once it is finished, the
+	// next one in the ring almost always is. it may not be if the jobs finish out of order, or if there are more than
+	// the ring holds in flight: an unfinished job must never be reused, the first free one after it is taken instead
+	SThreadData& threadData = m_threadData[s_threadIndex];
+	for (int i = 0; i < MAX_JOBS_PER_THREAD; i++)
+	{
+		SJob* job = &threadData.m_jobs[threadData.m_numAllocatedJobs++ % MAX_JOBS_PER_THREAD];
+		if (IsFree(job))
+		{
+			return job;
+		}
+	}
+
+	for (SJob* job : threadData.m_overflowJobs)
+	{
+		if (IsFree(job))
+		{
+			return job;
+		}
+	}
+
+	// the whole ring is in flight. slower, but the job graph stays intact
+	SJob* job = new SJob();
+	threadData.m_overflowJobs.push_back(job);
+
+	// loud even in release builds, but only every time the count doubles
+	size_t numOverflowJobs = threadData.m_overflowJobs.size();
+	if ((numOverflowJobs & (numOverflowJobs - 1)) == 0)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Job thread %d has more than %d jobs in flight, %d taken from the heap", s_threadIndex, MAX_JOBS_PER_THREAD, (int)numOverflowJobs);
+	}
+	return job;
+}
+
+CJobSystem::SJob* CJobSystem::CreateJob(const JobFunction& function)
+{
+	SJob* job = AllocateJob();
+
+	// published before the job counts as unfinished again, whoever sees it unfinished also sees the new generation
+	job->m_generation++;
+	job->m_function = function;
+	job->m_parent = nullptr;
+	job->m_numUnfinishedJobs = 1;
+	job->m_numPendingDependencies = 1;
+	job->m_numContinuations = 0;
+	job->m_isRunRequested = false;
+	return job;
+}
+
+CJobSystem::SJob* CJobSystem::CreateChildJob(SJob* parent, const JobFunction& function)
+{
+	assert(parent != nullptr && !IsFree(parent));
+
+	parent->m_numUnfinishedJobs++;
+
+	SJob* job = CreateJob(function);
+	job->m_parent = parent;
+	return job;
+}
+
+void CJobSystem::AddDependency(SJob* job, SJob* dependency)
+{
+	assert(!job->m_isRunRequested && !dependency->m_isRunRequested);
+	assert(dependency->m_numContinuations < MAX_CONTINUATIONS);
+
+	job->m_numPendingDependencies++;
+	dependency->m_continuations[dependency->m_numContinuations++] = job;
+}
+
+CJobSystem::SJobHandle CJobSystem::Run(SJob* job)
+{
+	assert(!job->m_isRunRequested);
+	job->m_isRunRequested = true;
+
+	// taken before the job is queued, it may be finished and reused by the time Push() returns
+	SJobHandle handle;
+	handle.m_job = job;
+	handle.m_generation = job->m_generation.load(std::memory_order_relaxed);
+
+	// queued now unless it still waits for another job, that one queues it when it finishes
+	if (--job->m_numPendingDependencies == 0)
+	{
+		Push(job);
+	}
+	return handle;
+}
+
+void CJobSystem::Wait(const SJobHandle& handle)
+{
+	assert(s_threadIndex >= 0);
+
+	// help out instead of blocking, the job or its children may well be in this thread's own queue
+	while (!IsFinished(handle))
+	{
+		SJob* nextJob = GetJob(s_threadIndex);
+		if (nextJob != nullptr)
+		{
+			Execute(nextJob, s_threadIndex);
+		}
+		else
+		{
+			std::this_thread::yield();
+		}
+	}
+}
+
+// a job that was reused is finished too. the count is read first: if it belongs to a newer job, so does the
+// generation read after it
+bool CJobSystem::IsFinished(const SJobHandle& handle)
+{
+	if (IsFree(handle.m_job))
+	{
+		return true;
+	}
+	return handle.m_job->m_generation.load(std::memory_order_acquire) != handle.m_generation;
+}
+
+bool CJobSystem::IsFree(SJob* job)
+{
+	return job->m_numUnfinishedJobs.load(std::memory_order_acquire) == 0;
+}
+
+void CJobSystem::CollectStats(CProfiler* profiler)
+{
+	for (int i = 0; i < m_numThreads; i++)
+	{
+		profiler->RecordJobThreadBusyTime(i, m_threadData[i].m_busyCounter.exchange(0));
+		profiler->IncrementCounter(CProfiler::ECounter::JOBS_EXECUTED, m_threadData[i].m_numExecutedJobs.exchange(0));
+	}
+}
+
+void CJobSystem::Push(SJob* job)
+{
+	// jobs whose dependencies finished on another thread are queued there, they can be stolen from it
+	int threadIndex = s_threadIndex;
+	assert(threadIndex >= 0);
+
+	// counted first so the count never goes negative, a worker about to sleep either sees it or is counted as
+	// sleeping below
+	m_numQueuedJobs++;
+	{
+		std::lock_guard<std::mutex> lock(m_threadData[threadIndex].m_queueMutex);
+		m_threadData[threadIndex].m_queue.push_back(job);
+	}
+
+	if (m_numSleepingWorkers > 0)
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_sleepMutex);
+		}
+		m_sleepCondition.notify_one();
+	}
+}
+
+// the newest job of the thread's own queue, it is the most likely to still be in the cache. otherwise the oldest job
+// of another thread, the one that is the most likely to spawn more work
+CJobSystem::SJob* CJobSystem::GetJob(int threadIndex)
+{
+	if (m_numQueuedJobs == 0)
+	{
+		return nullptr;
+	}
+
+	{
+		SThreadData& threadData = m_threadData[threadIndex];
+		std::lock_guard<std::mutex> lock(threadData.m_queueMutex);
+		if (!threadData.m_queue.empty())
+		{
+			SJob* job = threadData.m_queue.back();
+			threadData.m_queue.pop_back();
+			m_numQueuedJobs--;
+			return job;
+		}
+	}
+
+	for (int i = 1; i < m_numThreads; i++)
+	{
+		SThreadData& threadData = m_threadData[(threadIndex + i) % m_numThreads];
+		std::lock_guard<std::mutex> lock(threadData.m_queueMutex);
+		if (!threadData.m_queue.empty())
+		{
+			SJob* job = threadData.m_queue.front();
+			threadData.m_queue.pop_front();
+			m_numQueuedJobs--;
+			return job;
+		}
+	}
+
+	return nullptr;
+}
+
+void CJobSystem::Execute(SJob* job, int threadIndex)
+{
+	Uint64 startCounter = SDL_GetPerformanceCounter();
+	s_executeDepth++;
+	if (job->m_function)
+	{
+		job->m_function();
+	}
+	Finish(job);
+	s_executeDepth--;
+
+	// only the outermost job adds its time, it already includes the jobs it ran while waiting
+	SThreadData& threadData = m_threadData[threadIndex];
+	if (s_executeDepth == 0)
+	{
+		threadData.m_busyCounter += SDL_GetPerformanceCounter() - startCounter;
+	}
+	threadData.m_numExecutedJobs++;
+}
+
+void CJobSystem::Finish(SJob* job)
+{
+	// the job is free to be reused the moment it is finished, nothing of it may be read after that. the parent and
+	// the continuations were set before it was run, they do not change anymore
+	SJob* parent = job->m_parent;
+	SJob* continuations[MAX_CONTINUATIONS];
+	int numContinuations = job->m_numContinuations;
+	for (int i = 0; i < numContinuations; i++)
+	{
+		continuations[i] = job->m_continuations[i];
+	}
+
+	if (--job->m_numUnfinishedJobs != 0)
+	{
+		return;
+	}
+
+	for (int i = 0; i < numContinuations; i++)
+	{
+		if (--continuations[i]->m_numPendingDependencies == 0)
+		{
+			Push(continuations[i]);
+		}
+	}
+
+	if (parent != nullptr)
+	{
+		Finish(parent);
+	}
+}
+
+void CJobSystem::WorkerThreadMain(int threadIndex)
+{
+	s_threadIndex = threadIndex;
+
+	while (!m_isShuttingDown)
+	{
+		SJob* job = GetJob(threadIndex);
+		if (job != nullptr)
+		{
+			Execute(job, threadIndex);
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(m_sleepMutex);
+		m_numSleepingWorkers++;
+		m_sleepCondition.wait(lock, [this]() { return m_numQueuedJobs > 0 || m_isShuttingDown; });
+		m_numSleepingWorkers--;
+	}
+}
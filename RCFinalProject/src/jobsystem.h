@@ -0,0 +1,149 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include "preproc.h"
+#include <thread>
+#include <vector>
+
+class CProfiler;
+
+// runs small jobs on a pool of worker threads, one per core. every thread has its own queue and takes its newest
+// job first, a thread that runs out steals the oldest job of another one. the main thread is job thread 0: it
+// does not sleep, it helps running jobs while it waits for them.
+// jobs can only be created and run from the job threads (the main thread or inside a job)
+class CJobSystem
+{
+public:
+	typedef std::function<void()> JobFunction;
+
+	struct SJob;
+
+	// what is left of a job once it is run. the job itself is recycled as soon as it finishes, the generation tells
+	// a finished job apart from a newer one that took its place
+	struct SJobHandle
+	{
+		SJob* m_job = nullptr;
+		Uint32 m_generation = 0;
+	};
+
+	void Init();
+	void Destroy();
+
+	// the job does not run until Run() is called. a job with a parent counts as unfinished until all its children
+	// are finished, so waiting for the parent waits for all of them
+	SJob* CreateJob(const JobFunction& function);
+	SJob* CreateChildJob(SJob* parent, const JobFunction& function);
+
+	// the job only starts once the other one is finished. neither of them can have been run yet
+	void AddDependency(SJob* job, SJob* dependency);
+
+	// the job must not be touched after this, only through the handle
+	SJobHandle Run(SJob* job);
+	void Wait(const SJobHandle& handle);
+	bool IsFinished(const SJobHandle& handle);
+
+	// calls function(begin, end) for every batch of up to batchSize elements of [0, count) and waits for all of them
+	template <typename TFunction>
+	void ParallelFor(int count, int batchSize, const TFunction& function);
+
+	int GetNumThreads() { return m_numThreads; }
+
+	// adds the time each thread spent running jobs since the last call to the profiler
+	void CollectStats(CProfiler* profiler);
+
+private:
+	static const int MAX_THREADS = JOBS_MAX_THREADS;
+	static const int MAX_JOBS_PER_THREAD = 1024; // jobs are recycled, a thread with more in flight takes them from the heap
+	static const int MAX_CONTINUATIONS = 8;
+
+	struct SThreadData
+	{
+		std::mutex m_queueMutex;
+		std::deque<SJob*> m_queue;
+
+		SJob* m_jobs = nullptr;
+		Uint32 m_numAllocatedJobs = 0;
+
+		// only used once every job of the ring is in flight, e.g. many nested ParallelFor(). kept until Destroy()
+		std::vector<SJob*> m_overflowJobs;
+
+		std::atomic<Uint64> m_busyCounter{ 0 };
+		std::atomic<Uint32> m_numExecutedJobs{ 0 };
+	};
+
+	SJob* AllocateJob();
+	bool IsFree(SJob* job);
+	void Push(SJob* job);
+	SJob* GetJob(int threadIndex);
+	void Execute(SJob* job, int threadIndex);
+	void Finish(SJob* job);
+	void WorkerThreadMain(int threadIndex);
+
+	SThreadData m_threadData[MAX_THREADS];
+	int m_numThreads = 1;
+	std::vector<std::thread> m_workerThreads;
+
+	// sleeping workers are only woken up if there are jobs to steal
+	std::mutex m_sleepMutex;
+	std::condition_variable m_sleepCondition;
+	std::atomic<int> m_numQueuedJobs{ 0 };
+	std::atomic<int> m_numSleepingWorkers{ 0 };
+	std::atomic<bool> m_isShuttingDown{ false };
+};
+
+struct CJobSystem::SJob
+{
+	JobFunction m_function;
+
+	// incremented every time the job is reused
+	std::atomic<Uint32> m_generation{ 0 };
+	SJob* m_parent = nullptr;
+
+	// itself plus its unfinished children
+	std::atomic<int> m_numUnfinishedJobs{ 0 };
+
+	// jobs that have to finish before this one starts, plus one until Run() is called
+	std::atomic<int> m_numPendingDependencies{ 0 };
+
+	SJob* m_continuations[MAX_CONTINUATIONS] = {};
+	int m_numContinuations = 0;
+	bool m_isRunRequested = false;
+};
+
+template <typename TFunction>
+void CJobSystem::ParallelFor(int count, int batchSize, const TFunction& function)
+{
+	if (count <= 0)
+	{
+		return;
+	}
+
+	// not worth a job
+	if (count <= batchSize || m_numThreads == 1)
+	{
+		function(0, count);
+		return;
+	}
+
+	SJob* root = CreateJob(nullptr);
+	for (int begin = 0; begin < count; begin += batchSize)
+	{
+		int end = std::min(begin + batchSize, count);
+		Run(CreateChildJob(root, [&function, begin, end]() { function(begin, end); }));
+	}
+	Wait(Run(root));
+}
@@ -0,0 +1,60 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "loopbacktransport.h"
+
+#include "utils.h"
+
+void CLoopbackTransport::Init(Uint8 remotePlayerIndex, Uint32 latencyMs, Uint32 jitterMs)
+{
+	m_remotePlayerIndex = remotePlayerIndex;
+	m_latencyMs = latencyMs;
+	m_jitterMs = jitterMs;
+	m_random.Seed(SDL_GetPerformanceCounter());
+
+	LOG_SCR_F("Loopback transport: %u ms latency, %u ms jitter\n", m_latencyMs, m_jitterMs);
+}
+
+void CLoopbackTransport::Reset()
+{
+	m_pendingMessages.clear();
+	m_remoteInputData.Reset();
+	m_lastDeliveryTicks = 0;
+}
+
+void CLoopbackTransport::Send(const SInputMessage& message)
+{
+	// the other machine is on the same frame, it answers with its own input
+	SPendingMessage pendingMessage;
+	pendingMessage.m_message.m_frame = message.m_frame;
+	pendingMessage.m_message.m_playerIndex = m_remotePlayerIndex;
+	pendingMessage.m_message.m_inputData = m_remoteInputData;
+
+	// the latency is the whole round trip, out to the other machine and its answer back
+	Uint32 latencyMs = m_latencyMs;
+	if (m_jitterMs > 0)
+	{
+		latencyMs += m_random.GetUint32(0, m_jitterMs);
+	}
+	pendingMessage.m_deliveryTicks = Utils::GetTicks() + latencyMs;
+	if (pendingMessage.m_deliveryTicks < m_lastDeliveryTicks)
+	{
+		pendingMessage.m_deliveryTicks = m_lastDeliveryTicks;
+	}
+	m_lastDeliveryTicks = pendingMessage.m_deliveryTicks;
+
+	m_pendingMessages.push_back(pendingMessage);
+}
+
+bool CLoopbackTransport::Receive(SInputMessage* message)
+{
+	if (m_pendingMessages.empty() || Utils::GetTicks() < m_pendingMessages.front().m_deliveryTicks)
+	{
+		return false;
+	}
+
+	*message = m_pendingMessages.front().m_message;
+	m_pendingMessages.pop_front();
+	return true;
+}
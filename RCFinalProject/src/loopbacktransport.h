@@ -0,0 +1,43 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include <deque>
+#include "inputtransport.h"
+#include "random.h"
+
+// stands in for the network and the other player's machine, so a two player game can be played and tested on one
+// machine. every input sent for a frame is answered with the other player's input for the same frame, which comes
+// from this machine as well (e.g. the other half of the keyboard) and arrives after the simulated latency
+class CLoopbackTransport : public CInputTransport
+{
+public:
+	// the latency varies by up to jitterMs, the messages still arrive in order
+	void Init(Uint8 remotePlayerIndex, Uint32 latencyMs, Uint32 jitterMs);
+
+	// drops whatever is still on its way, e.g. when a new game starts
+	void Reset();
+
+	// what the other player is pressing right now
+	void SetRemoteInput(const CPlayerShip::SInputData& inputData) { m_remoteInputData = inputData; }
+
+	void Send(const SInputMessage& message) override;
+	bool Receive(SInputMessage* message) override;
+
+private:
+	struct SPendingMessage
+	{
+		SInputMessage m_message;
+		Uint32 m_deliveryTicks = 0;
+	};
+
+	std::deque<SPendingMessage> m_pendingMessages;
+	CPlayerShip::SInputData m_remoteInputData;
+	CRandom m_random;
+	Uint8 m_remotePlayerIndex = 1;
+	Uint32 m_latencyMs = 0;
+	Uint32 m_jitterMs = 0;
+	Uint32 m_lastDeliveryTicks = 0;
+};
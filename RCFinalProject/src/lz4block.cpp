@@ -0,0 +1,235 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "lz4block.h"
+
+#include <string.h>
+
+namespace LZ4Block
+{
+	const size_t MIN_MATCH_LENGTH = 4;
+	const size_t LAST_LITERALS_LENGTH = 5; // the last 5 bytes of a block are always literals
+	const size_t MATCH_START_LIMIT = 12; // the last match must start at least 12 bytes before the end of the block
+	const size_t MAX_OFFSET = 65535;
+	const int HASH_TABLE_BITS = 12;
+	const uint32_t EMPTY_HASH_ENTRY = 0xFFFFFFFF;
+
+	static uint32_t Read32(const uint8_t* ptr)
+	{
+		uint32_t value;
+		memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	static uint32_t Hash(uint32_t sequence)
+	{
+		return (sequence * 2654435761U) >> (32 - HASH_TABLE_BITS);
+	}
+
+	// writes the part of a length that does not fit in the token's 4 bits
+	static bool WriteLengthBytes(size_t length, uint8_t* output, size_t outputCapacity, size_t& outputPos)
+	{
+		for (; length >= 255; length -= 255)
+		{
+			if (outputPos >= outputCapacity)
+			{
+				return false;
+			}
+			output[outputPos++] = 255;
+		}
+
+		if (outputPos >= outputCapacity)
+		{
+			return false;
+		}
+		output[outputPos++] = static_cast<uint8_t>(length);
+		return true;
+	}
+
+	static bool ReadLengthBytes(const uint8_t* input, size_t inputSize, size_t& inputPos, size_t& length)
+	{
+		uint8_t value;
+		do
+		{
+			if (inputPos >= inputSize)
+			{
+				return false;
+			}
+			value = input[inputPos++];
+			length += value;
+		} while (value == 255);
+
+		return true;
+	}
+
+	// one sequence is the literals since the last match followed by a match, the last one has no match
+	static bool WriteSequence(const uint8_t* literals, size_t literalsLength, size_t offset, size_t matchLength, uint8_t* output, size_t outputCapacity, size_t& outputPos)
+	{
+		if (outputPos >= outputCapacity)
+		{
+			return false;
+		}
+
+		size_t tokenPos = outputPos++;
+		uint8_t token = static_cast<uint8_t>((literalsLength >= 15 ? 15 : literalsLength) << 4);
+		if (literalsLength >= 15 && !WriteLengthBytes(literalsLength - 15, output, outputCapacity, outputPos))
+		{
+			return false;
+		}
+
+		if (outputPos + literalsLength > outputCapacity)
+		{
+			return false;
+		}
+		memcpy(output + outputPos, literals, literalsLength);
+		outputPos += literalsLength;
+
+		if (matchLength > 0)
+		{
+			if (outputPos + 2 > outputCapacity)
+			{
+				return false;
+			}
+			output[outputPos++] = static_cast<uint8_t>(offset & 0xFF);
+			output[outputPos++] = static_cast<uint8_t>(offset >> 8);
+
+			size_t extraMatchLength = matchLength - MIN_MATCH_LENGTH;
+			token |= static_cast<uint8_t>(extraMatchLength >= 15 ? 15 : extraMatchLength);
+			if (extraMatchLength >= 15 && !WriteLengthBytes(extraMatchLength - 15, output, outputCapacity, outputPos))
+			{
+				return false;
+			}
+		}
+
+		output[tokenPos] = token;
+		return true;
+	}
+
+	size_t GetMaxCompressedSize(size_t inputSize)
+	{
+		return inputSize + inputSize / 255 + 16;
+	}
+
+	size_t Compress(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputCapacity)
+	{
+		size_t outputPos = 0;
+		size_t anchor = 0;
+
+		// greedy matching against the last position each 4 byte sequence was seen at
+		if (inputSize > MATCH_START_LIMIT)
+		{
+			uint32_t hashTable[1 << HASH_TABLE_BITS];
+			memset(hashTable, 0xFF, sizeof(hashTable));
+
+			size_t inputPos = 0;
+			size_t matchStartLimit = inputSize - MATCH_START_LIMIT;
+			size_t matchEndLimit = inputSize - LAST_LITERALS_LENGTH;
+			while (inputPos <= matchStartLimit)
+			{
+				uint32_t sequence = Read32(input + inputPos);
+				uint32_t hash = Hash(sequence);
+				uint32_t candidatePos = hashTable[hash];
+				hashTable[hash] = static_cast<uint32_t>(inputPos);
+
+				if (candidatePos == EMPTY_HASH_ENTRY || inputPos - candidatePos > MAX_OFFSET || Read32(input + candidatePos) != sequence)
+				{
+					inputPos++;
+					continue;
+				}
+
+				size_t matchLength = MIN_MATCH_LENGTH;
+				while (inputPos + matchLength < matchEndLimit && input[candidatePos + matchLength] == input[inputPos + matchLength])
+				{
+					matchLength++;
+				}
+
+				if (!WriteSequence(input + anchor, inputPos - anchor, inputPos - candidatePos, matchLength, output, outputCapacity, outputPos))
+				{
+					return 0;
+				}
+
+				inputPos += matchLength;
+				anchor = inputPos;
+			}
+		}
+
+		if (!WriteSequence(input + anchor, inputSize - anchor, 0, 0, output, outputCapacity, outputPos))
+		{
+			return 0;
+		}
+
+		return outputPos;
+	}
+
+	bool Decompress(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputSize)
+	{
+		size_t inputPos = 0;
+		size_t outputPos = 0;
+
+		while (inputPos < inputSize)
+		{
+			uint8_t token = input[inputPos++];
+
+			// literals
+			size_t literalsLength = token >> 4;
+			if (literalsLength == 15 && !ReadLengthBytes(input, inputSize, inputPos, literalsLength))
+			{
+				return false;
+			}
+			if (literalsLength > inputSize - inputPos || literalsLength > outputSize - outputPos)
+			{
+				return false;
+			}
+			memcpy(output + outputPos, input + inputPos, literalsLength);
+			inputPos += literalsLength;
+			outputPos += literalsLength;
+
+			// the last sequence ends right after its literals
+			if (inputPos == inputSize)
+			{
+				break;
+			}
+
+			// match
+			if (inputSize - inputPos < 2)
+			{
+				return false;
+			}
+			size_t offset = input[inputPos] | (input[inputPos + 1] << 8);
+			inputPos += 2;
+			if (offset == 0 || offset > outputPos)
+			{
+				return false;
+			}
+
+			size_t matchLength = token & 15;
+			if (matchLength == 15 && !ReadLengthBytes(input, inputSize, inputPos, matchLength))
+			{
+				return false;
+			}
+			matchLength += MIN_MATCH_LENGTH;
+			if (matchLength > outputSize - outputPos)
+			{
+				return false;
+			}
+
+			// matches can overlap the bytes they produce (e.g. runs of the same pixel), copy those byte by byte
+			uint8_t* matchSource = output + outputPos - offset;
+			if (offset >= matchLength)
+			{
+				memcpy(output + outputPos, matchSource, matchLength);
+			}
+			else
+			{
+				for (size_t i = 0; i < matchLength; i++)
+				{
+					output[outputPos + i] = matchSource[i];
+				}
+			}
+			outputPos += matchLength;
+		}
+
+		return outputPos == outputSize;
+	}
+}
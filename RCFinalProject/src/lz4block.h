@@ -0,0 +1,21 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include <stddef.h>
+#include <stdint.h>
+
+// minimal implementation of the LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md),
+// shared by the game and the AssetPacker tool. decompression is fast enough to beat reading the uncompressed data
+namespace LZ4Block
+{
+	size_t GetMaxCompressedSize(size_t inputSize);
+
+	// returns the compressed size, or 0 if the output buffer is too small
+	size_t Compress(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputCapacity);
+
+	// the decompressed data must fill the output buffer exactly, returns false on corrupted input
+	bool Decompress(const uint8_t* input, size_t inputSize, uint8_t* output, size_t outputSize);
+}
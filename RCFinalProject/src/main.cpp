@@ -6,6 +6,6 @@
 
 int main(int argc, char* args[])
 {
-	UpdateApp();
+	UpdateApp(argc, args);
 	return 0;
 }
\ No newline at end of file
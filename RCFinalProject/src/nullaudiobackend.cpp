@@ -0,0 +1,116 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+#include "nullaudiobackend.h"
+
+#include "assetarchive.h"
+#include "utils.h"
+
+bool CNullAudioBackend::Init(CAssetArchive* assetArchive)
+{
+	m_assetArchive = assetArchive;
+
+	LOG_SCR("Initializing null audio");
+	return true;
+}
+
+void CNullAudioBackend::Destroy()
+{
+	LOG_SCR("Cleaning up null audio");
+}
+
+CAudioBackend::SoundHandle CNullAudioBackend::CreateSound(const std::string& path)
+{
+	SDL_RWops* file = m_assetArchive->OpenAsset(path);
+	if (file == nullptr)
+	{
+		return nullptr;
+	}
+
+	Sint64 size = SDL_RWsize(file);
+	SDL_RWclose(file);
+
+	SSound* sound = new SSound;
+	sound->m_durationMs = static_cast<Uint32>(size / BYTES_PER_MS);
+	return sound;
+}
+
+void CNullAudioBackend::ReleaseSound(SoundHandle sound)
+{
+	delete static_cast<SSound*>(sound);
+}
+
+size_t CNullAudioBackend::GetSoundSizeInBytes(SoundHandle /*sound*/)
+{
+	return sizeof(SSound);
+}
+
+void CNullAudioBackend::Update()
+{
+	Uint32 ticks = Utils::GetTicks();
+	for (SVoice& voice : m_voices)
+	{
+		if (voice.m_isPlaying && !voice.m_isLooping && static_cast<Sint32>(ticks - voice.m_endTicks) >= 0)
+		{
+			voice.m_isPlaying = false;
+		}
+	}
+}
+
+// handles are the voice index in the low bits and a generation count in the high bits, so the handle of a voice
+// that finished does not refer to whatever plays in its slot next
+CAudioBackend::VoiceHandle CNullAudioBackend::PlaySound(SoundHandle sound, float volume, bool isLooping)
+{
+	for (int i = 0; i < MAX_VOICES; i++)
+	{
+		SVoice& voice = m_voices[i];
+		if (!voice.m_isPlaying)
+		{
+			SSound* nullSound = static_cast<SSound*>(sound);
+			voice.m_generation++;
+			voice.m_endTicks = Utils::GetTicks() + nullSound->m_durationMs;
+			voice.m_volume = volume;
+			voice.m_isLooping = isLooping;
+			voice.m_isPlaying = true;
+			return (static_cast<VoiceHandle>(voice.m_generation) << 32) | (i + 1);
+		}
+	}
+
+	return INVALID_VOICE;
+}
+
+CNullAudioBackend::SVoice* CNullAudioBackend::GetVoice(VoiceHandle voice)
+{
+	int index = static_cast<int>(voice & 0xFFFFFFFF) - 1;
+	if (index < 0 || index >= MAX_VOICES || m_voices[index].m_generation != static_cast<Uint32>(voice >> 32) || !m_voices[index].m_isPlaying)
+	{
+		return nullptr;
+	}
+
+	return &m_voices[index];
+}
+
+void CNullAudioBackend::StopVoice(VoiceHandle voice)
+{
+	SVoice* nullVoice = GetVoice(voice);
+	if (nullVoice != nullptr)
+	{
+		nullVoice->m_isPlaying = false;
+	}
+}
+
+bool CNullAudioBackend::IsVoicePlaying(VoiceHandle voice)
+{
+	return GetVoice(voice) != nullptr;
+}
+
+float CNullAudioBackend::GetVoiceAudibility(VoiceHandle voice)
+{
+	SVoice* nullVoice = GetVoice(voice);
+	return nullVoice != nullptr ? nullVoice->m_volume : 0.0f;
+}
+#endif
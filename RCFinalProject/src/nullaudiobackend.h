@@ -0,0 +1,58 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+
+#include "audiobackend.h"
+
+// plays nothing, but goes through the same motions as the other backends: sounds are still read (so missing
+// files are noticed) and voices play for as long as the sound lasts. for headless machines and benchmarks
+class CNullAudioBackend : public CAudioBackend
+{
+public:
+	bool Init(CAssetArchive* assetArchive) override;
+	void Destroy() override;
+	const char* GetName() override { return "null"; }
+
+	SoundHandle CreateSound(const std::string& path) override;
+	void ReleaseSound(SoundHandle sound) override;
+	size_t GetSoundSizeInBytes(SoundHandle sound) override;
+
+	void Update() override;
+	VoiceHandle PlaySound(SoundHandle sound, float volume, bool isLooping) override;
+	void StopVoice(VoiceHandle voice) override;
+	bool IsVoicePlaying(VoiceHandle voice) override;
+	float GetVoiceAudibility(VoiceHandle voice) override;
+
+private:
+	static const int MAX_VOICES = SOUND_MAX_CHANNELS;
+
+	// there is no way to know how long a sound lasts without decoding it, its size is a good enough stand-in
+	const Uint32 BYTES_PER_MS = 176; // 44.1 kHz, 16 bits, stereo
+
+	struct SSound
+	{
+		Uint32 m_durationMs = 0;
+	};
+
+	struct SVoice
+	{
+		Uint32 m_generation = 0;
+		Uint32 m_endTicks = 0;
+		float m_volume = 0.0f;
+		bool m_isLooping = false;
+		bool m_isPlaying = false;
+	};
+
+	SVoice* GetVoice(VoiceHandle voice);
+
+	CAssetArchive* m_assetArchive = nullptr;
+	SVoice m_voices[MAX_VOICES];
+};
+
+#endif
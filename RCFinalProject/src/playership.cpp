@@ -35,8 +35,8 @@ void CPlayerShip::Init(CTexture* spriteSheetTexture)
 
 	// calculate initial position
 	const float spawnYOffset = 80.0f;
-	m_initialPosX = static_cast<float>(CApp::GetInstance()->GetScreenWidth() + GetSpriteWidth()) / 2.0f;
-	m_initialPosY = static_cast<float>(CApp::GetInstance()->GetScreenHeight() - GetSpriteHeight() - spawnYOffset);
+	m_initialPosX = static_cast<float>(m_services->m_screenWidth + GetSpriteWidth()) / 2.0f;
+	m_initialPosY = static_cast<float>(m_services->m_screenHeight - GetSpriteHeight() - spawnYOffset);
 	SetPosition(m_initialPosX, m_initialPosY);
 
 	// initialize animation
@@ -89,9 +89,9 @@ void CPlayerShip::Update(Uint32 elapsedTime)
 			{
 				m_x = 0;
 			}
-			else if (m_x > CApp::GetInstance()->GetScreenWidth() - SPRITE_WIDTH)
+			else if (m_x > m_services->m_screenWidth - SPRITE_WIDTH)
 			{
-				m_x = static_cast<float>(CApp::GetInstance()->GetScreenWidth()) - SPRITE_WIDTH;
+				m_x = static_cast<float>(m_services->m_screenWidth) - SPRITE_WIDTH;
 			}
 		}
 
@@ -105,18 +105,18 @@ void CPlayerShip::Update(Uint32 elapsedTime)
 			{
 				m_y = MOVE_LIMIT_Y;
 			}
-			else if (m_y > CApp::GetInstance()->GetScreenHeight() - SPRITE_HEIGHT)
+			else if (m_y > m_services->m_screenHeight - SPRITE_HEIGHT)
 			{
-				m_y = static_cast<float>(CApp::GetInstance()->GetScreenHeight()) - SPRITE_HEIGHT;
+				m_y = static_cast<float>(m_services->m_screenHeight) - SPRITE_HEIGHT;
 			}
 		}
 
 		if (m_inputData.m_fire == 1)
 		{
-			if (Utils::GetTicks() - m_lastShootTicks > FIRE_COOLDOWN_MS)
+			if (GetGameTicks() - m_lastShootTicks > FIRE_COOLDOWN_MS)
 			{
 				ShootProjectile();
-				m_lastShootTicks = Utils::GetTicks();
+				m_lastShootTicks = GetGameTicks();
 			}
 		}
 
@@ -158,29 +158,27 @@ void CPlayerShip::ShootProjectile()
 	float projectilePosX = m_x + (m_spriteWidth / 2.0f) - (CProjectile::PLAYER_PROJECTILE_SPRITE_WIDTH / 2.0f);
 	float projectilePosY = m_y - CProjectile::PLAYER_PROJECTILE_SPRITE_HEIGHT;
 
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-	ingameState->SpawnProjectile(CProjectile::EProjectileOwner::PLAYER, CProjectile::EProjectileType::REGULAR, projectilePosX, projectilePosY);
+	CGameCommandBuffer* commandBuffer = m_ingameState->GetCommandBuffer();
+	commandBuffer->SpawnProjectile(CProjectile::EProjectileOwner::PLAYER, CProjectile::EProjectileType::REGULAR, projectilePosX, projectilePosY);
 #if SOUND_ENABLED
-	m_shootSound->Play();
+	commandBuffer->PlaySound(m_shootSound);
 #endif
 }
 
 void CPlayerShip::ActivateShield()
 {
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-
-	if (ingameState->IsBossNullifyingPlayerShield())
+	if (m_ingameState->IsBossNullifyingPlayerShield())
 	{
 #if SOUND_ENABLED
-		m_shieldNullifiedSound->Play(SHIELD_NULLIFIED_SOUND_VOLUME);
+		m_ingameState->GetCommandBuffer()->PlaySound(m_shieldNullifiedSound, SHIELD_NULLIFIED_SOUND_VOLUME);
 #endif
 	}
 	else if (m_state == EState::NORMAL)
 	{
-		m_shieldStartTicks = Utils::GetTicks();
+		m_shieldStartTicks = GetGameTicks();
 		m_state = EState::USING_SHIELD;
 #if SOUND_ENABLED
-		m_shieldSound->Play();
+		m_ingameState->GetCommandBuffer()->PlaySound(m_shieldSound);
 #endif
 	}
 }
@@ -189,7 +187,7 @@ void CPlayerShip::UpdateShield()
 {
 	if (m_state == EState::USING_SHIELD)
 	{
-		if (Utils::GetTicks() - m_shieldStartTicks > SHIELD_DURATION)
+		if (GetGameTicks() - m_shieldStartTicks > SHIELD_DURATION)
 		{
 			m_state = EState::NORMAL;
 		}
@@ -199,12 +197,40 @@ void CPlayerShip::UpdateShield()
 void CPlayerShip::Respawn()
 {
 	// put the player back in its initial position
-	SetPosition(m_initialPosX, m_initialPosY);
+	SetPosition(m_initialPosX + m_spawnOffsetX, m_initialPosY);
 	SetIsAlive(true);
 
 	m_state = EState::NORMAL;
 }
 
+// back to how a new game starts
+void CPlayerShip::Reset()
+{
+	m_inputData.Reset();
+	m_lastShootTicks = 0;
+	Respawn();
+}
+
+void CPlayerShip::SaveState(SState* state) const
+{
+	SaveEntityState(&state->m_entity);
+	m_shieldAnimationMgr.SaveState(&state->m_shieldAnimation);
+	state->m_inputData = m_inputData;
+	state->m_state = m_state;
+	state->m_lastShootTicks = m_lastShootTicks;
+	state->m_shieldStartTicks = m_shieldStartTicks;
+}
+
+void CPlayerShip::RestoreState(const SState& state)
+{
+	RestoreEntityState(state.m_entity);
+	m_shieldAnimationMgr.RestoreState(state.m_shieldAnimation);
+	m_inputData = state.m_inputData;
+	m_state = state.m_state;
+	m_lastShootTicks = state.m_lastShootTicks;
+	m_shieldStartTicks = state.m_shieldStartTicks;
+}
+
 void CPlayerShip::OnCollision()
 {
 	if (m_state != EState::USING_SHIELD)
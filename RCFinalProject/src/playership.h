@@ -45,6 +45,12 @@ public:
 			m_fire = 0;
 			m_shield = 0;
 		}
+
+		bool operator==(const SInputData& other) const
+		{
+			return m_up == other.m_up && m_down == other.m_down && m_left == other.m_left && m_right == other.m_right && m_fire == other.m_fire && m_shield == other.m_shield;
+		}
+		bool operator!=(const SInputData& other) const { return !(*this == other); }
 	};
 
 	enum class EState : int
@@ -53,6 +59,16 @@ public:
 		USING_SHIELD,
 	};
 
+	struct SState
+	{
+		SEntityState m_entity;
+		CAnimationManager::SState m_shieldAnimation;
+		SInputData m_inputData;
+		EState m_state;
+		Sint32 m_lastShootTicks;
+		Uint32 m_shieldStartTicks;
+	};
+
 	CPlayerShip();
 
 	void Init(CTexture* spriteSheetTexture);
@@ -69,6 +85,8 @@ public:
 	void SetInputRight(Uint8 v) { m_inputData.m_right = v; }
 	void SetInputFire(Uint8 v) { m_inputData.m_fire = v; }
 	void SetInputShield(Uint8 v) { m_inputData.m_shield = v; }
+	void SetInputData(const SInputData& inputData) { m_inputData = inputData; }
+	const SInputData& GetInputData() const { return m_inputData; }
 
 	void ShootProjectile();
 
@@ -76,6 +94,10 @@ public:
 	void UpdateShield();
 
 	void Respawn();
+	void Reset();
+
+	// where the ship respawns, from the middle of the screen. the ships of a two player game are side by side
+	void SetSpawnOffsetX(float spawnOffsetX) { m_spawnOffsetX = spawnOffsetX; }
 
 	EState GetState() { return m_state; }
 
@@ -83,6 +105,10 @@ public:
 
 	void OnCollision();
 
+	// the ship has to be initialized already
+	void SaveState(SState* state) const;
+	void RestoreState(const SState& state);
+
 	bool IsShieldUp() { return m_state == EState::USING_SHIELD; }
 
 	static const int SPRITE_WIDTH = 122;
@@ -113,6 +139,7 @@ private:
 
 	float m_initialPosX = 0.0f;
 	float m_initialPosY = 0.0f;
+	float m_spawnOffsetX = 0.0f;
 	SInputData m_inputData;
 
 	EState m_state = EState::NORMAL;
@@ -0,0 +1,36 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "playfieldobservation.h"
+
+#include <algorithm>
+#include <string.h>
+
+void SPlayfieldObservation::ClearOccupancy()
+{
+	memset(m_occupancy, 0, sizeof(m_occupancy));
+}
+
+void SPlayfieldObservation::MarkOccupancy(const SDL_Rect& rect, Uint8 occupancy)
+{
+	if (rect.x + rect.w <= 0 || rect.y + rect.h <= 0)
+	{
+		return;
+	}
+
+	// every cell the rect overlaps, clipped to the playfield
+	int firstColumn = std::max(rect.x / OCCUPANCY_CELL_SIZE, 0);
+	int lastColumn = std::min((rect.x + rect.w - 1) / OCCUPANCY_CELL_SIZE, OCCUPANCY_WIDTH - 1);
+	int firstRow = std::max(rect.y / OCCUPANCY_CELL_SIZE, 0);
+	int lastRow = std::min((rect.y + rect.h - 1) / OCCUPANCY_CELL_SIZE, OCCUPANCY_HEIGHT - 1);
+
+	for (int row = firstRow; row <= lastRow; row++)
+	{
+		Uint8* cells = &m_occupancy[row * OCCUPANCY_WIDTH];
+		for (int column = firstColumn; column <= lastColumn; column++)
+		{
+			cells[column] |= occupancy;
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include "preproc.h"
+
+// the state of a game for bots and analytics, written by CIngameState::WriteObservation() whenever it is asked for one
+// (e.g. by CEnvRunner::ObservePlayfields()). fixed size and layout with no pointers, the entities are stored as a struct of arrays: it can be handed to another process or
+// written to a file as is. positions are the centers of the entities in screen pixels, velocities in pixels per second
+struct SPlayfieldObservation
+{
+	static const Uint32 VERSION = 2;
+
+	static const int MAX_PLAYERS = 2;
+	static const int MAX_ENEMIES = 64;
+	static const int MAX_PROJECTILES = 256; // any projectiles past these are left out
+
+	// the optional occupancy raster, the playfield downsampled to one byte per cell
+	static const int OCCUPANCY_CELL_SIZE = 40;
+	static const int OCCUPANCY_WIDTH = (GFX_SCREEN_WIDTH + OCCUPANCY_CELL_SIZE - 1) / OCCUPANCY_CELL_SIZE;
+	static const int OCCUPANCY_HEIGHT = (GFX_SCREEN_HEIGHT + OCCUPANCY_CELL_SIZE - 1) / OCCUPANCY_CELL_SIZE;
+
+	// what overlaps a cell, more than one can be set
+	static const Uint8 OCCUPANCY_PLAYER = 1 << 0;
+	static const Uint8 OCCUPANCY_ENEMY = 1 << 1;
+	static const Uint8 OCCUPANCY_BOSS = 1 << 2;
+	static const Uint8 OCCUPANCY_PLAYER_PROJECTILE = 1 << 3;
+	static const Uint8 OCCUPANCY_ENEMY_PROJECTILE = 1 << 4;
+
+	void ClearOccupancy();
+	void MarkOccupancy(const SDL_Rect& rect, Uint8 occupancy);
+
+	// lets a reader check it is reading the layout it expects
+	Uint32 m_version;
+	Uint32 m_sizeInBytes;
+
+	// game
+	Sint32 m_score;
+	Sint32 m_level;
+	Sint32 m_lives;
+	Uint32 m_state; // CIngameState::EState
+
+	// players, the second one is left zeroed out in a one player game
+	Uint32 m_numPlayers;
+	float m_playerPosX[MAX_PLAYERS];
+	float m_playerPosY[MAX_PLAYERS];
+	Uint8 m_isPlayerAlive[MAX_PLAYERS];
+	Uint8 m_isShieldUp[MAX_PLAYERS];
+	Uint8 m_isShieldNullified;
+	Uint8 m_areEnemiesEnhanced;
+	Uint16 m_unusedPlayers;
+
+	// boss
+	float m_bossPosX;
+	float m_bossPosY;
+	Uint8 m_isBossAlive;
+	Uint8 m_bossType; // CBoss::EBossType
+	Uint8 m_bossState; // CBoss::EState
+	Uint8 m_unused;
+
+	// enemies
+	Uint32 m_numEnemies;
+	float m_enemyPosX[MAX_ENEMIES];
+	float m_enemyPosY[MAX_ENEMIES];
+	Uint8 m_enemyRow[MAX_ENEMIES];
+	Uint8 m_enemyColumn[MAX_ENEMIES];
+	Uint8 m_enemyCanAttack[MAX_ENEMIES];
+
+	// projectiles
+	Uint32 m_numProjectiles;
+	float m_projectilePosX[MAX_PROJECTILES];
+	float m_projectilePosY[MAX_PROJECTILES];
+	float m_projectileVelocityX[MAX_PROJECTILES];
+	float m_projectileVelocityY[MAX_PROJECTILES];
+	Uint8 m_projectileOwner[MAX_PROJECTILES]; // CProjectile::EProjectileOwner
+
+	// row by row, only written if asked for
+	Uint32 m_hasOccupancy;
+	Uint8 m_occupancy[OCCUPANCY_WIDTH * OCCUPANCY_HEIGHT];
+};
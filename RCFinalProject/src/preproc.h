@@ -21,6 +21,9 @@
 #define GFX_SCREEN_HEIGHT								1080
 #define GFX_SCREEN_FULLSCREEN							1
 #define GFX_DIRECTORY									"assets/gfx/"
+#define GFX_STARFIELD_PRERENDERED_LAYERS				1
+// draw and present on a dedicated thread while the game thread updates the next frame
+#define GFX_RENDER_THREAD								1
 
 //-------------------------------------------------------------------------------------------------
 // SOUND SETTINGS
@@ -28,10 +31,35 @@
 
 #define SOUND_ENABLED									1
 #if SOUND_ENABLED
+// the SDL and null audio backends are always available, FMOD only if this is set (see --audio=<backend>)
+#define SOUND_FMOD_ENABLED								1
 #define SOUND_DEFAULT_VOLUME							1.0f
 #define SOUND_DIRECTORY									"assets/sfx/"
+#define SOUND_MAX_CHANNELS								64
+// how many instances of the same sound can play at once, unless set per sound
+#define SOUND_DEFAULT_MAX_VOICES						4
+// a sound played more than once in the same frame only starts once, this much louder per extra play
+#define SOUND_MERGED_EVENT_VOLUME_BOOST					0.1f
+#define SOUND_MAX_MERGED_EVENT_VOLUME					1.0f
 #endif
 
+//-------------------------------------------------------------------------------------------------
+// ASSET SETTINGS
+//-------------------------------------------------------------------------------------------------
+
+// assets no longer in use stay resident up to this size, so switching states does not reload them
+#define ASSET_CACHE_BUDGET_MB							128
+
+// built with the AssetPacker tool, loose files are used for anything not in it (or if it does not exist)
+#define ASSET_ARCHIVE_FILENAME							"assets.pak"
+
+//-------------------------------------------------------------------------------------------------
+// JOB SYSTEM SETTINGS
+//-------------------------------------------------------------------------------------------------
+
+// one job thread per core up to this many, the main thread is one of them
+#define JOBS_MAX_THREADS								16
+
 //-------------------------------------------------------------------------------------------------
 // MAIN GAMEPLAY
 //-------------------------------------------------------------------------------------------------
@@ -54,3 +82,4 @@
 #define DEBUG_DRAW										0
 #define DEBUG_DRAW_ENEMY_FORMATION_EDGES				0
 #define DEBUG_ENABLE_HOTKEYS							0
+#define DEBUG_LOG_PROFILER								0
@@ -0,0 +1,210 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "profiler.h"
+
+#include <algorithm>
+#include <iterator>
+#include "preproc.h"
+#include "utils.h"
+
+CProfiler::CProfiler()
+{
+	std::fill(std::begin(m_startupPhaseMs), std::end(m_startupPhaseMs), -1.0);
+}
+
+void CProfiler::BeginFrame()
+{
+	// roll the counters of the frame that just finished
+	for (int i = 0; i < NUM_COUNTERS; i++)
+	{
+		m_lastFrameCounters[i] = m_currentCounters[i];
+		m_intervalCounters[i] += m_currentCounters[i];
+		m_currentCounters[i] = 0;
+	}
+	m_frameCount++;
+	m_intervalFrameCount++;
+
+#if DEBUG_LOG_PROFILER
+	if (Utils::GetTicks() - m_lastLogTicks > LOG_INTERVAL_MS)
+	{
+		LogCounters();
+		m_lastLogTicks = Utils::GetTicks();
+	}
+#endif
+}
+
+const char* CProfiler::GetCounterName(ECounter counter)
+{
+	switch (counter)
+	{
+	case ECounter::RENDER_STATE_CHANGES:
+		return "render state changes";
+	case ECounter::RENDER_STATE_CHANGES_SKIPPED:
+		return "render state changes skipped";
+	case ECounter::SPRITE_DRAWS:
+		return "sprite draws";
+	case ECounter::SPRITE_DRAWS_TRANSFORMED:
+		return "sprite draws rotated/flipped";
+	case ECounter::ASSET_CACHE_HITS:
+		return "asset cache hits";
+	case ECounter::ASSET_CACHE_MISSES:
+		return "asset cache misses";
+	case ECounter::SOUNDS_PLAYED:
+		return "sounds played";
+	case ECounter::SOUND_VOICES_STOLEN:
+		return "sound voices stolen";
+	case ECounter::AUDIO_MIX_TIME_US:
+		return "audio mix time (us)";
+	case ECounter::SOUND_EVENTS_MERGED:
+		return "sound events merged";
+	case ECounter::JOBS_EXECUTED:
+		return "jobs executed";
+	case ECounter::RENDER_TIME_US:
+		return "render thread time (us)";
+	case ECounter::RENDER_WAIT_TIME_US:
+		return "wait for render thread (us)";
+	case ECounter::ROLLBACKS:
+		return "rollbacks";
+	case ECounter::ROLLBACK_FRAMES_RESIMULATED:
+		return "rollback frames resimulated";
+	case ECounter::ROLLBACK_TIME_US:
+		return "rollback time (us)";
+	case ECounter::ROLLBACK_STALLS:
+		return "rollback stalls";
+	default:
+		return "unknown";
+	}
+}
+
+void CProfiler::RecordJobThreadBusyTime(int threadIndex, Uint64 busyCounter)
+{
+	if (threadIndex < 0 || threadIndex >= JOBS_MAX_THREADS)
+	{
+		return;
+	}
+
+	m_intervalJobThreadBusyCounters[threadIndex] += busyCounter;
+	m_numJobThreads = std::max(m_numJobThreads, threadIndex + 1);
+}
+
+// startCounter is the value of SDL_GetPerformanceCounter() when decoding started
+void CProfiler::RecordAssetDecode(const std::string& path, Uint64 startCounter)
+{
+	double milliseconds = Utils::GetElapsedMs(startCounter);
+	{
+		std::lock_guard<std::mutex> lock(m_assetDecodeMutex);
+		m_totalAssetDecodeTimeMs += milliseconds;
+		m_assetDecodeTimesMs.emplace_back(path, milliseconds);
+	}
+}
+
+double CProfiler::GetTotalAssetDecodeTimeMs()
+{
+	std::lock_guard<std::mutex> lock(m_assetDecodeMutex);
+	return m_totalAssetDecodeTimeMs;
+}
+
+void CProfiler::RecordStartupPhase(EStartupPhase phase, Uint64 startCounter)
+{
+	double& phaseMs = m_startupPhaseMs[static_cast<int>(phase)];
+	if (phaseMs < 0.0)
+	{
+		phaseMs = Utils::GetElapsedMs(startCounter);
+	}
+}
+
+// called after every present until startup is complete, which is once the first state has all its assets loaded
+// and is actually on screen rather than a progress bar
+void CProfiler::RecordFramePresented(bool isLoadingScreen)
+{
+	if (m_firstFrameMs < 0.0)
+	{
+		m_firstFrameMs = Utils::GetElapsedMs(m_startupCounter);
+	}
+
+	if (!isLoadingScreen && m_firstLoadedFrameMs < 0.0)
+	{
+		m_firstLoadedFrameMs = Utils::GetElapsedMs(m_startupCounter);
+	}
+}
+
+const char* CProfiler::GetStartupPhaseName(EStartupPhase phase)
+{
+	switch (phase)
+	{
+	case EStartupPhase::OPEN_ARCHIVE:
+		return "open asset archive";
+	case EStartupPhase::SDL_INIT:
+		return "SDL_Init";
+	case EStartupPhase::CREATE_RENDERER:
+		return "create window and renderer";
+	case EStartupPhase::IMG_INIT:
+		return "IMG_Init";
+	case EStartupPhase::TTF_INIT:
+		return "TTF_Init";
+	case EStartupPhase::LOAD_FONTS:
+		return "load fonts";
+	case EStartupPhase::INIT_AUDIO:
+		return "init audio";
+	case EStartupPhase::INIT_ASSET_LOADER:
+		return "init asset loader";
+	case EStartupPhase::INIT_FIRST_STATE:
+		return "init first state";
+	default:
+		return "unknown";
+	}
+}
+
+// printed in release builds as well, it is the output of the startup benchmark
+void CProfiler::PrintStartupReport()
+{
+	printf("Startup:\n");
+	for (int i = 0; i < NUM_STARTUP_PHASES; i++)
+	{
+		if (m_startupPhaseMs[i] >= 0.0)
+		{
+			printf("  %-28s %9.2f ms\n", GetStartupPhaseName(static_cast<EStartupPhase>(i)), m_startupPhaseMs[i]);
+		}
+	}
+	{
+		std::lock_guard<std::mutex> lock(m_assetDecodeMutex);
+		printf("  %-28s %9.2f ms (all threads)\n", "asset decoding", m_totalAssetDecodeTimeMs);
+		for (const std::pair<std::string, double>& assetDecodeTime : m_assetDecodeTimesMs)
+		{
+			printf("    %-26s %9.2f ms\n", assetDecodeTime.first.c_str(), assetDecodeTime.second);
+		}
+	}
+	printf("  %-28s %9.2f ms\n", "first frame presented", m_firstFrameMs);
+	printf("  %-28s %9.2f ms\n", "first frame fully loaded", m_firstLoadedFrameMs);
+}
+
+void CProfiler::LogCounters()
+{
+	if (m_intervalFrameCount == 0)
+	{
+		return;
+	}
+
+	// print the average of each counter per frame over the last interval
+	LOG_SCR_F("Profiler (%u frames):\n", m_intervalFrameCount);
+	for (int i = 0; i < NUM_COUNTERS; i++)
+	{
+		LOG_SCR_F("  %s: %.2f/frame\n", GetCounterName(static_cast<ECounter>(i)), static_cast<double>(m_intervalCounters[i]) / m_intervalFrameCount);
+		m_intervalCounters[i] = 0;
+	}
+	m_intervalFrameCount = 0;
+
+	// share of the interval each job thread spent running jobs, thread 0 is the main thread
+	Uint64 intervalCounter = SDL_GetPerformanceCounter() - m_intervalStartCounter;
+	for (int i = 0; i < m_numJobThreads; i++)
+	{
+		if (m_intervalStartCounter != 0 && intervalCounter > 0)
+		{
+			LOG_SCR_F("  job thread %d: %.1f%% busy\n", i, 100.0 * m_intervalJobThreadBusyCounters[i] / intervalCounter);
+		}
+		m_intervalJobThreadBusyCounters[i] = 0;
+	}
+	m_intervalStartCounter = SDL_GetPerformanceCounter();
+}
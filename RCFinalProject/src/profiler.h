@@ -0,0 +1,115 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include <mutex>
+#include "preproc.h"
+#include <string>
+#include <utility>
+#include <vector>
+
+// collects per-frame counters from the engine subsystems
+class CProfiler
+{
+public:
+	enum class ECounter : int
+	{
+		RENDER_STATE_CHANGES,
+		RENDER_STATE_CHANGES_SKIPPED,
+		SPRITE_DRAWS,
+		SPRITE_DRAWS_TRANSFORMED,
+		ASSET_CACHE_HITS,
+		ASSET_CACHE_MISSES,
+		SOUNDS_PLAYED,
+		SOUND_VOICES_STOLEN,
+		AUDIO_MIX_TIME_US,
+		SOUND_EVENTS_MERGED,
+		JOBS_EXECUTED,
+		RENDER_TIME_US,
+		RENDER_WAIT_TIME_US,
+		ROLLBACKS,
+		ROLLBACK_FRAMES_RESIMULATED,
+		ROLLBACK_TIME_US,
+		ROLLBACK_STALLS,
+		COUNT
+	};
+
+	enum class EStartupPhase : int
+	{
+		OPEN_ARCHIVE,
+		SDL_INIT,
+		CREATE_RENDERER,
+		IMG_INIT,
+		TTF_INIT,
+		LOAD_FONTS,
+		INIT_AUDIO,
+		INIT_ASSET_LOADER,
+		INIT_FIRST_STATE,
+		COUNT
+	};
+
+	CProfiler();
+
+	void BeginFrame();
+
+	void IncrementCounter(ECounter counter, Uint32 amount = 1) { m_currentCounters[static_cast<int>(counter)] += amount; }
+
+	// values of the last completed frame
+	Uint32 GetFrameCounter(ECounter counter) { return m_lastFrameCounters[static_cast<int>(counter)]; }
+	Uint32 GetFrameCount() { return m_frameCount; }
+
+	static const char* GetCounterName(ECounter counter);
+
+	// time the job thread spent running jobs, logged as its utilisation over the log interval
+	void RecordJobThreadBusyTime(int threadIndex, Uint64 busyCounter);
+
+	// thread safe, assets are also decoded on the asset loader's worker threads
+	void RecordAssetDecode(const std::string& path, Uint64 startCounter);
+	double GetTotalAssetDecodeTimeMs();
+
+	// time to first frame, measured from BeginStartup(). each phase is only recorded the first time it runs
+	void BeginStartup() { m_startupCounter = SDL_GetPerformanceCounter(); }
+	void RecordStartupPhase(EStartupPhase phase, Uint64 startCounter);
+	// startup is complete with the first frame that shows the game instead of a loading screen
+	void RecordFramePresented(bool isLoadingScreen);
+	bool IsStartupComplete() { return m_firstLoadedFrameMs >= 0.0; }
+	void PrintStartupReport();
+
+	static const char* GetStartupPhaseName(EStartupPhase phase);
+
+private:
+	static const int NUM_COUNTERS = static_cast<int>(ECounter::COUNT);
+	static const int NUM_STARTUP_PHASES = static_cast<int>(EStartupPhase::COUNT);
+	const Uint32 LOG_INTERVAL_MS = 1000;
+
+	void LogCounters();
+
+	Uint32 m_currentCounters[NUM_COUNTERS] = {};
+	Uint32 m_lastFrameCounters[NUM_COUNTERS] = {};
+	Uint64 m_intervalCounters[NUM_COUNTERS] = {};
+	Uint32 m_intervalFrameCount = 0;
+	Uint32 m_frameCount = 0;
+	Uint32 m_lastLogTicks = 0;
+
+	Uint64 m_intervalStartCounter = 0;
+	Uint64 m_intervalJobThreadBusyCounters[JOBS_MAX_THREADS] = {};
+	int m_numJobThreads = 0;
+
+	std::mutex m_assetDecodeMutex;
+	double m_totalAssetDecodeTimeMs = 0.0;
+	// path and decode time of every asset, in the order they finished
+	std::vector<std::pair<std::string, double>> m_assetDecodeTimesMs;
+
+	// negative until recorded
+	Uint64 m_startupCounter = 0;
+	double m_startupPhaseMs[NUM_STARTUP_PHASES];
+	double m_firstFrameMs = -1.0;
+	double m_firstLoadedFrameMs = -1.0;
+};
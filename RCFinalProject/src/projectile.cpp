@@ -26,8 +26,6 @@ void CProjectile::Init(EProjectileOwner owner, EProjectileType projectileType, C
 	m_owner = owner;
 	m_projectileType = projectileType;
 
-	CIngameState* ingameState = dynamic_cast<CIngameState*>(CApp::GetInstance()->GetGameManager()->GetState());
-
 	int spriteWidth = 0;
 	int spriteHeight = 0;
 	EAnimID animId = EAnimID::PLAYER_IDLE;
@@ -52,8 +50,8 @@ void CProjectile::Init(EProjectileOwner owner, EProjectileType projectileType, C
 		if (projectileType == EProjectileType::DIAGONAL)
 		{
 			// calculate the angle between the initial position and the player ship
-			float playerShipX = ingameState->GetPlayerShipPosX();
-			float playerShipY = ingameState->GetPlayerShipPosY();
+			float playerShipX = m_ingameState->GetPlayerShipPosX();
+			float playerShipY = m_ingameState->GetPlayerShipPosY();
 
 			// use arc tangent to determine the angle in radians
 			double angle = atan2(playerShipY - y, playerShipX - x);
@@ -110,8 +108,8 @@ void CProjectile::Update(Uint32 elapsedTime)
 			m_y += moveY;
 		}
 
-		if (m_y < 0.0f || m_y > CApp::GetInstance()->GetScreenHeight() ||
-			m_x < 0.0f || m_x > CApp::GetInstance()->GetScreenWidth())
+		if (m_y < 0.0f || m_y > m_services->m_screenHeight ||
+			m_x < 0.0f || m_x > m_services->m_screenWidth)
 		{
 			SetIsAlive(false);
 		}
@@ -122,9 +120,39 @@ void CProjectile::Update(Uint32 elapsedTime)
 
 void CProjectile::Draw()
 {
+	if (m_rotationAngle != 0.0f && m_rotatedSpriteSheet != nullptr && m_rotatedSpriteSheet->IsCreated())
+	{
+		// use the pre-rotated frames instead of rotating the sprite on every draw
+		m_rotatedSpriteSheet->Draw(static_cast<int>(m_x), static_cast<int>(m_y), m_animationMgr.GetCurrentFrame(), m_rotationAngle);
+		return;
+	}
+
 	m_animationMgr.Draw(static_cast<int>(m_x), static_cast<int>(m_y), m_rotationAngle);
 }
 
+void CProjectile::SaveState(SState* state) const
+{
+	SaveEntityState(&state->m_entity);
+	state->m_owner = m_owner;
+	state->m_projectileType = m_projectileType;
+	state->m_initialPosX = m_initialPosX;
+	state->m_initialPosY = m_initialPosY;
+	state->m_rotationAngle = m_rotationAngle;
+}
+
+void CProjectile::RestoreState(CTexture* spriteSheetTexture, const SState& state)
+{
+	CEntity::Init(spriteSheetTexture);
+	m_animationMgr.Setup(m_animTable, state.m_entity.m_spriteWidth, state.m_entity.m_spriteHeight, spriteSheetTexture);
+
+	RestoreEntityState(state.m_entity);
+	m_owner = state.m_owner;
+	m_projectileType = state.m_projectileType;
+	m_initialPosX = state.m_initialPosX;
+	m_initialPosY = state.m_initialPosY;
+	m_rotationAngle = state.m_rotationAngle;
+}
+
 void CProjectile::OnCollision()
 {
 	SetIsAlive(false);
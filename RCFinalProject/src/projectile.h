@@ -5,6 +5,7 @@
 *************************************************************************************/
 
 #include "entity.h"
+#include "rotatedspritesheet.h"
 #include "texture.h"
 
 class CProjectile : public CEntity
@@ -31,17 +32,38 @@ public:
 		DIAGONAL
 	};
 
+	struct SState
+	{
+		SEntityState m_entity;
+		EProjectileOwner m_owner;
+		EProjectileType m_projectileType;
+		float m_initialPosX;
+		float m_initialPosY;
+		float m_rotationAngle;
+	};
+
 	CProjectile();
 
 	void Init(EProjectileOwner owner, EProjectileType projectileType, CTexture* spriteSheetTexture, float x, float y);
+	void SetRotatedSpriteSheet(CRotatedSpriteSheet* rotatedSpriteSheet) { m_rotatedSpriteSheet = rotatedSpriteSheet; }
 
 	void Update(Uint32 elapsedTime);
 	void Draw();
 
 	void OnCollision();
 
+	// restoring works like Init(), on a new projectile or on one that is reused
+	void SaveState(SState* state) const;
+	void RestoreState(CTexture* spriteSheetTexture, const SState& state);
+
 	EProjectileOwner GetOwner() { return m_owner; }
 
+	// in pixels per second
+	float GetVelocityX() { return m_projectileType == EProjectileType::DIAGONAL ? m_moveSpeedX : 0.0f; }
+	float GetVelocityY() { return m_moveSpeedY; }
+
+	static const SAnimationDef& GetAnimationDef(EAnimID animId) { return m_animTable[static_cast<int>(animId)]; }
+
 	static const int PLAYER_PROJECTILE_SPRITE_WIDTH = 21;
 	static const int PLAYER_PROJECTILE_SPRITE_HEIGHT = 40;
 	const float PLAYER_PROJECTILE_MOVE_SPEED_X = 0.0f;
@@ -52,6 +74,9 @@ public:
 	static const int ENEMY_PROJECTILE_SPRITE_HEIGHT = 60;
 	const float ENEMY_PROJECTILE_MOVE_SPEED = 110;
 	const int ENEMY_PROJECTILE_SPAWN_Y_OFFSET = 80;
+
+	// diagonal projectiles are drawn from a sheet pre-rendered at this many angles
+	static const int ROTATED_SPRITESHEET_ANGLE_STEPS = 32;
 	
 private:
 	// animation
@@ -63,6 +88,7 @@ private:
 	float m_initialPosX = 0.0f;
 	float m_initialPosY = 0.0f;
 	float m_rotationAngle = 0.0f; // only for Projectiles of type DIAGONAL
+	CRotatedSpriteSheet* m_rotatedSpriteSheet = nullptr; // only for Projectiles of type DIAGONAL
 
 	EProjectileOwner m_owner = EProjectileOwner::UNASSIGNED;
 };
\ No newline at end of file
@@ -0,0 +1,34 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "random.h"
+
+void CRandom::Seed(Uint64 seed)
+{
+	// scramble the seed (splitmix64) so that seeds next to each other give unrelated sequences
+	Uint64 state = seed + DEFAULT_STATE;
+	state = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9ull;
+	state = (state ^ (state >> 27)) * 0x94D049BB133111EBull;
+	state = state ^ (state >> 31);
+
+	m_state = state;
+	if (m_state == 0)
+	{
+		m_state = DEFAULT_STATE;
+	}
+}
+
+Uint32 CRandom::GetUint32()
+{
+	m_state ^= m_state >> 12;
+	m_state ^= m_state << 25;
+	m_state ^= m_state >> 27;
+	return static_cast<Uint32>((m_state * 0x2545F4914F6CDD1Dull) >> 32);
+}
+
+Uint32 CRandom::GetUint32(Uint32 min, Uint32 max)
+{
+	Uint64 range = static_cast<Uint64>(max) - min + 1;
+	return min + static_cast<Uint32>(GetUint32() % range);
+}
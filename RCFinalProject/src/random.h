@@ -0,0 +1,34 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+
+// small pseudo random number generator (xorshift64*). every game simulation owns one instead of sharing the global
+// rand(), so simulations running side by side on different threads do not interfere and a seed always plays out
+// the same way
+class CRandom
+{
+public:
+	void Seed(Uint64 seed);
+
+	Uint32 GetUint32();
+
+	// in [min, max]
+	Uint32 GetUint32(Uint32 min, Uint32 max);
+
+	// the whole generator, e.g. to snapshot and restore a game
+	Uint64 GetState() const { return m_state; }
+	void SetState(Uint64 state) { m_state = state != 0 ? state : DEFAULT_STATE; }
+
+private:
+	static const Uint64 DEFAULT_STATE = 0x9E3779B97F4A7C15ull; // the state must never be 0
+
+	Uint64 m_state = DEFAULT_STATE;
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include <stdint.h>
+
+// on-disk layout of a pre-decoded texture (.rtex), written by the AssetPacker tool in place of each PNG:
+//
+//   SRawTextureHeader
+//   pixel data                          m_height rows of m_width * 4 bytes with no padding, either stored as is
+//                                       or compressed as a single LZ4 block (see lz4block.h)
+//
+// the pixels are stored in the format textures are created with, so loading one is a copy (or a decompression)
+// followed by the upload, instead of a PNG decode and a conversion. all values are little endian
+
+const uint32_t RAW_TEXTURE_MAGIC = 0x58455452; // "RTEX"
+const uint32_t RAW_TEXTURE_VERSION = 1;
+const char* const RAW_TEXTURE_EXTENSION = ".rtex";
+
+enum class ERawTextureCompression : uint32_t
+{
+	NONE,
+	LZ4
+};
+
+struct SRawTextureHeader
+{
+	uint32_t m_magic;
+	uint32_t m_version;
+	uint32_t m_width;
+	uint32_t m_height;
+	uint32_t m_pixelFormat; // SDL_PixelFormatEnum value, always SDL_PIXELFORMAT_ARGB8888 for now
+	ERawTextureCompression m_compression;
+	uint32_t m_dataSize; // size of the pixel data as stored
+	uint32_t m_reserved; // keeps uncompressed pixel data 16 byte aligned inside the asset archive
+};
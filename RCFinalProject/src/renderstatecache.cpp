@@ -0,0 +1,106 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "renderstatecache.h"
+
+#include <assert.h>
+#include "profiler.h"
+
+void CRenderStateCache::Init(SDL_Renderer* renderer)
+{
+	assert(renderer != nullptr);
+
+	m_renderer = renderer;
+
+	Invalidate();
+}
+
+void CRenderStateCache::Invalidate()
+{
+	m_isDrawColorValid = false;
+	m_isDrawBlendModeValid = false;
+}
+
+bool CRenderStateCache::ShouldChangeState(bool isRedundant)
+{
+	if (isRedundant)
+	{
+		m_numStateChangesSkipped++;
+	}
+	else
+	{
+		m_numStateChanges++;
+	}
+
+	return !isRedundant;
+}
+
+void CRenderStateCache::CollectStats(CProfiler* profiler)
+{
+	profiler->IncrementCounter(CProfiler::ECounter::RENDER_STATE_CHANGES, m_numStateChanges.exchange(0));
+	profiler->IncrementCounter(CProfiler::ECounter::RENDER_STATE_CHANGES_SKIPPED, m_numStateChangesSkipped.exchange(0));
+}
+
+void CRenderStateCache::SetDrawColor(SDL_Color color)
+{
+	bool isRedundant = m_isDrawColorValid && m_drawColor.r == color.r && m_drawColor.g == color.g && m_drawColor.b == color.b && m_drawColor.a == color.a;
+	if (ShouldChangeState(isRedundant))
+	{
+		SDL_SetRenderDrawColor(m_renderer, color.r, color.g, color.b, color.a);
+		m_drawColor = color;
+		m_isDrawColorValid = true;
+	}
+}
+
+void CRenderStateCache::SetDrawBlendMode(SDL_BlendMode mode)
+{
+	bool isRedundant = m_isDrawBlendModeValid && m_drawBlendMode == mode;
+	if (ShouldChangeState(isRedundant))
+	{
+		SDL_SetRenderDrawBlendMode(m_renderer, mode);
+		m_drawBlendMode = mode;
+		m_isDrawBlendModeValid = true;
+	}
+}
+
+// texture state lives in the SDL_Texture itself and reading it back does not touch the GPU, so it is used
+// as the shadow copy, which also keeps things right when several CTexture objects share an SDL_Texture
+bool CRenderStateCache::SetTextureBlendMode(SDL_Texture* texture, SDL_BlendMode mode)
+{
+	assert(texture != nullptr);
+
+	SDL_BlendMode currentMode;
+	bool isRedundant = SDL_GetTextureBlendMode(texture, &currentMode) == 0 && currentMode == mode;
+	if (ShouldChangeState(isRedundant))
+	{
+		// custom blend modes are not supported by every renderer, let the caller know
+		return SDL_SetTextureBlendMode(texture, mode) == 0;
+	}
+
+	return true;
+}
+
+void CRenderStateCache::SetTextureColorMod(SDL_Texture* texture, Uint8 r, Uint8 g, Uint8 b)
+{
+	assert(texture != nullptr);
+
+	Uint8 currentR, currentG, currentB;
+	bool isRedundant = SDL_GetTextureColorMod(texture, &currentR, &currentG, &currentB) == 0 && currentR == r && currentG == g && currentB == b;
+	if (ShouldChangeState(isRedundant))
+	{
+		SDL_SetTextureColorMod(texture, r, g, b);
+	}
+}
+
+void CRenderStateCache::SetTextureAlphaMod(SDL_Texture* texture, Uint8 a)
+{
+	assert(texture != nullptr);
+
+	Uint8 currentA;
+	bool isRedundant = SDL_GetTextureAlphaMod(texture, &currentA) == 0 && currentA == a;
+	if (ShouldChangeState(isRedundant))
+	{
+		SDL_SetTextureAlphaMod(texture, a);
+	}
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include <atomic>
+
+class CProfiler;
+
+// shadows the SDL renderer/texture state so redundant state changes are never sent to SDL
+class CRenderStateCache
+{
+public:
+	void Init(SDL_Renderer* renderer);
+
+	// forget the shadowed renderer state, e.g. after something outside the cache touched the renderer
+	void Invalidate();
+
+	void SetDrawColor(SDL_Color color);
+	void SetDrawBlendMode(SDL_BlendMode mode);
+
+	bool SetTextureBlendMode(SDL_Texture* texture, SDL_BlendMode mode);
+	void SetTextureColorMod(SDL_Texture* texture, Uint8 r, Uint8 g, Uint8 b);
+	void SetTextureAlphaMod(SDL_Texture* texture, Uint8 a);
+
+	// the cache is used on the render thread, the counts are handed over to the profiler on the game thread
+	void CollectStats(CProfiler* profiler);
+
+private:
+	bool ShouldChangeState(bool isRedundant);
+
+	SDL_Renderer* m_renderer = nullptr;
+	std::atomic<Uint32> m_numStateChanges{ 0 };
+	std::atomic<Uint32> m_numStateChangesSkipped{ 0 };
+
+	SDL_Color m_drawColor{ 0, 0, 0, 0 };
+	SDL_BlendMode m_drawBlendMode = SDL_BLENDMODE_NONE;
+	bool m_isDrawColorValid = false;
+	bool m_isDrawBlendModeValid = false;
+};
@@ -0,0 +1,269 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "renderthread.h"
+
+#include <assert.h>
+#include "profiler.h"
+#include "utils.h"
+
+// set on the render thread, or on the game thread while it does the render thread's work if there is none
+static thread_local bool s_isRenderThread = false;
+
+bool CRenderThread::Init(SDL_Window* window)
+{
+	SDL_GetWindowSize(window, &m_outputWidth, &m_outputHeight);
+
+#if GFX_RENDER_THREAD
+	// the renderer can only be used from the thread that created it
+	m_isStarted = false;
+	m_isShuttingDown = false;
+	m_thread = std::thread(&CRenderThread::RenderThreadMain, this, window);
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_condition.wait(lock, [this]() { return m_isStarted; });
+	if (m_renderer == nullptr)
+	{
+		lock.unlock();
+		m_thread.join();
+		return false;
+	}
+	return true;
+#else
+	return CreateRenderer(window);
+#endif
+}
+
+void CRenderThread::Destroy()
+{
+#if GFX_RENDER_THREAD
+	if (!m_thread.joinable())
+	{
+		return;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isShuttingDown = true;
+	}
+	m_condition.notify_all();
+	m_thread.join();
+#else
+	if (m_renderer != nullptr)
+	{
+		m_drawLists[m_recordIndex].DestroyTextures();
+		SDL_DestroyRenderer(m_renderer);
+	}
+#endif
+	m_renderer = nullptr;
+}
+
+bool CRenderThread::CreateRenderer(SDL_Window* window)
+{
+	m_renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+	if (m_renderer == nullptr)
+	{
+		LOG_SCR_F("Unable to create renderer: %s\n", SDL_GetError());
+		return false;
+	}
+
+	// all renderer state changes go through the cache from now on
+	m_renderStateCache.Init(m_renderer);
+	return true;
+}
+
+void CRenderThread::Execute(const RenderFunction& function)
+{
+	if (s_isRenderThread)
+	{
+		function(m_renderer);
+		return;
+	}
+
+#if GFX_RENDER_THREAD
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_functions.push_back(&function);
+	Uint64 functionNumber = ++m_numFunctionsQueued;
+	m_condition.notify_all();
+	m_condition.wait(lock, [this, functionNumber]() { return m_numFunctionsDone >= functionNumber; });
+#else
+	s_isRenderThread = true;
+	function(m_renderer);
+	s_isRenderThread = false;
+#endif
+}
+
+void CRenderThread::Draw(const CDrawList::SCommand& command)
+{
+	if (s_isRenderThread)
+	{
+		CDrawList::DrawCommand(m_renderer, &m_renderStateCache, command);
+		return;
+	}
+
+	m_drawLists[m_recordIndex].Add(command);
+}
+
+void CRenderThread::DrawLine(int x1, int y1, int x2, int y2, SDL_Color color)
+{
+	CDrawList::SCommand command;
+	command.m_type = CDrawList::ECommandType::LINE;
+	command.m_rect = SDL_Rect{ x1, y1, x2 - x1, y2 - y1 };
+	command.m_color = color;
+	Draw(command);
+}
+
+void CRenderThread::DrawBox(int x, int y, int w, int h, bool fill, SDL_Color foregroundColor, SDL_Color backgroundColor)
+{
+	CDrawList::SCommand command;
+	command.m_rect = SDL_Rect{ x, y, w, h };
+	command.m_blendMode = SDL_BLENDMODE_BLEND;
+
+	if (fill)
+	{
+		command.m_type = CDrawList::ECommandType::FILLED_RECT;
+		command.m_color = backgroundColor;
+		Draw(command);
+	}
+	command.m_type = CDrawList::ECommandType::RECT;
+	command.m_color = foregroundColor;
+	Draw(command);
+}
+
+void CRenderThread::DrawProgressBar(float progress)
+{
+	int x = (m_outputWidth - PROGRESS_BAR_WIDTH) / 2;
+	int y = (m_outputHeight - PROGRESS_BAR_HEIGHT) / 2;
+	SDL_Color transparentColor{ 0, 0, 0, 0 };
+
+	DrawBox(x, y, PROGRESS_BAR_WIDTH, PROGRESS_BAR_HEIGHT, false, PROGRESS_BAR_COLOR, transparentColor);
+	DrawBox(x, y, static_cast<int>(PROGRESS_BAR_WIDTH * progress), PROGRESS_BAR_HEIGHT, true, PROGRESS_BAR_COLOR, PROGRESS_BAR_COLOR);
+}
+
+void CRenderThread::DestroyTexture(SDL_Texture* texture)
+{
+	assert(!s_isRenderThread);
+
+	m_drawLists[m_recordIndex].AddTextureToDestroy(texture);
+}
+
+void CRenderThread::SubmitFrame()
+{
+#if GFX_RENDER_THREAD
+	Uint64 waitStartCounter = SDL_GetPerformanceCounter();
+	{
+		// one frame in flight at most, the game thread does not get more than a frame ahead
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_condition.wait(lock, [this]() { return !m_isFrameSubmitted; });
+		std::swap(m_recordIndex, m_drawIndex);
+		m_isFrameSubmitted = true;
+	}
+	m_condition.notify_all();
+	m_waitTimeUs += static_cast<Uint32>(Utils::GetElapsedMs(waitStartCounter) * 1000.0);
+#else
+	s_isRenderThread = true;
+	DrawFrame(m_drawLists[m_recordIndex]);
+	s_isRenderThread = false;
+#endif
+
+	// already drawn, either earlier or just now
+	m_drawLists[m_recordIndex].Clear();
+}
+
+void CRenderThread::WaitForPresent()
+{
+#if GFX_RENDER_THREAD
+	std::unique_lock<std::mutex> lock(m_mutex);
+	m_condition.wait(lock, [this]() { return !m_isFrameSubmitted; });
+#endif
+}
+
+bool CRenderThread::IsRenderThread()
+{
+	return s_isRenderThread;
+}
+
+void CRenderThread::CollectStats(CProfiler* profiler)
+{
+	profiler->IncrementCounter(CProfiler::ECounter::RENDER_TIME_US, m_renderTimeUs.exchange(0));
+	profiler->IncrementCounter(CProfiler::ECounter::RENDER_WAIT_TIME_US, m_waitTimeUs);
+	m_waitTimeUs = 0;
+	m_renderStateCache.CollectStats(profiler);
+}
+
+void CRenderThread::DrawFrame(CDrawList& drawList)
+{
+	Uint64 startCounter = SDL_GetPerformanceCounter();
+
+	// the draw color is shared with the primitives and render targets, make sure the screen is cleared to black
+	m_renderStateCache.SetDrawColor(CLEAR_COLOR);
+	SDL_RenderClear(m_renderer);
+
+	drawList.Draw(m_renderer, &m_renderStateCache);
+	SDL_RenderPresent(m_renderer);
+
+	// nothing uses them anymore, the frames recorded after this one were recorded after they were destroyed
+	drawList.DestroyTextures();
+
+	m_renderTimeUs += static_cast<Uint32>(Utils::GetElapsedMs(startCounter) * 1000.0);
+}
+
+#if GFX_RENDER_THREAD
+void CRenderThread::RenderThreadMain(SDL_Window* window)
+{
+	s_isRenderThread = true;
+
+	bool isCreated = CreateRenderer(window);
+	{
+		std::lock_guard<std::mutex> lock(m_mutex);
+		m_isStarted = true;
+	}
+	m_condition.notify_all();
+
+	if (!isCreated)
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lock(m_mutex);
+	while (true)
+	{
+		m_condition.wait(lock, [this]() { return !m_functions.empty() || m_isFrameSubmitted || m_isShuttingDown; });
+
+		// the game thread is blocked until it is done, take care of it first
+		if (!m_functions.empty())
+		{
+			const RenderFunction* function = m_functions.front();
+			m_functions.pop_front();
+
+			lock.unlock();
+			(*function)(m_renderer);
+			lock.lock();
+
+			m_numFunctionsDone++;
+			m_condition.notify_all();
+			continue;
+		}
+
+		if (m_isFrameSubmitted)
+		{
+			lock.unlock();
+			DrawFrame(m_drawLists[m_drawIndex]);
+			lock.lock();
+
+			m_isFrameSubmitted = false;
+			m_condition.notify_all();
+			continue;
+		}
+
+		// shutting down, and nothing left to do
+		break;
+	}
+	lock.unlock();
+
+	// textures destroyed after the last frame was submitted
+	m_drawLists[m_recordIndex].DestroyTextures();
+	SDL_DestroyRenderer(m_renderer);
+}
+#endif
@@ -0,0 +1,111 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include "drawlist.h"
+#include <functional>
+#include <mutex>
+#include "preproc.h"
+#include "renderstatecache.h"
+#include <thread>
+
+class CProfiler;
+
+// owns the SDL renderer and draws the frames on its own thread, so the game thread can update the next frame while
+// the last one is drawn and presented. the game thread records each frame into a draw list, the two lists are
+// swapped when the frame is submitted. nothing but the render thread talks to the renderer: the game thread creates
+// textures and renders into render targets through Execute(), which waits for the render thread to do it.
+// with GFX_RENDER_THREAD set to 0 everything runs on the game thread, in the same order
+class CRenderThread
+{
+public:
+	typedef std::function<void(SDL_Renderer*)> RenderFunction;
+
+	// returns false if the renderer could not be created
+	bool Init(SDL_Window* window);
+	void Destroy();
+
+	// runs the function on the render thread between two frames and waits for it. runs it right away if called on
+	// the render thread, e.g. from inside another function passed to Execute()
+	void Execute(const RenderFunction& function);
+
+	// recorded into the frame being built on the game thread, drawn right away on the render thread (e.g. to render
+	// into a render target from inside Execute())
+	void Draw(const CDrawList::SCommand& command);
+
+	// primitives, recorded like any other draw. lines are drawn opaque, boxes are blended
+	void DrawLine(int x1, int y1, int x2, int y2, SDL_Color color);
+	void DrawBox(int x, int y, int w, int h, bool fill, SDL_Color foregroundColor, SDL_Color backgroundColor);
+
+	// centered bar for states that are waiting on the asset loader, progress goes from 0.0f to 1.0f
+	void DrawProgressBar(float progress);
+
+	// game thread. the texture may still be used by the frames that were submitted, it is destroyed once the frame
+	// being built has been presented
+	void DestroyTexture(SDL_Texture* texture);
+
+	// game thread. hands the recorded frame over to the render thread and starts recording the next one, waits if the
+	// render thread is still busy with the previous frame
+	void SubmitFrame();
+
+	// game thread. blocks until the render thread has presented the last submitted frame, e.g. to time what is on
+	// screen. frames are presented before SubmitFrame() returns without GFX_RENDER_THREAD
+	void WaitForPresent();
+
+	bool IsRenderThread();
+
+	// render thread only
+	CRenderStateCache* GetRenderStateCache() { return &m_renderStateCache; }
+
+	// adds the time spent drawing and waiting for the render thread since the last call to the profiler
+	void CollectStats(CProfiler* profiler);
+
+private:
+	const SDL_Color CLEAR_COLOR{ 0, 0, 0, 255 };
+
+	// loading progress bar
+	const int PROGRESS_BAR_WIDTH = 600;
+	const int PROGRESS_BAR_HEIGHT = 20;
+	const SDL_Color PROGRESS_BAR_COLOR{ 255, 255, 0, 255 };
+
+	bool CreateRenderer(SDL_Window* window);
+	void DrawFrame(CDrawList& drawList);
+#if GFX_RENDER_THREAD
+	void RenderThreadMain(SDL_Window* window);
+#endif
+
+	SDL_Renderer* m_renderer = nullptr;
+	CRenderStateCache m_renderStateCache;
+	int m_outputWidth = 0;
+	int m_outputHeight = 0;
+
+	// the game thread records into one list while the render thread draws the other
+	CDrawList m_drawLists[2];
+	int m_recordIndex = 0;
+	int m_drawIndex = 1;
+
+	std::atomic<Uint32> m_renderTimeUs{ 0 };
+	Uint32 m_waitTimeUs = 0; // game thread
+
+#if GFX_RENDER_THREAD
+	std::thread m_thread;
+	std::mutex m_mutex;
+	std::condition_variable m_condition;
+	std::deque<const RenderFunction*> m_functions; // the callers wait, so they stay alive until done
+	Uint64 m_numFunctionsQueued = 0;
+	Uint64 m_numFunctionsDone = 0;
+	bool m_isStarted = false;
+	bool m_isFrameSubmitted = false;
+	bool m_isShuttingDown = false;
+#endif
+};
@@ -0,0 +1,213 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "rollbacksession.h"
+
+#include <assert.h>
+#include "profiler.h"
+#include "utils.h"
+
+void CRollbackSession::Init(CIngameState* ingameState, CInputTransport* transport, Uint8 localPlayerIndex)
+{
+	assert(localPlayerIndex < NUM_PLAYERS);
+
+	m_ingameState = ingameState;
+	m_transport = transport;
+	m_localPlayerIndex = localPlayerIndex;
+	m_remotePlayerIndex = localPlayerIndex == 0 ? 1 : 0;
+	m_snapshots = new CIngameState::SSnapshot[MAX_ROLLBACK_FRAMES];
+
+	LOG_SCR_F("Rollback session initialized: local player %d, %d frames (%u KB of snapshots)\n", m_localPlayerIndex, MAX_ROLLBACK_FRAMES, (unsigned int)(sizeof(CIngameState::SSnapshot) * MAX_ROLLBACK_FRAMES / 1024));
+	Reset();
+}
+
+void CRollbackSession::Destroy()
+{
+	delete[] m_snapshots;
+	m_snapshots = nullptr;
+}
+
+void CRollbackSession::Reset()
+{
+	m_frame = 0;
+	m_firstUnconfirmedFrame = 0;
+	m_rollbackFrame = NO_ROLLBACK;
+	m_accumulatedTime = 0;
+	for (SInputSlot& slot : m_inputSlots)
+	{
+		slot.m_isUsed = false;
+	}
+
+	m_lastRemoteInput.Reset();
+	m_lastRemoteFrame = 0;
+	m_hasRemoteInput = false;
+}
+
+void CRollbackSession::Update(Uint32 elapsedTime, const CPlayerShip::SInputData& localInput)
+{
+	// fix the past first, the new frames build on it
+	ReceiveRemoteInputs();
+	if (m_rollbackFrame != NO_ROLLBACK)
+	{
+		Rollback();
+	}
+
+	m_accumulatedTime += elapsedTime;
+	int numFrames = 0;
+	while (m_accumulatedTime >= FRAME_MS && numFrames < MAX_FRAMES_PER_UPDATE)
+	{
+		// never get further ahead of the other player than the snapshots go back, wait for its input instead
+		int numFramesAhead = static_cast<int>(m_frame) - static_cast<int>(m_firstUnconfirmedFrame);
+		if (numFramesAhead >= MAX_ROLLBACK_FRAMES)
+		{
+			CProfiler* profiler = m_ingameState->GetServices()->m_profiler;
+			if (profiler != nullptr)
+			{
+				profiler->IncrementCounter(CProfiler::ECounter::ROLLBACK_STALLS);
+			}
+			break;
+		}
+
+		AdvanceFrame(localInput);
+		m_accumulatedTime -= FRAME_MS;
+		numFrames++;
+	}
+
+	// the time that could not be run is dropped, the game slows down instead of catching up in bursts
+	if (m_accumulatedTime > FRAME_MS)
+	{
+		m_accumulatedTime = FRAME_MS;
+	}
+}
+
+CRollbackSession::SInputSlot& CRollbackSession::GetInputSlot(Uint32 frame)
+{
+	SInputSlot& slot = m_inputSlots[frame % NUM_INPUT_SLOTS];
+	if (!slot.m_isUsed || slot.m_frame != frame)
+	{
+		// the frame it held is too old to be rolled back to
+		slot.m_frame = frame;
+		slot.m_isUsed = true;
+		slot.m_isRemoteConfirmed = false;
+		for (CPlayerShip::SInputData& inputData : slot.m_inputs)
+		{
+			inputData.Reset();
+		}
+	}
+	return slot;
+}
+
+void CRollbackSession::ReceiveRemoteInputs()
+{
+	SInputMessage message;
+	while (m_transport->Receive(&message))
+	{
+		// already known, or too far ahead to keep
+		Uint32 frame = message.m_frame;
+		if (message.m_playerIndex != m_remotePlayerIndex || frame < m_firstUnconfirmedFrame || frame >= m_frame + MAX_ROLLBACK_FRAMES)
+		{
+			continue;
+		}
+
+		SInputSlot& slot = GetInputSlot(frame);
+		if (slot.m_isRemoteConfirmed)
+		{
+			continue;
+		}
+
+		// the frame already ran with a prediction, it has to run again if the prediction was wrong
+		if (frame < m_frame && slot.m_inputs[m_remotePlayerIndex] != message.m_inputData && frame < m_rollbackFrame)
+		{
+			m_rollbackFrame = frame;
+		}
+		slot.m_inputs[m_remotePlayerIndex] = message.m_inputData;
+		slot.m_isRemoteConfirmed = true;
+
+		if (!m_hasRemoteInput || frame > m_lastRemoteFrame)
+		{
+			m_lastRemoteInput = message.m_inputData;
+			m_lastRemoteFrame = frame;
+			m_hasRemoteInput = true;
+		}
+	}
+
+	// the inputs may arrive out of order
+	while (true)
+	{
+		const SInputSlot& slot = m_inputSlots[m_firstUnconfirmedFrame % NUM_INPUT_SLOTS];
+		if (!slot.m_isUsed || slot.m_frame != m_firstUnconfirmedFrame || !slot.m_isRemoteConfirmed)
+		{
+			break;
+		}
+		m_firstUnconfirmedFrame++;
+	}
+}
+
+void CRollbackSession::AdvanceFrame(const CPlayerShip::SInputData& localInput)
+{
+	SInputSlot& slot = GetInputSlot(m_frame);
+	slot.m_inputs[m_localPlayerIndex] = localInput;
+	if (!slot.m_isRemoteConfirmed)
+	{
+		// the other player most likely still presses what it pressed last
+		slot.m_inputs[m_remotePlayerIndex] = m_lastRemoteInput;
+	}
+
+	SInputMessage message;
+	message.m_frame = m_frame;
+	message.m_playerIndex = m_localPlayerIndex;
+	message.m_inputData = localInput;
+	m_transport->Send(message);
+
+	SimulateFrame(m_frame);
+	m_frame++;
+}
+
+void CRollbackSession::SimulateFrame(Uint32 frame)
+{
+	if (!m_ingameState->SaveSnapshot(&m_snapshots[frame % MAX_ROLLBACK_FRAMES]))
+	{
+		// the game goes on, it just can not come back to this frame correctly
+		LOG_SCR_F("Rollback snapshot of frame %u is incomplete\n", frame);
+	}
+
+	const SInputSlot& slot = GetInputSlot(frame);
+	for (int i = 0; i < NUM_PLAYERS; i++)
+	{
+		m_ingameState->SetPlayerInput(i, slot.m_inputs[i]);
+	}
+	m_ingameState->Tick(FRAME_MS);
+}
+
+void CRollbackSession::Rollback()
+{
+	Uint64 startCounter = SDL_GetPerformanceCounter();
+	Uint32 rollbackFrame = m_rollbackFrame;
+	m_rollbackFrame = NO_ROLLBACK;
+	assert(m_frame - rollbackFrame <= static_cast<Uint32>(MAX_ROLLBACK_FRAMES));
+
+	m_ingameState->RestoreSnapshot(m_snapshots[rollbackFrame % MAX_ROLLBACK_FRAMES]);
+
+	// the sounds were played and the text updated when the frames first ran
+	m_ingameState->SetIsResimulating(true);
+	for (Uint32 frame = rollbackFrame; frame < m_frame; frame++)
+	{
+		SInputSlot& slot = GetInputSlot(frame);
+		if (!slot.m_isRemoteConfirmed)
+		{
+			// predict again with what is known now
+			slot.m_inputs[m_remotePlayerIndex] = m_lastRemoteInput;
+		}
+		SimulateFrame(frame);
+	}
+	m_ingameState->SetIsResimulating(false);
+
+	CProfiler* profiler = m_ingameState->GetServices()->m_profiler;
+	if (profiler != nullptr)
+	{
+		profiler->IncrementCounter(CProfiler::ECounter::ROLLBACKS);
+		profiler->IncrementCounter(CProfiler::ECounter::ROLLBACK_FRAMES_RESIMULATED, m_frame - rollbackFrame);
+		profiler->IncrementCounter(CProfiler::ECounter::ROLLBACK_TIME_US, static_cast<Uint32>(Utils::GetElapsedMs(startCounter) * 1000.0));
+	}
+}
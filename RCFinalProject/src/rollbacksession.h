@@ -0,0 +1,78 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include "ingamestate.h"
+#include "inputtransport.h"
+
+// runs a two player game in fixed frames without waiting for the other player's input. the frame is simulated
+// with the input the other player last sent (a prediction), and the state before each frame is kept as a snapshot.
+// when the real input of an earlier frame turns out to be different, the game goes back to that frame's snapshot
+// and runs the frames since then again with what is known now. the local player never waits for the network unless
+// the other player falls more than MAX_ROLLBACK_FRAMES behind
+class CRollbackSession
+{
+public:
+	static const int NUM_PLAYERS = 2;
+	static const int MAX_ROLLBACK_FRAMES = 8;
+	static const Uint32 FRAME_MS = 16;
+
+	void Init(CIngameState* ingameState, CInputTransport* transport, Uint8 localPlayerIndex);
+	void Destroy();
+
+	// back to frame 0, e.g. when a new game starts
+	void Reset();
+
+	// runs as many frames as fit in the elapsed time, with the local player's current input
+	void Update(Uint32 elapsedTime, const CPlayerShip::SInputData& localInput);
+
+	Uint32 GetFrame() { return m_frame; }
+
+private:
+	// frames are never run more than this many at once, the game slows down instead of falling further behind
+	const int MAX_FRAMES_PER_UPDATE = 4;
+
+	static const Uint32 NO_ROLLBACK = 0xFFFFFFFF;
+
+	// the inputs of frames that were run, or whose remote input arrived already
+	static const int NUM_INPUT_SLOTS = MAX_ROLLBACK_FRAMES * 2;
+	struct SInputSlot
+	{
+		Uint32 m_frame = 0;
+		bool m_isUsed = false;
+		bool m_isRemoteConfirmed = false;
+		CPlayerShip::SInputData m_inputs[NUM_PLAYERS];
+	};
+
+	SInputSlot& GetInputSlot(Uint32 frame);
+	void ReceiveRemoteInputs();
+	void AdvanceFrame(const CPlayerShip::SInputData& localInput);
+	void SimulateFrame(Uint32 frame);
+	void Rollback();
+
+	CIngameState* m_ingameState = nullptr;
+	CInputTransport* m_transport = nullptr;
+	Uint8 m_localPlayerIndex = 0;
+	Uint8 m_remotePlayerIndex = 1;
+
+	// the state before each of the last frames, by frame % MAX_ROLLBACK_FRAMES. allocated once
+	CIngameState::SSnapshot* m_snapshots = nullptr;
+	SInputSlot m_inputSlots[NUM_INPUT_SLOTS];
+
+	Uint32 m_frame = 0; // the next frame to run
+	Uint32 m_firstUnconfirmedFrame = 0; // the remote input of every frame before this one has arrived
+	Uint32 m_rollbackFrame = NO_ROLLBACK; // the earliest frame that was run with a wrong prediction
+	Uint32 m_accumulatedTime = 0;
+
+	// the prediction for the frames the remote input has not arrived for
+	CPlayerShip::SInputData m_lastRemoteInput;
+	Uint32 m_lastRemoteFrame = 0;
+	bool m_hasRemoteInput = false;
+};
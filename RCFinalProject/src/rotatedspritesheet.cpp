@@ -0,0 +1,97 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "rotatedspritesheet.h"
+
+#include <assert.h>
+#include "renderthread.h"
+#include <cmath>
+#include "utils.h"
+
+bool CRotatedSpriteSheet::Create(CTexture* sourceTexture, const SDL_Rect& firstFrameRect, int numFrames, int numAngleSteps)
+{
+	assert(sourceTexture != nullptr && sourceTexture->IsCreated());
+	assert(numFrames > 0 && numAngleSteps > 0);
+
+	// every cell must be big enough to contain the frame rotated at any angle
+	m_cellSize = static_cast<int>(ceil(sqrt(static_cast<double>(firstFrameRect.w * firstFrameRect.w + firstFrameRect.h * firstFrameRect.h))));
+	m_offsetX = (m_cellSize - firstFrameRect.w) / 2;
+	m_offsetY = (m_cellSize - firstFrameRect.h) / 2;
+	m_numFrames = numFrames;
+	m_numAngleSteps = numAngleSteps;
+	m_sourceTexture = sourceTexture;
+	m_firstFrameRect = firstFrameRect;
+
+	if (!Redraw())
+	{
+		return false;
+	}
+
+	LOG_SCR_F("Rotated spritesheet created: %d frames, %d angles, %dx%d\n", numFrames, numAngleSteps, m_texture.GetWidth(), m_texture.GetHeight());
+	return true;
+}
+
+bool CRotatedSpriteSheet::Redraw()
+{
+	assert(m_sourceTexture != nullptr && m_sourceTexture->IsCreated());
+
+	// a new target, after a device reset the old one is gone along with its contents. one column per frame, one row
+	// per angle
+	int numFrames = m_numFrames;
+	int numAngleSteps = m_numAngleSteps;
+	if (!m_texture.CreateRenderTarget(m_cellSize * numFrames, m_cellSize * numAngleSteps))
+	{
+		return false;
+	}
+
+	CTexture* sourceTexture = m_sourceTexture;
+	const SDL_Rect& firstFrameRect = m_firstFrameRect;
+	CRenderThread* renderThread = m_services->m_renderThread;
+	renderThread->Execute([&](SDL_Renderer* renderer)
+	{
+		SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+
+		SDL_SetRenderTarget(renderer, m_texture.GetSDLTexture());
+		renderThread->GetRenderStateCache()->SetDrawColor(SDL_Color{ 0, 0, 0, 0 });
+		SDL_RenderClear(renderer);
+
+		// copy the frames as they are, blending them against the transparent target would darken the edges
+		sourceTexture->SetBlendMode(SDL_BLENDMODE_NONE);
+		for (int i = 0; i < numAngleSteps; i++)
+		{
+			double angle = 360.0 * i / numAngleSteps;
+			for (int j = 0; j < numFrames; j++)
+			{
+				SDL_Rect srcRect{ firstFrameRect.x + firstFrameRect.w * j, firstFrameRect.y, firstFrameRect.w, firstFrameRect.h };
+				SDL_Rect dstRect{ m_cellSize * j + m_offsetX, m_cellSize * i + m_offsetY, firstFrameRect.w, firstFrameRect.h };
+				SDL_RenderCopyEx(renderer, sourceTexture->GetSDLTexture(), &srcRect, &dstRect, angle, nullptr, SDL_FLIP_NONE);
+			}
+		}
+		sourceTexture->SetBlendMode(SDL_BLENDMODE_BLEND);
+
+		SDL_SetRenderTarget(renderer, previousTarget);
+	});
+
+	return true;
+}
+
+void CRotatedSpriteSheet::Destroy()
+{
+	m_texture.Destroy();
+}
+
+int CRotatedSpriteSheet::GetAngleStepIndex(double angleInDegrees)
+{
+	double anglePerStep = 360.0 / m_numAngleSteps;
+	int index = static_cast<int>(floor(angleInDegrees / anglePerStep + 0.5)) % m_numAngleSteps;
+	return index < 0 ? index + m_numAngleSteps : index;
+}
+
+void CRotatedSpriteSheet::Draw(int x, int y, int frame, double angleInDegrees)
+{
+	assert(frame >= 0 && frame < m_numFrames);
+
+	SDL_Rect srcRect{ m_cellSize * frame, m_cellSize * GetAngleStepIndex(angleInDegrees), m_cellSize, m_cellSize };
+	m_texture.Draw(x - m_offsetX, y - m_offsetY, &srcRect);
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
+#include "texture.h"
+
+// spritesheet of animation frames pre-rendered at a fixed set of angles so rotated sprites can be drawn
+// with a plain copy instead of rotating them every frame
+class CRotatedSpriteSheet
+{
+public:
+	explicit CRotatedSpriteSheet(const SServices* services) : m_services(services), m_texture(services) {}
+
+	bool Create(CTexture* sourceTexture, const SDL_Rect& firstFrameRect, int numFrames, int numAngleSteps);
+	void Destroy();
+
+	// the frames live in a render target, the renderer loses them when its render targets or the device are reset
+	// (e.g. Direct3D 9 after Alt-Tab). renders them again from the source texture
+	bool Redraw();
+
+	// draws the frame at the closest pre-rendered angle, x/y is the position the unrotated frame would be drawn at
+	void Draw(int x, int y, int frame, double angleInDegrees);
+
+	int GetAngleStepIndex(double angleInDegrees);
+
+	bool IsCreated() { return m_texture.IsCreated(); }
+
+private:
+	const SServices* m_services = nullptr;
+	CTexture m_texture;
+	CTexture* m_sourceTexture = nullptr;
+	SDL_Rect m_firstFrameRect{ 0, 0, 0, 0 };
+	int m_cellSize = 0;
+	int m_offsetX = 0;
+	int m_offsetY = 0;
+	int m_numFrames = 0;
+	int m_numAngleSteps = 0;
+};
@@ -0,0 +1,253 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+#include "sdlaudiobackend.h"
+
+#include <algorithm>
+#include "assetarchive.h"
+#include <string.h>
+#include "utils.h"
+
+bool CSdlAudioBackend::Init(CAssetArchive* assetArchive)
+{
+	m_assetArchive = assetArchive;
+
+	LOG_SCR("Initializing SDL audio");
+
+	if (SDL_InitSubSystem(SDL_INIT_AUDIO) < 0)
+	{
+		LOG_SCR_F("Unable to initialize SDL audio: %s\n", SDL_GetError());
+		return false;
+	}
+
+	// SDL converts to whatever the device actually wants
+	SDL_AudioSpec desiredSpec{};
+	desiredSpec.freq = SAMPLE_RATE;
+	desiredSpec.format = AUDIO_F32SYS;
+	desiredSpec.channels = NUM_CHANNELS;
+	desiredSpec.samples = BUFFER_SAMPLES;
+	desiredSpec.callback = &CSdlAudioBackend::AudioCallback;
+	desiredSpec.userdata = this;
+
+	m_device = SDL_OpenAudioDevice(nullptr, 0, &desiredSpec, &m_spec, 0);
+	if (m_device == 0)
+	{
+		LOG_SCR_F("Unable to open audio device: %s\n", SDL_GetError());
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+		return false;
+	}
+
+	LOG_SCR_F("Opened audio device: %s (%d Hz)\n", SDL_GetCurrentAudioDriver(), m_spec.freq);
+	SDL_PauseAudioDevice(m_device, 0);
+	return true;
+}
+
+void CSdlAudioBackend::Destroy()
+{
+	LOG_SCR("Cleaning up SDL audio");
+
+	if (m_device != 0)
+	{
+		SDL_CloseAudioDevice(m_device);
+		m_device = 0;
+		SDL_QuitSubSystem(SDL_INIT_AUDIO);
+	}
+}
+
+CAudioBackend::SoundHandle CSdlAudioBackend::CreateSound(const std::string& path)
+{
+	SDL_RWops* file = m_assetArchive->OpenAsset(path);
+	if (file == nullptr)
+	{
+		LOG_SCR_F("Unable to open sound: %s\n", path.c_str());
+		return nullptr;
+	}
+
+	SSound* sound = new SSound;
+
+	SDL_AudioSpec wavSpec;
+	Uint8* wavBuffer = nullptr;
+	Uint32 wavLength = 0;
+	if (SDL_LoadWAV_RW(file, 1, &wavSpec, &wavBuffer, &wavLength) == nullptr)
+	{
+		LOG_SCR_F("Sound format not supported by the SDL mixer, it will play silence: %s\n", path.c_str());
+		return sound;
+	}
+
+	// resample to the device rate as float stereo
+	SDL_AudioCVT converter;
+	if (SDL_BuildAudioCVT(&converter, wavSpec.format, wavSpec.channels, wavSpec.freq, AUDIO_F32SYS, NUM_CHANNELS, m_spec.freq) < 0)
+	{
+		LOG_SCR_F("Unable to convert sound: %s (%s)\n", path.c_str(), SDL_GetError());
+		SDL_FreeWAV(wavBuffer);
+		return sound;
+	}
+
+	std::vector<Uint8> buffer(static_cast<size_t>(wavLength) * converter.len_mult);
+	memcpy(buffer.data(), wavBuffer, wavLength);
+	SDL_FreeWAV(wavBuffer);
+
+	converter.buf = buffer.data();
+	converter.len = static_cast<int>(wavLength);
+	if (converter.needed && SDL_ConvertAudio(&converter) < 0)
+	{
+		LOG_SCR_F("Unable to convert sound: %s (%s)\n", path.c_str(), SDL_GetError());
+		return sound;
+	}
+
+	size_t convertedLength = converter.needed ? static_cast<size_t>(converter.len_cvt) : wavLength;
+	sound->m_samples.resize(convertedLength / sizeof(float));
+	memcpy(sound->m_samples.data(), buffer.data(), sound->m_samples.size() * sizeof(float));
+	return sound;
+}
+
+void CSdlAudioBackend::ReleaseSound(SoundHandle sound)
+{
+	// voices nobody keeps track of anymore may still be playing it
+	SDL_LockAudioDevice(m_device);
+	for (SVoice& voice : m_voices)
+	{
+		if (voice.m_sound == sound)
+		{
+			voice.m_isPlaying = false;
+			voice.m_sound = nullptr;
+		}
+	}
+	SDL_UnlockAudioDevice(m_device);
+
+	delete static_cast<SSound*>(sound);
+}
+
+size_t CSdlAudioBackend::GetSoundSizeInBytes(SoundHandle sound)
+{
+	return static_cast<SSound*>(sound)->m_samples.size() * sizeof(float);
+}
+
+// the mixing happens in the SDL audio callback
+void CSdlAudioBackend::Update()
+{
+}
+
+// handles are the voice index in the low bits and a generation count in the high bits, so the handle of a voice
+// that finished does not refer to whatever plays in its slot next
+CAudioBackend::VoiceHandle CSdlAudioBackend::PlaySound(SoundHandle sound, float volume, bool isLooping)
+{
+	const SSound* sdlSound = static_cast<const SSound*>(sound);
+	VoiceHandle handle = INVALID_VOICE;
+
+	SDL_LockAudioDevice(m_device);
+	for (int i = 0; i < MAX_VOICES; i++)
+	{
+		SVoice& voice = m_voices[i];
+		if (!voice.m_isPlaying)
+		{
+			voice.m_sound = sdlSound;
+			voice.m_position = 0;
+			voice.m_volume = volume;
+			voice.m_generation++;
+			voice.m_isLooping = isLooping;
+			voice.m_isPlaying = true;
+			handle = (static_cast<VoiceHandle>(voice.m_generation) << 32) | (i + 1);
+			break;
+		}
+	}
+	SDL_UnlockAudioDevice(m_device);
+
+	return handle;
+}
+
+CSdlAudioBackend::SVoice* CSdlAudioBackend::GetVoice(VoiceHandle voice)
+{
+	int index = static_cast<int>(voice & 0xFFFFFFFF) - 1;
+	if (index < 0 || index >= MAX_VOICES || m_voices[index].m_generation != static_cast<Uint32>(voice >> 32) || !m_voices[index].m_isPlaying)
+	{
+		return nullptr;
+	}
+
+	return &m_voices[index];
+}
+
+void CSdlAudioBackend::StopVoice(VoiceHandle voice)
+{
+	SDL_LockAudioDevice(m_device);
+	SVoice* sdlVoice = GetVoice(voice);
+	if (sdlVoice != nullptr)
+	{
+		sdlVoice->m_isPlaying = false;
+	}
+	SDL_UnlockAudioDevice(m_device);
+}
+
+bool CSdlAudioBackend::IsVoicePlaying(VoiceHandle voice)
+{
+	SDL_LockAudioDevice(m_device);
+	bool isPlaying = GetVoice(voice) != nullptr;
+	SDL_UnlockAudioDevice(m_device);
+	return isPlaying;
+}
+
+float CSdlAudioBackend::GetVoiceAudibility(VoiceHandle voice)
+{
+	SDL_LockAudioDevice(m_device);
+	SVoice* sdlVoice = GetVoice(voice);
+	float audibility = sdlVoice != nullptr ? sdlVoice->m_volume : 0.0f;
+	SDL_UnlockAudioDevice(m_device);
+	return audibility;
+}
+
+void SDLCALL CSdlAudioBackend::AudioCallback(void* userData, Uint8* stream, int length)
+{
+	CSdlAudioBackend* backend = static_cast<CSdlAudioBackend*>(userData);
+
+	Uint64 startCounter = SDL_GetPerformanceCounter();
+	backend->Mix(reinterpret_cast<float*>(stream), length / static_cast<int>(sizeof(float)));
+	backend->m_mixTimeUs += static_cast<Uint32>(Utils::GetElapsedMs(startCounter) * 1000.0);
+}
+
+// runs on the SDL audio thread with the device locked
+void CSdlAudioBackend::Mix(float* output, int numSamples)
+{
+	std::fill(output, output + numSamples, 0.0f);
+
+	for (SVoice& voice : m_voices)
+	{
+		if (!voice.m_isPlaying)
+		{
+			continue;
+		}
+
+		const std::vector<float>& samples = voice.m_sound->m_samples;
+		int outputPos = 0;
+		while (outputPos < numSamples)
+		{
+			size_t numToMix = std::min(samples.size() - voice.m_position, static_cast<size_t>(numSamples - outputPos));
+			for (size_t i = 0; i < numToMix; i++)
+			{
+				output[outputPos + i] += samples[voice.m_position + i] * voice.m_volume;
+			}
+			outputPos += static_cast<int>(numToMix);
+			voice.m_position += numToMix;
+
+			if (voice.m_position >= samples.size())
+			{
+				// sounds that failed to load have no samples, they end right away even when looping
+				if (!voice.m_isLooping || samples.empty())
+				{
+					voice.m_isPlaying = false;
+					break;
+				}
+				voice.m_position = 0;
+			}
+		}
+	}
+
+	for (int i = 0; i < numSamples; i++)
+	{
+		output[i] = std::min(std::max(output[i], -1.0f), 1.0f);
+	}
+}
+#endif
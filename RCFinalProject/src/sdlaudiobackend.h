@@ -0,0 +1,74 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+
+#include "audiobackend.h"
+#include <atomic>
+#include <vector>
+
+// small software mixer on top of SDL_audio, needs nothing but SDL itself. sounds are converted to the device's
+// sample rate as float stereo when loaded, so mixing is a multiply and add per sample. only WAV files are
+// supported, anything else (e.g. the music modules) plays silence
+class CSdlAudioBackend : public CAudioBackend
+{
+public:
+	bool Init(CAssetArchive* assetArchive) override;
+	void Destroy() override;
+	const char* GetName() override { return "sdl"; }
+
+	SoundHandle CreateSound(const std::string& path) override;
+	void ReleaseSound(SoundHandle sound) override;
+	size_t GetSoundSizeInBytes(SoundHandle sound) override;
+
+	void Update() override;
+	VoiceHandle PlaySound(SoundHandle sound, float volume, bool isLooping) override;
+	void StopVoice(VoiceHandle voice) override;
+	bool IsVoicePlaying(VoiceHandle voice) override;
+	float GetVoiceAudibility(VoiceHandle voice) override;
+
+	Uint32 TakeMixTimeUs() override { return m_mixTimeUs.exchange(0); }
+
+private:
+	static const int MAX_VOICES = SOUND_MAX_CHANNELS;
+	static const int NUM_CHANNELS = 2;
+	const int SAMPLE_RATE = 44100;
+	const Uint16 BUFFER_SAMPLES = 512; // about 12 ms of latency
+
+	struct SSound
+	{
+		std::vector<float> m_samples; // interleaved stereo
+	};
+
+	struct SVoice
+	{
+		const SSound* m_sound = nullptr;
+		size_t m_position = 0;
+		float m_volume = 0.0f;
+		Uint32 m_generation = 0;
+		bool m_isLooping = false;
+		bool m_isPlaying = false;
+	};
+
+	static void SDLCALL AudioCallback(void* userData, Uint8* stream, int length);
+	void Mix(float* output, int numSamples);
+
+	// the device must be locked while calling it
+	SVoice* GetVoice(VoiceHandle voice);
+
+	CAssetArchive* m_assetArchive = nullptr;
+	SDL_AudioDeviceID m_device = 0;
+	SDL_AudioSpec m_spec{};
+
+	// shared with the SDL audio thread, guarded by locking the device
+	SVoice m_voices[MAX_VOICES];
+
+	std::atomic<Uint32> m_mixTimeUs{ 0 };
+};
+
+#endif
@@ -0,0 +1,51 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+class CAssetArchive;
+class CAssetCache;
+class CAssetLoader;
+class CClock;
+class CGameManager;
+class CJobSystem;
+class CProfiler;
+class CRenderThread;
+#if SOUND_ENABLED
+class CAudioBackend;
+class CAudioThread;
+class CSoundEventQueue;
+#endif
+typedef struct _TTF_Font TTF_Font;
+
+// what the game objects use from the app. the app fills it in and hands it to the game manager, which hands it to
+// the states when it creates them, and they hand it to their entities, textures and sounds. nothing in the game
+// reaches for the app itself, so more than one game can run in the same process: a headless game (see CEnvRunner)
+// only gets the job system, everything else is nullptr
+struct SServices
+{
+	CRenderThread* m_renderThread = nullptr;
+	CAssetLoader* m_assetLoader = nullptr;
+	CAssetCache* m_assetCache = nullptr;
+	CAssetArchive* m_assetArchive = nullptr;
+	CJobSystem* m_jobSystem = nullptr;
+	CGameManager* m_gameManager = nullptr;
+	CProfiler* m_profiler = nullptr;
+#if SOUND_ENABLED
+	CAudioBackend* m_audioBackend = nullptr;
+	CAudioThread* m_audioThread = nullptr;
+	CSoundEventQueue* m_soundEventQueue = nullptr;
+#endif
+
+	// the app's clock, the ingame state replaces it with the game's own clock for everything it owns
+	CClock* m_clock = nullptr;
+
+	TTF_Font* m_regularFont = nullptr;
+	TTF_Font* m_bigFont = nullptr;
+
+	int m_screenWidth = GFX_SCREEN_WIDTH;
+	int m_screenHeight = GFX_SCREEN_HEIGHT;
+};
@@ -7,9 +7,10 @@
 #if SOUND_ENABLED
 #include "sound.h"
 
-#include "app.h"
+#include "assetloader.h"
 #include <assert.h>
 #include <stdio.h>
+#include "soundeventqueue.h"
 #include "utils.h"
 
 bool CSound::CreateFromFile(const std::string& filename)
@@ -23,56 +24,228 @@ bool CSound::CreateFromFile(const std::string& filename)
 		Destroy();
 	}
 
-	FMOD_RESULT result = CApp::GetInstance()->GetFmodSystem()->createSound(path.c_str(), FMOD_DEFAULT, nullptr, &m_sound);
-	if (m_sound == nullptr)
+	// no need to touch the disk if the sound is still resident
+	CAssetCache::AssetId assetId = m_services->m_assetCache->InternAssetId(path);
+	if (CreateFromCache(assetId))
 	{
-		LOG_SCR_F("Unable to load sound: %s (%s)\n", path.c_str(), FMOD_ErrorString(result));
+		return true;
+	}
+
+	CAudioBackend::SoundHandle sound = m_services->m_audioBackend->CreateSound(path);
+	if (sound == nullptr)
+	{
+		LOG_SCR_F("Unable to load sound: %s\n", path.c_str());
 		return false;
 	}
 
+	CreateFromHandle(sound, assetId);
+
 	LOG_SCR_F("Sound loaded successfully: %s\n", path.c_str());
 	
 	return true;
 
 }
 
+// takes ownership of a sound already created by the audio backend, e.g. by the asset loader. if an asset id is
+// given the sound is added to the asset cache under it
+void CSound::CreateFromHandle(CAudioBackend::SoundHandle sound, CAssetCache::AssetId assetId)
+{
+	if (m_sound != nullptr)
+	{
+		Destroy();
+	}
+
+	m_sound = sound;
+	if (assetId != CAssetCache::INVALID_ASSET_ID)
+	{
+		m_services->m_assetCache->AddSound(assetId, m_sound);
+		m_assetId = assetId;
+	}
+}
+
+// shares the sound with its other users if the asset cache still has it, returns false otherwise
+bool CSound::CreateFromCache(CAssetCache::AssetId assetId)
+{
+	if (m_sound != nullptr)
+	{
+		Destroy();
+	}
+
+	m_sound = m_services->m_assetCache->AcquireSound(assetId);
+	if (m_sound == nullptr)
+	{
+		return false;
+	}
+
+	m_assetId = assetId;
+	return true;
+}
+
+// applies to the voices started from now on
 void CSound::SetLoop(bool loop)
 {
-	assert(m_sound != nullptr);
+	m_isLooping = loop;
+}
 
-	m_sound->setMode(loop ? FMOD_LOOP_NORMAL : FMOD_DEFAULT);
+// caps how many instances of this sound play at once, playing it again past the cap replaces one of them
+void CSound::SetMaxVoices(int maxVoices)
+{
+	assert(maxVoices >= 1 && maxVoices <= MAX_VOICES);
+
+	CAudioThread::SCommand command;
+	command.m_type = CAudioThread::ECommandType::SET_MAX_VOICES;
+	command.m_maxVoices = maxVoices;
+	SubmitCommand(command);
 }
 
-// main play function
+// main play function, the sound starts at the end of the frame along with the rest played during it
 void CSound::Play(float volume)
 {
 	assert(m_sound != nullptr);
 
-	FMOD::Channel* channel = nullptr;
-	FMOD_RESULT result = CApp::GetInstance()->GetFmodSystem()->playSound(m_sound, nullptr, false, &channel);
-	if (result != FMOD_OK)
+	m_services->m_soundEventQueue->Queue(this, volume);
+}
+
+void CSound::Stop()
+{
+	m_services->m_soundEventQueue->Cancel(this);
+
+	CAudioThread::SCommand command;
+	command.m_type = CAudioThread::ECommandType::STOP;
+	SubmitCommand(command);
+}
+
+void CSound::SubmitPlay(float volume)
+{
+	CAudioThread::SCommand command;
+	command.m_type = CAudioThread::ECommandType::PLAY;
+	command.m_volume = volume;
+	command.m_isLooping = m_isLooping;
+	SubmitCommand(command);
+}
+
+void CSound::SubmitCommand(CAudioThread::SCommand& command)
+{
+	command.m_sound = this;
+	m_lastCommandNumber = m_services->m_audioThread->Submit(command);
+}
+
+void CSound::StartVoice(float volume, bool isLooping)
+{
+	assert(m_sound != nullptr);
+
+	CAudioBackend* audioBackend = m_services->m_audioBackend;
+	int voiceIndex = FindFreeVoice();
+	if (voiceIndex < 0)
 	{
-		LOG_SCR_F("Failed to play FMOD sound: %s\n", FMOD_ErrorString(result));
-		return;
+		voiceIndex = FindVoiceToSteal();
+		audioBackend->StopVoice(m_voices[voiceIndex].m_handle);
+		m_services->m_audioThread->OnVoiceStolen();
 	}
 
-	if (!CApp::GetInstance()->PrepareSoundChannel(channel))
+	m_voices[voiceIndex].m_handle = audioBackend->PlaySound(m_sound, volume, isLooping);
+	m_voices[voiceIndex].m_startTicks = Utils::GetTicks();
+}
+
+void CSound::StopVoices()
+{
+	CAudioBackend* audioBackend = m_services->m_audioBackend;
+	for (int i = 0; i < m_maxVoices; i++)
 	{
-		return;
+		if (m_voices[i].m_handle != CAudioBackend::INVALID_VOICE)
+		{
+			// does nothing if the voice already finished
+			audioBackend->StopVoice(m_voices[i].m_handle);
+			m_voices[i] = SVoice();
+		}
 	}
+}
 
-	CApp::GetInstance()->SetChannelVolume(channel, volume);
+void CSound::ApplyMaxVoices(int maxVoices)
+{
+	// voices past the new cap are not tracked anymore, let them finish on their own
+	for (int i = maxVoices; i < m_maxVoices; i++)
+	{
+		m_voices[i] = SVoice();
+	}
+	m_maxVoices = maxVoices;
+}
+
+// returns -1 if all the voices are still playing
+int CSound::FindFreeVoice()
+{
+	CAudioBackend* audioBackend = m_services->m_audioBackend;
+	for (int i = 0; i < m_maxVoices; i++)
+	{
+		if (m_voices[i].m_handle == CAudioBackend::INVALID_VOICE)
+		{
+			return i;
+		}
+
+		if (!audioBackend->IsVoicePlaying(m_voices[i].m_handle))
+		{
+			m_voices[i] = SVoice();
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+// the quietest voice is the least missed, among equally loud ones the oldest is
+int CSound::FindVoiceToSteal()
+{
+	CAudioBackend* audioBackend = m_services->m_audioBackend;
+	int stealIndex = 0;
+	float lowestAudibility = 0.0f;
+	for (int i = 0; i < m_maxVoices; i++)
+	{
+		float audibility = audioBackend->GetVoiceAudibility(m_voices[i].m_handle);
+
+		bool isQuieter = audibility < lowestAudibility;
+		bool isOlder = audibility == lowestAudibility && m_voices[i].m_startTicks < m_voices[stealIndex].m_startTicks;
+		if (i == 0 || isQuieter || isOlder)
+		{
+			stealIndex = i;
+			lowestAudibility = audibility;
+		}
+	}
+
+	return stealIndex;
 }
 
 void CSound::Destroy()
 {
+	// make sure a pending asynchronous load does not deliver into a destroyed sound
+	if (m_isLoading)
+	{
+		m_services->m_assetLoader->Cancel(this);
+	}
+
+	if (m_sound != nullptr)
+	{
+		Stop();
+	}
+
+	// the audio thread must be done with this object before it goes away or its sound is released
+	m_services->m_audioThread->Flush(m_lastCommandNumber);
+
 	if (m_sound != nullptr)
 	{
-		m_sound->release();
+		if (m_assetId != CAssetCache::INVALID_ASSET_ID)
+		{
+			// the cache keeps the sound alive, stopping the voices above is what ends e.g. the music
+			m_services->m_assetCache->Release(m_assetId);
+			m_assetId = CAssetCache::INVALID_ASSET_ID;
+		}
+		else
+		{
+			m_services->m_audioBackend->ReleaseSound(m_sound);
+		}
 		LOG_SCR_F("Sound destroyed successfully: %ld\n", (int)(size_t)m_sound);
 
-		m_channel = nullptr;
-		m_sound = nullptr;		
+		m_sound = nullptr;
+		m_isLooping = false;
 	}
 }
 #endif
\ No newline at end of file
@@ -8,27 +8,74 @@
 
 #if SOUND_ENABLED
 
-#include <fmod.hpp>
-#include <fmod_errors.h>
+#include "assetcache.h"
+#include "audiobackend.h"
+#include "audiothread.h"
+#include "services.h"
+#if __APPLE__
+#include <SDL2/SDL.h>
+#else
+#include <SDL.h>
+#endif
 #include <string>
 
-// wrapper class for an FMOD Sound object
+// wrapper class for a sound of the audio backend
 class CSound
 {
 public:
+	// the services are where the sound is played and cached, given by whoever owns it
+	explicit CSound(const SServices* services) : m_services(services) {}
+
 	bool CreateFromFile(const std::string& filename);
+	void CreateFromHandle(CAudioBackend::SoundHandle sound, CAssetCache::AssetId assetId = CAssetCache::INVALID_ASSET_ID);
+	bool CreateFromCache(CAssetCache::AssetId assetId);
 	
 	void SetLoop(bool loop);
+	void SetMaxVoices(int maxVoices);
 
 	void Play(float volume = SOUND_DEFAULT_VOLUME);
+	void Stop();
+
+	// called by the sound event queue once per frame, everything else goes through Play()
+	void SubmitPlay(float volume);
+
+	// audio thread only, the commands submitted by the functions above end up here
+	void StartVoice(float volume, bool isLooping);
+	void StopVoices();
+	void ApplyMaxVoices(int maxVoices);
 
 	void Destroy();
 
 	bool IsCreated() { return m_sound != nullptr; }
 
+	// set by the asset loader while the sound is queued for asynchronous loading
+	bool IsLoading() { return m_isLoading; }
+	void SetIsLoading(bool isLoading) { m_isLoading = isLoading; }
+
 private:
-	FMOD::Sound* m_sound = nullptr;
-	FMOD::Channel* m_channel = nullptr;
+	static const int MAX_VOICES = 8;
+
+	// one playing instance of the sound
+	struct SVoice
+	{
+		CAudioBackend::VoiceHandle m_handle = CAudioBackend::INVALID_VOICE;
+		Uint32 m_startTicks = 0;
+	};
+
+	void SubmitCommand(CAudioThread::SCommand& command);
+	int FindFreeVoice();
+	int FindVoiceToSteal();
+
+	const SServices* m_services = nullptr;
+	CAudioBackend::SoundHandle m_sound = nullptr;
+	// owned by the audio thread
+	SVoice m_voices[MAX_VOICES];
+	int m_maxVoices = SOUND_DEFAULT_MAX_VOICES;
+
+	bool m_isLooping = false; // sent along with every play, the sound itself may be shared through the asset cache
+	Uint64 m_lastCommandNumber = 0; // last command submitted to the audio thread for this sound
+	CAssetCache::AssetId m_assetId = CAssetCache::INVALID_ASSET_ID; // set if the sound is shared through the asset cache
+	bool m_isLoading = false;
 };
 
 #endif
\ No newline at end of file
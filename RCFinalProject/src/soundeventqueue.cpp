@@ -0,0 +1,64 @@
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+#include "soundeventqueue.h"
+
+#include <algorithm>
+#include <assert.h>
+#include "audiothread.h"
+#include "profiler.h"
+#include "sound.h"
+
+void CSoundEventQueue::Queue(CSound* sound, float volume)
+{
+	assert(sound != nullptr);
+
+	// only a handful of different sounds play in the same frame, a linear search is all it takes
+	for (SSoundEvent& event : m_events)
+	{
+		if (event.m_sound == sound)
+		{
+			event.m_volume = std::min(std::max(event.m_volume, volume) + SOUND_MERGED_EVENT_VOLUME_BOOST, SOUND_MAX_MERGED_EVENT_VOLUME);
+			m_services->m_profiler->IncrementCounter(CProfiler::ECounter::SOUND_EVENTS_MERGED);
+			return;
+		}
+	}
+
+	if (m_events.capacity() == 0)
+	{
+		m_events.reserve(INITIAL_CAPACITY);
+	}
+
+	SSoundEvent event;
+	event.m_sound = sound;
+	event.m_volume = volume;
+	m_events.push_back(event);
+}
+
+// drops the events of a sound that was stopped or destroyed before the end of the frame
+void CSoundEventQueue::Cancel(CSound* sound)
+{
+	m_events.erase(std::remove_if(m_events.begin(), m_events.end(), [sound](const SSoundEvent& event) { return event.m_sound == sound; }), m_events.end());
+}
+
+void CSoundEventQueue::Dispatch()
+{
+	if (m_events.empty())
+	{
+		return;
+	}
+
+	for (SSoundEvent& event : m_events)
+	{
+		event.m_sound->SubmitPlay(event.m_volume);
+	}
+
+	m_services->m_profiler->IncrementCounter(CProfiler::ECounter::SOUNDS_PLAYED, static_cast<Uint32>(m_events.size()));
+	m_services->m_audioThread->Wake();
+	m_events.clear();
+}
+#endif
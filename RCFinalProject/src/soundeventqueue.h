@@ -0,0 +1,41 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include "preproc.h"
+
+#if SOUND_ENABLED
+
+#include <cstddef>
+#include "services.h"
+#include <vector>
+
+class CSound;
+
+// collects the sounds played during a frame and starts them together once the frame is simulated. a sound played
+// several times in the same frame (e.g. half the formation exploding at once) is only started once, a bit louder
+class CSoundEventQueue
+{
+public:
+	void Init(const SServices* services) { m_services = services; }
+
+	void Queue(CSound* sound, float volume);
+	void Cancel(CSound* sound);
+	void Dispatch();
+
+private:
+	const size_t INITIAL_CAPACITY = 32;
+
+	struct SSoundEvent
+	{
+		CSound* m_sound = nullptr;
+		float m_volume = 0.0f;
+	};
+
+	const SServices* m_services = nullptr;
+	std::vector<SSoundEvent> m_events;
+};
+
+#endif
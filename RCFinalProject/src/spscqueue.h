@@ -0,0 +1,53 @@
+#pragma once
+
+/************************************************************************************
+ 2024 (C) Renzo Calderon
+*************************************************************************************/
+
+#include <atomic>
+#include <stddef.h>
+
+// class template for a fixed size lock-free queue between exactly one producer thread and one consumer thread.
+// the indices only ever grow, the capacity must be a power of two so they can be wrapped with a mask
+
+template <class T, size_t CAPACITY>
+class CSpscQueue
+{
+public:
+	static_assert(CAPACITY > 0 && (CAPACITY & (CAPACITY - 1)) == 0, "CSpscQueue capacity must be a power of two");
+
+	// producer thread only, returns false if the queue is full
+	bool Push(const T& item)
+	{
+		size_t tail = m_tail.load(std::memory_order_relaxed);
+		if (tail - m_head.load(std::memory_order_acquire) == CAPACITY)
+		{
+			return false;
+		}
+
+		m_items[tail & (CAPACITY - 1)] = item;
+		m_tail.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+
+	// consumer thread only, returns false if the queue is empty
+	bool Pop(T& item)
+	{
+		size_t head = m_head.load(std::memory_order_relaxed);
+		if (head == m_tail.load(std::memory_order_acquire))
+		{
+			return false;
+		}
+
+		item = m_items[head & (CAPACITY - 1)];
+		m_head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+private:
+	T m_items[CAPACITY];
+
+	// on separate cache lines, each one is written by a different thread
+	alignas(64) std::atomic<size_t> m_head{ 0 }; // next item to pop, written by the consumer
+	alignas(64) std::atomic<size_t> m_tail{ 0 }; // next item to push, written by the producer
+};
@@ -4,16 +4,27 @@
 
 #include "starfield.h"
 
-#include "app.h"
+#include <cmath>
+#include "renderthread.h"
 #include <stdio.h>
+#include <string.h>
 #include "utils.h"
 
+// lets the owning state load the spritesheet asynchronously, Init() must be called once it has been loaded
+void CStarfield::QueueTextures(CAssetLoader* assetLoader)
+{
+	assetLoader->QueueTexture(&m_spriteSheetTexture, TEXTURE_SPRITESHEET_FILENAME);
+}
+
 void CStarfield::Init()
 {
 	LOG_SCR_F("Creating Starfield\n");
 
-	// load starfield spritesheet
-	m_spriteSheetTexture.CreateFromFile(TEXTURE_SPRITESHEET_FILENAME);
+	// load starfield spritesheet, unless it was queued in the asset loader beforehand
+	if (!m_spriteSheetTexture.IsCreated())
+	{
+		m_spriteSheetTexture.CreateFromFile(TEXTURE_SPRITESHEET_FILENAME);
+	}
 
 	// set rects of each of the images contained in the spritesheet
 	m_nebulaRect = SDL_Rect{ 100, 0, 1920, 1080 };
@@ -24,89 +35,251 @@ void CStarfield::Init()
 	m_redStarRects[static_cast<int>(EStarDistance::DISTANCE_MEDIUM)] = SDL_Rect{ 0, 99, 25, 25 };
 	m_redStarRects[static_cast<int>(EStarDistance::DISTANCE_CLOSE)] = SDL_Rect{ 0, 124, 50, 50 };
 
-	// generate starfield	
-	for (int i = 0; i < NUM_STARFIELD_SECTIONS; i++)
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+	// render the stars once, from now on the starfield only costs a few copies per frame
+	CreateLayers();
+#else
+	// generate starfield, spread evenly over the sections
+	int screenHeight = m_services->m_screenHeight;
+	for (int i = 0; i < NUM_STAR_DISTANCES; i++)
+	{
+		for (int j = 0; j < NUM_STAR_PER_DISTANCE; j++)
+		{
+			int section = j % NUM_STARFIELD_SECTIONS;
+			GenerateStar(i, j, screenHeight * (section - 1), screenHeight * section);
+		}
+	}
+#endif
+}
+
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+void CStarfield::CreateLayers()
+{
+	int screenHeight = m_services->m_screenHeight;
+	for (int i = 0; i < NUM_STAR_DISTANCES; i++)
+	{
+		for (int j = 0; j < NUM_STARS_PER_LAYER; j++)
+		{
+			GenerateStar(i, j, 0, screenHeight);
+		}
+		m_layerPosY[i] = 0.0f;
+	}
+
+	RedrawLayers();
+}
+
+// rendered on the render thread, the stars are drawn right away instead of being recorded into the frame. the
+// stars and the scroll positions are kept, so the layers look the same after a render target reset
+void CStarfield::RedrawLayers()
+{
+	// new targets, after a device reset the old ones are gone. textures can only be destroyed from the game thread
+	for (int i = 0; i < NUM_STAR_DISTANCES; i++)
+	{
+		m_layerTextures[i].Destroy();
+	}
+
+	CRenderThread* renderThread = m_services->m_renderThread;
+	renderThread->Execute([this, renderThread](SDL_Renderer* renderer) { RenderLayers(renderer, renderThread->GetRenderStateCache()); });
+}
+
+void CStarfield::RenderLayers(SDL_Renderer* renderer, CRenderStateCache* renderStateCache)
+{
+	int screenWidth = m_services->m_screenWidth;
+	int screenHeight = m_services->m_screenHeight;
+	SDL_Texture* previousTarget = SDL_GetRenderTarget(renderer);
+
+	// the layers end up with premultiplied alpha since the stars are blended against a transparent target
+	SDL_BlendMode premultipliedBlendMode = SDL_ComposeCustomBlendMode(
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD,
+		SDL_BLENDFACTOR_ONE, SDL_BLENDFACTOR_ONE_MINUS_SRC_ALPHA, SDL_BLENDOPERATION_ADD);
+
+	for (int i = 0; i < NUM_STAR_DISTANCES; i++)
 	{
-		for (int j = 0; j < NUM_STARS; j++)
+		CTexture& layer = m_layerTextures[i];
+		if (!layer.CreateRenderTarget(screenWidth, screenHeight))
+		{
+			continue;
+		}
+
+		SDL_SetRenderTarget(renderer, layer.GetSDLTexture());
+		renderStateCache->SetDrawColor(SDL_Color{ 0, 0, 0, 0 });
+		SDL_RenderClear(renderer);
+
+		SStarLayer& starLayer = m_starLayers[i];
+		for (int j = 0; j < NUM_STARS_PER_LAYER; j++)
+		{
+			SDL_Rect* rect = starLayer.m_type[j] == EStarType::BLUE ? &m_blueStarRects[i] : &m_redStarRects[i];
+			int posX = static_cast<int>(starLayer.m_posX[j]);
+			int posY = static_cast<int>(starLayer.m_posY[j]);
+			m_spriteSheetTexture.Draw(posX, posY, rect);
+
+			// stars crossing the bottom edge are drawn again at the top so the layer wraps seamlessly
+			if (posY + rect->h > screenHeight)
+			{
+				m_spriteSheetTexture.Draw(posX, posY - screenHeight, rect);
+			}
+		}
+
+		// not every renderer supports custom blend modes, the stars only get slightly darker edges with the regular one
+		if (!layer.SetBlendMode(premultipliedBlendMode))
 		{
-			m_starsList.AddElement(GenerateStar(CApp::GetInstance()->GetScreenHeight() * (i - 1), CApp::GetInstance()->GetScreenHeight() * i));
+			layer.SetBlendMode(SDL_BLENDMODE_BLEND);
 		}
 	}
+
+	SDL_SetRenderTarget(renderer, previousTarget);
+}
+
+void CStarfield::DrawLayer(int layerIndex)
+{
+	CTexture& layer = m_layerTextures[layerIndex];
+	if (!layer.IsCreated())
+	{
+		return;
+	}
+
+	// the layer is scrolled down by m_layerPosY pixels, the part that went off the bottom edge is drawn at the top
+	int posY = static_cast<int>(m_layerPosY[layerIndex]);
+	int width = layer.GetWidth();
+	int height = layer.GetHeight();
+
+	SDL_Rect bottomRect{ 0, 0, width, height - posY };
+	layer.Draw(0, posY, &bottomRect);
+
+	if (posY > 0)
+	{
+		SDL_Rect topRect{ 0, height - posY, width, posY };
+		layer.Draw(0, 0, &topRect);
+	}
+}
+#endif
+
+void CStarfield::GenerateStar(int distanceIndex, int starIndex, int lowerboundY, int upperboundY)
+{
+	int starCenterX = m_random->GetUint32(0, m_services->m_screenWidth);
+	int starCenterY = static_cast<int>(m_random->GetUint32(0, upperboundY - lowerboundY)) + lowerboundY;
+	EStarType type = static_cast<EStarType>(m_random->GetUint32(0, static_cast<int>(EStarType::RED)));
+
+	SStarLayer& starLayer = m_starLayers[distanceIndex];
+	starLayer.m_posX[starIndex] = starCenterX - m_blueStarRects[0].w / 2.0f;
+	starLayer.m_posY[starIndex] = starCenterY - m_blueStarRects[0].h / 2.0f;
+	starLayer.m_speed[starIndex] = STAR_SPEED_PER_TYPE_AND_DISTANCE[static_cast<int>(type)][distanceIndex];
+	starLayer.m_type[starIndex] = type;
+}
+
+void CStarfield::SaveState(SState* state) const
+{
+	memcpy(state->m_starLayers, m_starLayers, sizeof(m_starLayers));
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+	memcpy(state->m_layerPosY, m_layerPosY, sizeof(m_layerPosY));
+#else
+	memset(state->m_layerPosY, 0, sizeof(state->m_layerPosY));
+#endif
+	state->m_speedMultiplier = m_speedMultiplier;
+	state->m_animationSpeedMultiplier = m_animationSpeedMultiplier;
+	state->m_animationTime = m_animationTime;
+	state->m_animationState = m_animationState;
 }
 
-CStarfield::SStar* CStarfield::GenerateStar(int lowerboundY, int upperboundY)
+void CStarfield::RestoreState(const SState& state)
 {
-	int starCenterX = Utils::GetRandomUint32(0, CApp::GetInstance()->GetScreenWidth());
-	int starCenterY = Utils::GetRandomUint32(lowerboundY, upperboundY);
-	int starPosX = starCenterX - static_cast<int>(m_blueStarRects[0].w / 2.0f);
-	int starPosY = starCenterY - static_cast<int>(m_blueStarRects[0].h / 2.0f);
-	EStarType type = static_cast<EStarType>(Utils::GetRandomUint32(0, static_cast<int>(EStarType::RED)));
-	EStarDistance distance = static_cast<EStarDistance>(Utils::GetRandomUint32(0, static_cast<int>(EStarDistance::DISTANCE_CLOSE)));
-	return new SStar(SDL_Point{ starPosX, starPosY }, type, distance);
+	memcpy(m_starLayers, state.m_starLayers, sizeof(m_starLayers));
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+	memcpy(m_layerPosY, state.m_layerPosY, sizeof(m_layerPosY));
+#endif
+	m_speedMultiplier = state.m_speedMultiplier;
+	m_animationSpeedMultiplier = state.m_animationSpeedMultiplier;
+	m_animationTime = state.m_animationTime;
+	m_animationState = state.m_animationState;
 }
 
 void CStarfield::StartAnimation()
 {
 	m_animationSpeedMultiplier = 1.0f;
-	m_animationTicks = Utils::GetTicks();
+	m_animationTime = 0;
 	m_animationState = EAnimationState::INCREASING_SPEED;
 }
 
-void CStarfield::Update(Uint32 elapsedTime)
+void CStarfield::StopAnimation()
+{
+	m_animationSpeedMultiplier = 0.0f;
+	m_animationState = EAnimationState::UNASSIGNED;
+}
+
+// determine the speed multiplier while handling the starfield animation
+float CStarfield::UpdateAnimation(Uint32 elapsedTime)
 {
-	if (CApp::GetInstance()->GetGameManager()->IsBackgroundScrollingEnabled())
+	if (m_animationState == EAnimationState::UNASSIGNED)
 	{
-		SStar* starPtr = m_starsList.GetHeadElement();
-		while (starPtr != nullptr)
+		return m_speedMultiplier;
+	}
+
+	m_animationTime += elapsedTime;
+	if (m_animationTime > ANIMATION_SPEED_INCREASE_COOLDOWN_MS / m_animationSpeedMultiplier)
+	{
+		if (m_animationState == EAnimationState::INCREASING_SPEED)
 		{
-			// determine the speed multiplier while handling the starfield animation
-			float speedMultiplier = m_speedMultiplier;
-			if (m_animationState != EAnimationState::UNASSIGNED)
+			m_animationSpeedMultiplier += ANIMATION_SPEED_INCREASE;
+			if (m_animationSpeedMultiplier > ANIMATION_MAX_SPEED_MULTIPLIER)
 			{
-				if (Utils::GetTicks() - m_animationTicks > ANIMATION_SPEED_INCREASE_COOLDOWN_MS / m_animationSpeedMultiplier)
-				{
-					if (m_animationState == EAnimationState::INCREASING_SPEED)
-					{
-						m_animationSpeedMultiplier += ANIMATION_SPEED_INCREASE;
-						if (m_animationSpeedMultiplier > ANIMATION_MAX_SPEED_MULTIPLIER)
-						{
-							m_animationSpeedMultiplier = ANIMATION_MAX_SPEED_MULTIPLIER;
-							m_animationState = EAnimationState::DECREASING_SPEED;
-						}
-					}
-					else // DECREASING_SPEED
-					{
-						m_animationSpeedMultiplier += ANIMATION_SPEED_DECREASE;
-						if (m_animationSpeedMultiplier < ANIMATION_MIN_SPEED_MULTIPLIER)
-						{
-							m_animationSpeedMultiplier = ANIMATION_MIN_SPEED_MULTIPLIER;
-							m_animationState = EAnimationState::UNASSIGNED;
-						}
-					}					
-					m_animationTicks = Utils::GetTicks();
-				}
-				speedMultiplier = m_animationSpeedMultiplier;
+				m_animationSpeedMultiplier = ANIMATION_MAX_SPEED_MULTIPLIER;
+				m_animationState = EAnimationState::DECREASING_SPEED;
+			}
+		}
+		else // DECREASING_SPEED
+		{
+			m_animationSpeedMultiplier += ANIMATION_SPEED_DECREASE;
+			if (m_animationSpeedMultiplier < ANIMATION_MIN_SPEED_MULTIPLIER)
+			{
+				m_animationSpeedMultiplier = ANIMATION_MIN_SPEED_MULTIPLIER;
+				m_animationState = EAnimationState::UNASSIGNED;
 			}
+		}					
+		m_animationTime = 0;
+	}
+
+	return m_animationSpeedMultiplier;
+}
 
-			// update star position
-			starPtr->m_position.y += static_cast<int>(Utils::ScaleSpeed(elapsedTime, STAR_SPEED_PER_TYPE_AND_DISTANCE[static_cast<int>(starPtr->m_type)][static_cast<int>(starPtr->m_distance)]) * speedMultiplier);
+void CStarfield::Update(Uint32 elapsedTime)
+{
+	if (m_isScrollingEnabled)
+	{
+		float speedMultiplier = UpdateAnimation(elapsedTime);
+
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+		// scroll the layers
+		float layerHeight = static_cast<float>(m_services->m_screenHeight);
+		for (int i = 0; i < NUM_STAR_DISTANCES; i++)
+		{
+			m_layerPosY[i] += Utils::ScaleSpeed(elapsedTime, LAYER_SPEED_PER_DISTANCE[i]) * speedMultiplier;
+			m_layerPosY[i] = fmodf(m_layerPosY[i], layerHeight);
+		}
+#else
+		int screenHeight = m_services->m_screenHeight;
+		float scale = Utils::ScaleSpeed(elapsedTime, speedMultiplier);
+		float recycleLimitY = screenHeight + m_blueStarRects[0].h / 2.0f;
 
-			// destroy any stars that are off screen
-			SDL_Rect* rect = starPtr->m_type == EStarType::BLUE ? m_blueStarRects : m_redStarRects;
-			if (starPtr->m_position.y > CApp::GetInstance()->GetScreenHeight() + rect->h / 2.0)
+		for (int i = 0; i < NUM_STAR_DISTANCES; i++)
+		{
+			SStarLayer& starLayer = m_starLayers[i];
+
+			// update star positions
+			for (int j = 0; j < NUM_STAR_PER_DISTANCE; j++)
 			{
-				SStar* nextElement = m_starsList.RemoveElement(starPtr);
-				LOG_SCR_F("Deleting star %d\n", (int)(size_t)starPtr);
-				delete starPtr;
-				starPtr = nextElement;
+				starLayer.m_posY[j] += starLayer.m_speed[j] * scale;
+			}
 
-				m_starsList.AddElement(GenerateStar(CApp::GetInstance()->GetScreenHeight() * -1, 0));
+			// recycle any stars that are off screen, they start again above the screen
+			for (int j = 0; j < NUM_STAR_PER_DISTANCE; j++)
+			{
+				if (starLayer.m_posY[j] > recycleLimitY)
+				{
+					GenerateStar(i, j, screenHeight * -1, 0);
+				}
 			}
-			else
-			{				
-				starPtr = m_starsList.GetNextElement(starPtr);
-			}			
 		}
+#endif
 	}
 
 }
@@ -116,26 +289,53 @@ void CStarfield::Draw()
 	// draw the nebula
 	m_spriteSheetTexture.Draw(0, 0, &m_nebulaRect);
 
-	if (CApp::GetInstance()->GetGameManager()->IsBackgroundScrollingEnabled())
+	if (m_isScrollingEnabled)
 	{
-		// draw the stars
-		SStar* starPtr = m_starsList.GetHeadElement();
-		while (starPtr != nullptr)
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+		// draw the layers from the farthest to the closest
+		for (int i = 0; i < NUM_STAR_DISTANCES; i++)
 		{
-			// do not try drawing any stars outside the screen
-			if (starPtr->m_position.y < CApp::GetInstance()->GetScreenHeight())
+			DrawLayer(i);
+		}
+#else
+		// draw the stars from the farthest to the closest
+		int screenHeight = m_services->m_screenHeight;
+		for (int i = 0; i < NUM_STAR_DISTANCES; i++)
+		{
+			SStarLayer& starLayer = m_starLayers[i];
+			for (int j = 0; j < NUM_STAR_PER_DISTANCE; j++)
 			{
-				SDL_Rect* rect = starPtr->m_type == EStarType::BLUE ? m_blueStarRects : m_redStarRects;
-				m_spriteSheetTexture.Draw(starPtr->m_position.x, starPtr->m_position.y, &rect[static_cast<int>(starPtr->m_distance)]);
+				// do not try drawing any stars outside the screen
+				SDL_Rect* rect = starLayer.m_type[j] == EStarType::BLUE ? &m_blueStarRects[i] : &m_redStarRects[i];
+				int posY = static_cast<int>(starLayer.m_posY[j]);
+				if (posY < screenHeight && posY + rect->h > 0)
+				{
+					m_spriteSheetTexture.Draw(static_cast<int>(starLayer.m_posX[j]), posY, rect);
+				}
 			}
-
-			starPtr = m_starsList.GetNextElement(starPtr);
 		}
+#endif
 	}	
 }
 
+void CStarfield::OnRenderTargetsReset()
+{
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+	if (m_layerTextures[0].IsCreated())
+	{
+		RedrawLayers();
+	}
+#endif
+}
+
 void CStarfield::Destroy()
 {
 	LOG_SCR_F("Destroying Starfield\n");
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+	for (int i = 0; i < NUM_STAR_DISTANCES; i++)
+	{
+		m_layerTextures[i].Destroy();
+	}
+#endif
 	m_spriteSheetTexture.Destroy();
 }
\ No newline at end of file
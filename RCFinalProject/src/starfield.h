@@ -4,20 +4,41 @@
  2024 (C) Renzo Calderon
 *************************************************************************************/
 
-#include "doublelinkedlist.h"
+#include "assetloader.h"
+#include "preproc.h"
+#include "random.h"
+#include "services.h"
 #include "texture.h"
 
+class CRenderStateCache;
+
 class CStarfield
 {
 public:
+	// the stars are placed with the random numbers of the owning game, so they are part of its snapshots
+	CStarfield(const SServices* services, CRandom* random) : m_services(services), m_random(random) {}
+
+	void QueueTextures(CAssetLoader* assetLoader);
 	void Init();
 	void Update(Uint32 elapsedTime);
 	void Draw();
 	void Destroy();
 
+	// the pre-rendered layers are render targets, they are drawn again with the same stars
+	void OnRenderTargetsReset();
+
 	void SetSpeedMultiplier(float multiplier) { m_speedMultiplier = multiplier; }
 
+	// the player can turn the scrolling off, the owning state passes it on
+	void SetIsScrollingEnabled(bool isScrollingEnabled) { m_isScrollingEnabled = isScrollingEnabled; }
+
+	// everything Update() changes, defined below
+	struct SState;
+	void SaveState(SState* state) const;
+	void RestoreState(const SState& state);
+
 	void StartAnimation();
+	void StopAnimation();
 	bool IsPlayingAnimation() { return m_animationState != EAnimationState::UNASSIGNED; }
 
 private:
@@ -37,34 +58,13 @@ private:
 		RED
 	};
 
-	struct SStarInfo
-	{
-		SDL_Point	m_position;
-		int			m_screenYPos;
-		EStarType	m_starType;
-	};
-
-	struct SStar
-	{
-		SDL_Point		m_position;
-		EStarType		m_type;
-		EStarDistance	m_distance;
-
-		SStar(SDL_Point position, EStarType type, EStarDistance distance)
-		{
-			m_position = position;
-			m_type = type;
-			m_distance = distance;
-		}
-	};
-
 	// per section - starfield is composed of two section, each the same size as the screen to
 	// create the illusion of scrolling
-	const int NUM_STARS = 50;
+	static const int NUM_STARS = 50;
 	
-	const int NUM_STARFIELD_SECTIONS = 2;
-	static const int NUM_STAR_PER_DISTANCE = 20;
+	static const int NUM_STARFIELD_SECTIONS = 2;
 	static const int NUM_STAR_DISTANCES = 3;
+	static const int NUM_STAR_PER_DISTANCE = (NUM_STARS * NUM_STARFIELD_SECTIONS + NUM_STAR_DISTANCES - 1) / NUM_STAR_DISTANCES;
 	static const int NUM_STAR_TYPES = 2;
 	const float STAR_SPEED_PER_TYPE_AND_DISTANCE[NUM_STAR_TYPES][NUM_STAR_DISTANCES] = {
 		{
@@ -94,19 +94,68 @@ private:
 	const float ANIMATION_SPEED_INCREASE_COOLDOWN_MS = 20;
 	const float ANIMATION_MIN_SPEED_MULTIPLIER = 1.0f;
 	const float ANIMATION_MAX_SPEED_MULTIPLIER = 12.0f;
+
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+	// each star distance is pre-rendered into a screen sized layer that wraps around vertically, both star
+	// types of a distance share the layer so they scroll at the same speed
+	static const int NUM_STARS_PER_LAYER = NUM_STARS / NUM_STAR_DISTANCES;
+	const float LAYER_SPEED_PER_DISTANCE[NUM_STAR_DISTANCES] = {
+		16.0f, // FAR
+		31.0f, // MEDIUM
+		46.0f  // CLOSE
+	};
+#endif
 	
-	CStarfield::SStar* GenerateStar(int lowerboundY, int upperboundY);
+	// stars of one distance stored as separate arrays so the position update is a straight loop the compiler
+	// can vectorize, stars that leave the screen are recycled in place
+	struct SStarLayer
+	{
+		float		m_posX[NUM_STAR_PER_DISTANCE];
+		float		m_posY[NUM_STAR_PER_DISTANCE];
+		float		m_speed[NUM_STAR_PER_DISTANCE];
+		EStarType	m_type[NUM_STAR_PER_DISTANCE];
+	};
+
+	void GenerateStar(int distanceIndex, int starIndex, int lowerboundY, int upperboundY);
+	float UpdateAnimation(Uint32 elapsedTime);
+
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+	void CreateLayers();
+	void RedrawLayers();
+	void RenderLayers(SDL_Renderer* renderer, CRenderStateCache* renderStateCache);
+	void DrawLayer(int layerIndex);
+#endif
 	
-	CDoubleLinkedList<SStar*> m_starsList;
-	CTexture m_spriteSheetTexture;
+	const SServices* m_services = nullptr;
+	CRandom* m_random = nullptr;
+
+	CTexture m_spriteSheetTexture{ m_services };
 	SDL_Rect m_nebulaRect;
 	SDL_Rect m_blueStarRects[NUM_STAR_DISTANCES] = {};
 	SDL_Rect m_redStarRects[NUM_STAR_DISTANCES] = {};
-	SStarInfo m_stars[NUM_STAR_DISTANCES][NUM_STAR_PER_DISTANCE];
+	SStarLayer m_starLayers[NUM_STAR_DISTANCES] = {};
 	float m_speedMultiplier = 1.0f;
+	bool m_isScrollingEnabled = true;
 
 	float m_animationSpeedMultiplier = 0.0f;
-	Uint32 m_animationTicks = 0;
+	Uint32 m_animationTime = 0; // since the last change of speed
 	EAnimationState m_animationState = EAnimationState::UNASSIGNED;
 
+#if GFX_STARFIELD_PRERENDERED_LAYERS
+	static_assert(NUM_STAR_DISTANCES == 3, "one layer texture per star distance");
+	CTexture m_layerTextures[NUM_STAR_DISTANCES] = { CTexture(m_services), CTexture(m_services), CTexture(m_services) };
+	float m_layerPosY[NUM_STAR_DISTANCES] = {};
+#endif
+
+};
+
+// the stars are part of it even if they were pre-rendered, they are only a few
+struct CStarfield::SState
+{
+	SStarLayer m_starLayers[NUM_STAR_DISTANCES];
+	float m_layerPosY[NUM_STAR_DISTANCES];
+	float m_speedMultiplier;
+	float m_animationSpeedMultiplier;
+	Uint32 m_animationTime;
+	EAnimationState m_animationState;
 };
\ No newline at end of file
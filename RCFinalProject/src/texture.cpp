@@ -4,7 +4,8 @@
 
 #include "texture.h"
 
-#include "app.h"
+#include "assetarchive.h"
+#include "assetloader.h"
 #include <assert.h>
 #if __APPLE__
 #include <SDL2_image/SDL_image.h>
@@ -13,7 +14,12 @@
 #include <SDL_Image.h>
 #include <SDL_ttf.h>
 #endif
+#include "lz4block.h"
+#include "profiler.h"
+#include "rawtextureformat.h"
+#include "renderthread.h"
 #include <stdio.h>
+#include <string.h>
 #include "utils.h"
 
 bool CTexture::CreateFromFile(const std::string& filename)
@@ -27,26 +33,183 @@ bool CTexture::CreateFromFile(const std::string& filename)
 	std::string path = GFX_DIRECTORY;
 	path.append(filename);
 
+	// no need to touch the disk if the texture is still resident
+	CAssetCache::AssetId assetId = m_services->m_assetCache->InternAssetId(path);
+	if (CreateFromCache(assetId))
+	{
+		return true;
+	}
+
 	SDL_LogMessage(SDL_LOG_CATEGORY_VIDEO, SDL_LOG_PRIORITY_INFO, "Loading texture: %s", path.c_str());
-	m_texture = IMG_LoadTexture(CApp::GetInstance()->GetRenderer(), path.c_str());
-	if (m_texture == nullptr)
+	SDL_Surface* surface = LoadSurface(m_services, path);
+	if (surface == nullptr)
+	{
+		return false;
+	}
+
+	bool result = CreateFromSurface(surface, assetId);
+	SDL_FreeSurface(surface);
+	if (!result)
+	{
+		LOG_SCR_F("Unable to load texture: %s\n", path.c_str());
+		return false;
+	}
+
+	LOG_SCR_F("Texture loaded successfully: %s (%d)\n", path.c_str(), (int)(size_t)m_texture);
+	return true;
+}
+
+// decodes an image into an ARGB8888 surface, using its pre-decoded version if there is one (those are always
+// ARGB8888 too). it is the format the Direct3D, Metal and OpenGL renderers prefer, so the upload usually needs no
+// conversion. the renderer can not be asked here: it does not touch the renderer, the asset loader calls it from
+// its worker threads
+SDL_Surface* CTexture::LoadSurface(const SServices* services, const std::string& path)
+{
+	Uint64 startCounter = SDL_GetPerformanceCounter();
+
+	SDL_Surface* surface = LoadRawSurface(services, path);
+	if (surface == nullptr)
+	{
+		surface = IMG_Load_RW(services->m_assetArchive->OpenAsset(path), 1);
+		if (surface == nullptr)
+		{
+			LOG_SCR_F("Unable to load image: %s (%s)\n", path.c_str(), IMG_GetError());
+			return nullptr;
+		}
+
+		if (surface->format->format != SDL_PIXELFORMAT_ARGB8888)
+		{
+			SDL_Surface* convertedSurface = SDL_ConvertSurfaceFormat(surface, SDL_PIXELFORMAT_ARGB8888, 0);
+			SDL_FreeSurface(surface);
+			surface = convertedSurface;
+			if (surface == nullptr)
+			{
+				LOG_SCR_F("Unable to convert image: %s (%s)\n", path.c_str(), SDL_GetError());
+				return nullptr;
+			}
+		}
+	}
+
+	services->m_profiler->RecordAssetDecode(path, startCounter);
+	return surface;
+}
+
+// looks for the pre-decoded version of an image next to it, e.g. "assets/gfx/ship.rtex" for "assets/gfx/ship.png"
+SDL_Surface* CTexture::LoadRawSurface(const SServices* services, const std::string& path)
+{
+	std::string rawPath = path.substr(0, path.find_last_of('.'));
+	rawPath.append(RAW_TEXTURE_EXTENSION);
+
+	// the archive stays mapped while the game runs, so its data can be referenced instead of copied
+	const void* data = nullptr;
+	size_t size = 0;
+	if (services->m_assetArchive->FindAsset(rawPath, &data, &size))
+	{
+		return DecodeRawSurface(static_cast<const Uint8*>(data), size, true, rawPath);
+	}
+
+	void* fileData = SDL_LoadFile(rawPath.c_str(), &size);
+	if (fileData == nullptr)
+	{
+		return nullptr;
+	}
+
+	SDL_Surface* surface = DecodeRawSurface(static_cast<const Uint8*>(fileData), size, false, rawPath);
+	SDL_free(fileData);
+	return surface;
+}
+
+SDL_Surface* CTexture::DecodeRawSurface(const Uint8* data, size_t size, bool canReferenceData, const std::string& path)
+{
+	const SRawTextureHeader* header = reinterpret_cast<const SRawTextureHeader*>(data);
+	if (size < sizeof(SRawTextureHeader) || header->m_magic != RAW_TEXTURE_MAGIC || header->m_version != RAW_TEXTURE_VERSION
+		|| header->m_pixelFormat != SDL_PIXELFORMAT_ARGB8888 || header->m_dataSize > size - sizeof(SRawTextureHeader)
+		|| header->m_width == 0 || header->m_width > MAX_RAW_TEXTURE_SIZE || header->m_height == 0 || header->m_height > MAX_RAW_TEXTURE_SIZE)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Invalid raw texture: %s", path.c_str());
+		return nullptr;
+	}
+
+	const Uint8* pixels = data + sizeof(SRawTextureHeader);
+	int width = static_cast<int>(header->m_width);
+	int height = static_cast<int>(header->m_height);
+	int pitch = width * SDL_BYTESPERPIXEL(header->m_pixelFormat);
+	size_t pixelsSize = static_cast<size_t>(pitch) * height;
+
+	// SDL only reads the pixels of a surface when creating a texture from it, so they can stay where they are
+	if (canReferenceData && header->m_compression == ERawTextureCompression::NONE && header->m_dataSize == pixelsSize)
+	{
+		return SDL_CreateRGBSurfaceWithFormatFrom(const_cast<Uint8*>(pixels), width, height, 32, pitch, header->m_pixelFormat);
+	}
+
+	SDL_Surface* surface = SDL_CreateRGBSurfaceWithFormat(0, width, height, 32, header->m_pixelFormat);
+	if (surface == nullptr)
+	{
+		SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Unable to create surface for raw texture: %s (%s)", path.c_str(), SDL_GetError());
+		return nullptr;
+	}
+
+	// 32 bit surfaces have no row padding, the pixels are written in one go
+	assert(surface->pitch == pitch);
+
+	bool isValid = false;
+	if (header->m_compression == ERawTextureCompression::NONE)
+	{
+		isValid = header->m_dataSize == pixelsSize;
+		if (isValid)
+		{
+			memcpy(surface->pixels, pixels, pixelsSize);
+		}
+	}
+	else if (header->m_compression == ERawTextureCompression::LZ4)
+	{
+		isValid = LZ4Block::Decompress(pixels, header->m_dataSize, static_cast<Uint8*>(surface->pixels), pixelsSize);
+	}
+
+	if (!isValid)
+	{
+		LOG_SCR_F("Corrupted raw texture: %s\n", path.c_str());
+		SDL_FreeSurface(surface);
+		return nullptr;
+	}
+
+	return surface;
+}
+
+// shares the texture with its other users if the asset cache still has it, returns false otherwise
+bool CTexture::CreateFromCache(CAssetCache::AssetId assetId)
+{
+	if (m_texture != nullptr)
+	{
+		Destroy();
+	}
+
+	SDL_Texture* texture = m_services->m_assetCache->AcquireTexture(assetId);
+	if (texture == nullptr)
 	{
-		LOG_SCR_F("Unable to load texture: %s (%s)\n", path.c_str(), SDL_GetError());
 		return false;
 	}
-	
+
+	return SetCachedTexture(assetId, texture);
+}
+
+// the caller must already hold a reference to the texture in the asset cache
+bool CTexture::SetCachedTexture(CAssetCache::AssetId assetId, SDL_Texture* texture)
+{
+	m_texture = texture;
+	m_assetId = assetId;
+
 	if (SDL_QueryTexture(m_texture, nullptr, nullptr, &m_width, &m_height) < 0)
 	{
+		LOG_SCR_F("Unable to query texture: %s (%s)\n", m_services->m_assetCache->GetAssetKey(assetId).c_str(), SDL_GetError());
 		Destroy();
-		LOG_SCR_F("Texture loaded successfully: %s (%d)\n", path.c_str(), (int)(size_t)m_texture);
 		return false;
 	}
 
-	LOG_SCR_F("Texture loaded successfully: %s (%d)\n", path.c_str(), (int)(size_t)m_texture);
 	return true;
 }
 
-bool CTexture::CreateFromText(const std::string& text, SDL_Color color, EFont font)
+bool CTexture::CreateFromText(const std::string& text, SDL_Color color, EFont font, bool useCache)
 {
 	// if the texture is already initialized, destroy it first, mostly used when updating text in a text texture
 	if (m_texture != nullptr)
@@ -54,7 +217,24 @@ bool CTexture::CreateFromText(const std::string& text, SDL_Color color, EFont fo
 		Destroy();
 	}
 
-	TTF_Font* fontPtr = font == EFont::REGULAR ? CApp::GetInstance()->GetRegularFont() : CApp::GetInstance()->GetBigFont();
+	// static labels are cached, text that changes all the time (e.g. the score) should not be
+	CAssetCache::AssetId assetId = CAssetCache::INVALID_ASSET_ID;
+	if (useCache)
+	{
+		const size_t MAX_BUFFER_SIZE = 64;
+		char buffer[MAX_BUFFER_SIZE];
+		sprintf_s(buffer, "text:%d:%02x%02x%02x%02x:", static_cast<int>(font), color.r, color.g, color.b, color.a);
+
+		std::string key = buffer;
+		key.append(text);
+		assetId = m_services->m_assetCache->InternAssetId(key);
+		if (CreateFromCache(assetId))
+		{
+			return true;
+		}
+	}
+
+	TTF_Font* fontPtr = font == EFont::REGULAR ? m_services->m_regularFont : m_services->m_bigFont;
 
 	SDL_Surface* surf = TTF_RenderText_Solid(fontPtr, text.c_str(), color);
 	if (surf == nullptr)
@@ -64,46 +244,116 @@ bool CTexture::CreateFromText(const std::string& text, SDL_Color color, EFont fo
 	}
 
 	// create the texture from the SDL surface
-	m_texture = SDL_CreateTextureFromSurface(CApp::GetInstance()->GetRenderer(), surf);
+	bool result = CreateFromSurface(surf, assetId);
+	if (!result)
+	{
+		LOG_SCR_F("Unable to create texture from text: %s\n", text.c_str());
+	}
+
+	// free the surface
+	SDL_FreeSurface(surf); 
+
+	return result;
+}
+
+// uploads an already decoded surface, the caller keeps ownership of the surface. if an asset id is given the
+// texture is added to the asset cache under it
+bool CTexture::CreateFromSurface(SDL_Surface* surface, CAssetCache::AssetId assetId)
+{
+	if (m_texture != nullptr)
+	{
+		Destroy();
+	}
+
+	// SDL keeps the error per thread, it has to be logged where it happened
+	m_services->m_renderThread->Execute([this, surface](SDL_Renderer* renderer)
+	{
+		m_texture = SDL_CreateTextureFromSurface(renderer, surface);
+		if (m_texture == nullptr)
+		{
+			LOG_SCR_F("Unable to create texture from surface (%s)\n", SDL_GetError());
+		}
+	});
 	if (m_texture == nullptr)
 	{
-		SDL_FreeSurface(surf); // free the surface
-		LOG_SCR_F("Unable to create texture from surface: %s (%s)\n", text.c_str(), SDL_GetError());
 		return false;
 	}
 
 	// store the dimensions
-	m_width = surf->w;
-	m_height = surf->h;
+	m_width = surface->w;
+	m_height = surface->h;
 
-	// free the surface
-	SDL_FreeSurface(surf); 
+	if (assetId != CAssetCache::INVALID_ASSET_ID)
+	{
+		m_services->m_assetCache->AddTexture(assetId, m_texture);
+		m_assetId = assetId;
+	}
+
+	return true;
+}
+
+// creates an empty texture that can be rendered into, e.g. to pre-render sprites once at load time
+bool CTexture::CreateRenderTarget(int width, int height)
+{
+	if (m_texture != nullptr)
+	{
+		Destroy();
+	}
+
+	m_services->m_renderThread->Execute([this, width, height](SDL_Renderer* renderer)
+	{
+		m_texture = SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_TARGET, width, height);
+		if (m_texture == nullptr)
+		{
+			LOG_SCR_F("Unable to create render target texture: %dx%d (%s)\n", width, height, SDL_GetError());
+		}
+	});
+	if (m_texture == nullptr)
+	{
+		return false;
+	}
+
+	m_width = width;
+	m_height = height;
+
+	SetBlendMode(SDL_BLENDMODE_BLEND);
 
 	return true;
 }
 
 // useful for transparency effects
-void CTexture::SetBlendMode(SDL_BlendMode mode)
+bool CTexture::SetBlendMode(SDL_BlendMode mode)
 {
-	SDL_SetTextureBlendMode(m_texture, mode);
+	bool result = false;
+	CRenderThread* renderThread = m_services->m_renderThread;
+	renderThread->Execute([this, mode, renderThread, &result](SDL_Renderer* /*renderer*/)
+	{
+		result = renderThread->GetRenderStateCache()->SetTextureBlendMode(m_texture, mode);
+	});
+	return result;
 }
 
 // fetch current tint of the texture
 void CTexture::GetTint(Uint8* r, Uint8* g, Uint8* b)
 {
-	SDL_GetTextureColorMod(m_texture, r, g, b);
+	*r = m_color.r;
+	*g = m_color.g;
+	*b = m_color.b;
 }
 
-// to tint images for color blind/accessibility options
+// to tint images for color blind/accessibility options. recorded along with every draw of this texture, so it
+// does not affect the other users of a shared texture or the frame the render thread is drawing
 void CTexture::SetTint(Uint8 r, Uint8 g, Uint8 b)
 {
-	SDL_SetTextureColorMod(m_texture, r, g, b);
+	m_color.r = r;
+	m_color.g = g;
+	m_color.b = b;
 }
 
 // texture transparency
 void CTexture::SetAlpha(Uint8 a)
 {
-	SDL_SetTextureAlphaMod(m_texture, a);
+	m_color.a = a;
 }
 
 // main drawing function
@@ -120,21 +370,58 @@ void CTexture::Draw(int x, int y, SDL_Rect* sourceRect, double angleInDegrees, S
 		w = sourceRect->w;
 		h = sourceRect->h;
 	}
-	SDL_Rect dstRect{ x, y, w, h };
-	
-	// call the main SDL render function that permits rotation and flipping as well if needed
-	SDL_RenderCopyEx(CApp::GetInstance()->GetRenderer(), m_texture, sourceRect, &dstRect, angleInDegrees, rotationCenterPoint, textureFlipping);
+
+	CDrawList::SCommand command;
+	command.m_type = CDrawList::ECommandType::SPRITE;
+	command.m_texture = m_texture;
+	command.m_rect = SDL_Rect{ x, y, w, h };
+	command.m_angleInDegrees = angleInDegrees;
+	command.m_textureFlipping = textureFlipping;
+	command.m_color = m_color;
+	if (sourceRect != nullptr)
+	{
+		command.m_sourceRect = *sourceRect;
+		command.m_hasSourceRect = true;
+	}
+	if (rotationCenterPoint != nullptr)
+	{
+		command.m_rotationCenterPoint = *rotationCenterPoint;
+		command.m_hasRotationCenterPoint = true;
+	}
+
+	// drawn by the render thread later on, unless this is running on it
+	m_services->m_renderThread->Draw(command);
+
+	bool isTransformed = angleInDegrees != 0.0 || textureFlipping != SDL_FLIP_NONE;
+	m_services->m_profiler->IncrementCounter(isTransformed ? CProfiler::ECounter::SPRITE_DRAWS_TRANSFORMED : CProfiler::ECounter::SPRITE_DRAWS);
 }
 
 void CTexture::Destroy()
 {
+	// make sure a pending asynchronous load does not deliver into a destroyed texture
+	if (m_isLoading)
+	{
+		m_services->m_assetLoader->Cancel(this);
+	}
+
 	if (m_texture != nullptr)
 	{
-		SDL_DestroyTexture(m_texture);
+		// shared textures are only destroyed by the asset cache
+		if (m_assetId != CAssetCache::INVALID_ASSET_ID)
+		{
+			m_services->m_assetCache->Release(m_assetId);
+		}
+		else
+		{
+			// the frames still being drawn may use it
+			m_services->m_renderThread->DestroyTexture(m_texture);
+		}
 
 		// resetting all values to their initial state
 		m_texture = nullptr;
+		m_assetId = CAssetCache::INVALID_ASSET_ID;
 		m_width = 0;
 		m_height = 0;
+		m_color = SDL_Color{ 255, 255, 255, 255 };
 	}
 }
\ No newline at end of file
@@ -9,6 +9,8 @@
 #else
 #include <SDL.h>
 #endif
+#include "assetcache.h"
+#include "services.h"
 #include <string>
 
 // wrapper class for an SDL Texture object
@@ -21,10 +23,16 @@ public:
 		BIG
 	};
 
+	// the services are where the texture is uploaded, drawn and cached, given by whoever owns it
+	explicit CTexture(const SServices* services) : m_services(services) {}
+
 	bool CreateFromFile(const std::string& filename);
-	bool CreateFromText(const std::string& text, SDL_Color color, EFont font = EFont::REGULAR);
+	bool CreateFromText(const std::string& text, SDL_Color color, EFont font = EFont::REGULAR, bool useCache = true);
+	bool CreateFromSurface(SDL_Surface* surface, CAssetCache::AssetId assetId = CAssetCache::INVALID_ASSET_ID);
+	bool CreateFromCache(CAssetCache::AssetId assetId);
+	bool CreateRenderTarget(int width, int height);
 
-	void SetBlendMode(SDL_BlendMode mode);
+	bool SetBlendMode(SDL_BlendMode mode);
 	void GetTint(Uint8* r, Uint8* g, Uint8* b);
 	void SetTint(Uint8 r, Uint8 g, Uint8 b);
 	void SetAlpha(Uint8 a);
@@ -36,9 +44,27 @@ public:
 	int GetWidth() { return m_width; }
 	int GetHeight() { return m_height; }
 	bool IsCreated() { return m_texture != nullptr; }
+	SDL_Texture* GetSDLTexture() { return m_texture; }
+
+	// set by the asset loader while the texture is queued for asynchronous loading
+	bool IsLoading() { return m_isLoading; }
+	void SetIsLoading(bool isLoading) { m_isLoading = isLoading; }
+
+	static SDL_Surface* LoadSurface(const SServices* services, const std::string& path);
 
 private:
+	static const Uint32 MAX_RAW_TEXTURE_SIZE = 16384;
+
+	bool SetCachedTexture(CAssetCache::AssetId assetId, SDL_Texture* texture);
+
+	static SDL_Surface* LoadRawSurface(const SServices* services, const std::string& path);
+	static SDL_Surface* DecodeRawSurface(const Uint8* data, size_t size, bool canReferenceData, const std::string& path);
+
+	const SServices* m_services = nullptr;
 	SDL_Texture* m_texture = nullptr;
+	CAssetCache::AssetId m_assetId = CAssetCache::INVALID_ASSET_ID; // set if the SDL texture is shared through the asset cache
 	int m_width = 0;
 	int m_height = 0;
+	SDL_Color m_color{ 255, 255, 255, 255 }; // tint and alpha
+	bool m_isLoading = false;
 };
\ No newline at end of file
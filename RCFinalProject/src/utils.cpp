@@ -25,6 +25,12 @@ namespace Utils
 		return SDL_GetTicks();
 	}
 
+	// high resolution timing, startCounter is a value previously returned by SDL_GetPerformanceCounter()
+	double GetElapsedMs(Uint64 startCounter)
+	{
+		return (SDL_GetPerformanceCounter() - startCounter) * 1000.0 / SDL_GetPerformanceFrequency();
+	}
+
 	bool CheckRectIntersection(SDL_Rect r1, SDL_Rect r2)
 	{
 		int r1_x1 = r1.x;
@@ -31,6 +31,7 @@ namespace Utils
 	float ScaleSpeed(Uint32 elapsedTime, float speed);
 	bool CheckRectIntersection(SDL_Rect r1, SDL_Rect r2);
 	Uint32 GetTicks();
+	double GetElapsedMs(Uint64 startCounter);
 	void RandomizeRngSeed();
 	uint32_t GetRandomUint32(uint32_t min, uint32_t max);	
 }